@@ -0,0 +1,8 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo
+# Build directory: /root/repo/_gate_jit
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+add_test(cpu65c816_test "/root/repo/_gate_jit/cpu65c816_test")
+set_tests_properties(cpu65c816_test PROPERTIES  FAIL_REGULAR_EXPRESSION "ECHEC" _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;88;add_test;/root/repo/CMakeLists.txt;0;")
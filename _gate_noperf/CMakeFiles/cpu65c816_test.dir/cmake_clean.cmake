@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/cpu65c816_test.dir/src/test.cpp.o"
+  "CMakeFiles/cpu65c816_test.dir/src/test.cpp.o.d"
+  "cpu65c816_test"
+  "cpu65c816_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/cpu65c816_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench.dir/src/bench.cpp.o"
+  "CMakeFiles/bench.dir/src/bench.cpp.o.d"
+  "bench"
+  "bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
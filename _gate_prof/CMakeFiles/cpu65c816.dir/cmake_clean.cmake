@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/cpu65c816.dir/src/cpu.cpp.o"
+  "CMakeFiles/cpu65c816.dir/src/cpu.cpp.o.d"
+  "CMakeFiles/cpu65c816.dir/src/cpu_jit.cpp.o"
+  "CMakeFiles/cpu65c816.dir/src/cpu_jit.cpp.o.d"
+  "libcpu65c816.a"
+  "libcpu65c816.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/cpu65c816.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/cpu_batch.dir/src/cpu_batch.cpp.o"
+  "CMakeFiles/cpu_batch.dir/src/cpu_batch.cpp.o.d"
+  "cpu_batch"
+  "cpu_batch.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/cpu_batch.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -1,9 +1,11 @@
 ﻿#pragma once
+#if defined(_MSC_VER)
 #pragma execution_character_set("utf-8")
+#endif
 
 #include <iostream>
 #include <locale>
-#include <windows.h>
+#include <stdexcept>
 
 struct LocaleInitializer {
     LocaleInitializer() {
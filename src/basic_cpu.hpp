@@ -0,0 +1,2046 @@
+﻿#pragma once
+
+#include "cpu_bcd.hpp"
+#include "cpu_bus_log.hpp"
+#include "cpu_decoder.hpp"
+#include "cpu_jit.hpp"
+#include "cpu_perf.hpp"
+#include "cpu_profiler.hpp"
+#include "cpu_trace.hpp"
+#include "cpu_types.hpp"
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Boucle threadée par goto calculé (extension GCC/Clang), switch portable sinon.
+#ifndef CPU_COMPUTED_GOTO
+#if defined(__GNUC__)
+#define CPU_COMPUTED_GOTO 1
+#else
+#define CPU_COMPUTED_GOTO 0
+#endif
+#endif
+
+#if CPU_ENABLE_PERF_COUNTERS
+#define CPU_PERF_COUNT(counter, count) (m_perf.counter += (count))
+#else
+#define CPU_PERF_COUNT(counter, count) static_cast<void>(0)
+#endif
+
+/**
+ * @brief Interface de bus statique attendue par BasicCpu.
+ *
+ * Les accès sont résolus à la compilation : un bus dont les membres sont
+ * visibles depuis l'unité de traduction est entièrement inliné dans le coeur.
+ */
+template<typename T>
+concept CpuBus = requires(T& bus, uint32_t address, uint8_t value, bool isWaiting)
+{
+    { bus.Read(address) } -> std::convertible_to<uint8_t>;
+    bus.Write(address, value);
+    bus.Idle(isWaiting);
+};
+
+/**
+ * @struct CpuHotState
+ * @brief Bloc chaud de BasicCpu, aligné sur une ligne de cache : CpuCore (registres, P, cycles,
+ * lignes d'interruption) suivi des deux bornes testées à chaque instruction.
+ */
+struct alignas(64) CpuHotState : CpuCore
+{
+    static constexpr uint64_t kNoEvent = ~0ull;
+
+    // Cycle jusqu'auquel une instruction peut enchaîner plusieurs itérations sans repasser
+    // par la boucle (MVN/MVP, attente WAI/STP) ; nul hors de RunUntil, pour Interpreter ou si un
+    // prédicat d'arrêt est fourni.
+    uint64_t m_batchTarget = 0;
+
+    // Cycle du premier événement programmé (voir BasicCpu::ScheduleEvent), kNoEvent si aucun.
+    uint64_t m_nextEvent = kNoEvent;
+};
+static_assert(sizeof(CpuHotState) == 64 && alignof(CpuHotState) == 64);
+
+/**
+ * @class BasicCpu
+ * @brief Coeur 65C816 paramétré par sa politique de bus.
+ * @tparam Bus Type fournissant Read, Write et Idle (voir CpuBus).
+ */
+template<CpuBus Bus>
+class BasicCpu : private CpuHotState
+{
+public:
+    explicit BasicCpu(Bus bus = Bus())
+        : m_bus(std::move(bus))
+    {
+        Reset(true);
+    }
+
+    BasicCpu(const BasicCpu&) = delete;
+    BasicCpu& operator=(const BasicCpu&) = delete;
+
+    void Reset(bool hard);
+
+    void RunOpcode();
+
+    /**
+     * @brief Exécute des instructions jusqu'à épuisement d'un budget de cycles maîtres.
+     * @param budget Nombre de cycles maîtres à exécuter.
+     * @return Dépassement par rapport à la fin du budget (négatif si RequestExit a interrompu l'exécution).
+     */
+    int64_t RunCycles(int64_t budget) { return RunUntil(m_cycles + budget); }
+
+    /**
+     * @brief Exécute des instructions jusqu'à atteindre le cycle maître indiqué.
+     * @return Dépassement par rapport à targetCycle (négatif en cas d'arrêt anticipé).
+     */
+    int64_t RunUntil(uint64_t targetCycle) { return RunUntil(targetCycle, NoStop()); }
+
+    /**
+     * @brief Variante de RunUntil qui s'arrête aussi dès que stop() renvoie vrai.
+     * Le prédicat est évalué entre deux instructions.
+     */
+    template<typename Predicate>
+    int64_t RunUntil(uint64_t targetCycle, Predicate stop);
+
+    /**
+     * @brief Demande l'arrêt de RunCycles/RunUntil à la fin de l'instruction courante.
+     * Destiné aux handlers du bus lorsqu'un événement de l'hôte devient dû.
+     */
+    void RequestExit() { m_exitRequested = true; m_leaveLoop = true; }
+
+    /**
+     * @brief Choisit la boucle utilisée par RunCycles/RunUntil.
+     * Interpreter exécute chaque instruction via RunOpcode ; Threaded enchaîne les
+     * instructions dans une boucle spécialisée par mode (goto calculé si disponible) ;
+     * Block exécute les blocs de base des pages directes pré-décodés (opcodes et opérandes
+     * déjà lus) et ne teste budget, interruptions et points d'arrêt qu'entre deux blocs
+     * (voir LookupBlock et RunBlockLoop) ; Jit y ajoute la traduction des blocs chauds en code
+     * natif (voir CpuJit, actif si CPU_ENABLE_JIT vaut 1 sur x86-64, sinon identique à Block).
+     */
+    void SetEngine(CpuEngine engine) { m_engine = engine; }
+    CpuEngine GetEngine() const { return m_engine; }
+
+    uint64_t GetCycles() const { return m_cycles; }
+    void SetCycles(uint64_t cycles) { uint64_t previous = m_cycles; m_cycles = cycles; KeepPerfDuration(previous); }
+
+    const CpuSpeedMap& GetSpeedMap() const { return m_speedMap; }
+    void SetSpeedMap(const CpuSpeedMap& speedMap) { m_speedMap = speedMap; m_memSel = speedMap.GetMemSel(); SpeedChanged(); }
+    void SetMemSel(bool fastRom)
+    {
+        if (fastRom != m_speedMap.GetMemSel())
+        {
+            m_speedMap.SetMemSel(fastRom);
+            SpeedChanged();
+        }
+        m_memSel = fastRom;
+    }
+
+    /**
+     * @brief Accès direct à la mémoire de l'hôte pour [address, address + size) (voir CpuPageTable::Map).
+     */
+    void MapPages(uint32_t address, uint32_t size, const uint8_t* read, uint8_t* write) { m_pageTable.Map(address, size, read, write); InvalidateCode(address, size); InvalidateFetch(); }
+    void UnmapPages(uint32_t address, uint32_t size) { m_pageTable.Unmap(address, size); InvalidateCode(address, size); InvalidateFetch(); }
+    const CpuPageTable& GetPageTable() const { return m_pageTable; }
+
+    /**
+     * @brief Bloc de base commençant en address pour mode (voir CpuDecoder), décodé puis mis en cache.
+     *
+     * Les pages du bloc perdent leur accès direct en écriture : une écriture du coeur sur l'une
+     * de ses instructions le supprime du cache. Les écritures de l'hôte dans la mémoire des pages
+     * directes doivent être signalées par InvalidateCode.
+     */
+    const CpuBasicBlock* DecodeBlock(uint32_t address, uint8_t mode);
+    const CpuBasicBlock* DecodeBlock() { return DecodeBlock((static_cast<uint32_t>(m_k) << 16) | m_pc, m_mode); }
+
+    /**
+     * @brief Supprime les blocs décodés ayant des octets dans les pages de [address, address + size).
+     */
+    void InvalidateCode(uint32_t address, uint32_t size);
+    const CpuDecoder& GetDecoder() const { return m_decoder; }
+#if CPU_ENABLE_JIT
+    const CpuJit& GetJit() const { return m_jit; }
+    void SetJitThreshold(uint32_t hits) { m_jit.SetHotThreshold(hits); }
+#endif
+
+    /**
+     * @brief Points d'arrêt et surveillances sur l'espace 24 bits.
+     *
+     * RunCycles/RunUntil s'arrêtent avant d'exécuter l'instruction d'un point d'arrêt (sauf la
+     * première instruction de l'appel, pour pouvoir reprendre), et à la fin de l'instruction qui
+     * lit ou écrit une adresse surveillée. GetStopReason/GetStopAddress indiquent la cause.
+     * Seules les pages portant un piège perdent leur accès direct.
+     */
+    void SetBreakpoint(uint32_t address, bool enabled = true) { SetTraps(address, 1, CpuPageTable::kTrapExecute, enabled); }
+    void SetWatchpoint(uint32_t address, uint32_t size, bool read, bool write, bool enabled = true)
+    {
+        if (read) SetTraps(address, size, CpuPageTable::kTrapRead, enabled);
+        if (write) SetTraps(address, size, CpuPageTable::kTrapWrite, enabled);
+    }
+    void ClearTraps();
+    CpuStopReason GetStopReason() const { return m_stopReason; }
+    uint32_t GetStopAddress() const { return m_stopAddress; }
+
+    void Nmi()
+    {
+#if CPU_ENABLE_BUS_LOG
+        if (m_busLogMode == CpuBusLogMode::Replay) return;
+        LogLine(CpuBusRecord::kNmi);
+#endif
+        m_nmiWanted = true;
+        UpdateIntWanted();
+        m_leaveLoop = true;
+    }
+
+    /**
+     * @brief Annonce le cycle maître auquel l'hôte lèvera sa prochaine IRQ/NMI.
+     * Pendant WAI/STP, RunCycles/RunUntil avancent directement jusqu'à ce cycle (ou jusqu'à la fin
+     * du budget) et ne signalent l'attente au bus qu'une seule fois. kNoWakeCycle : seule la fin du budget borne l'attente.
+     */
+    void SetWakeCycle(uint64_t cycle) { m_wakeCycle = cycle; }
+    uint64_t GetWakeCycle() const { return m_wakeCycle; }
+    static constexpr uint64_t kNoWakeCycle = CpuCore::kNoWakeCycle;
+
+    void SetIrq(bool state)
+    {
+#if CPU_ENABLE_BUS_LOG
+        if (m_busLogMode == CpuBusLogMode::Replay) return;
+        if (state != m_irqWanted) LogLine(state ? CpuBusRecord::kIrqHigh : CpuBusRecord::kIrqLow);
+#endif
+        m_irqWanted = state;
+        UpdateIntWanted();
+        // Ligne levée par un handler pendant un bloc pré-décodé : prise à la fin de l'instruction.
+        m_leaveLoop |= m_intWanted;
+    }
+
+    /**
+     * @brief Programme une NMI, ou le passage de la ligne IRQ à level, au cycle maître cycle.
+     * L'événement est appliqué au premier échantillonnage des lignes (dernier cycle d'une
+     * instruction, attente WAI) à partir de ce cycle : l'effet est celui d'un Nmi()/SetIrq() fait
+     * par le bus à cet instant, sans que l'hôte ait à découper RunUntil. Les événements ne font pas
+     * partie de SaveState.
+     * @return false si kMaxScheduledEvents événements sont déjà en attente.
+     */
+    bool ScheduleNmi(uint64_t cycle) { return !IsReplaying() && ScheduleEvent(cycle, ScheduledEvent::kNmi); }
+    bool ScheduleIrq(uint64_t cycle, bool level) { return !IsReplaying() && ScheduleEvent(cycle, level ? ScheduledEvent::kIrqSet : ScheduledEvent::kIrqClear); }
+    void CancelScheduledEvents() { m_eventCount = 0; m_nextEvent = kNoEvent; }
+    uint64_t GetNextEventCycle() const { return m_nextEvent; }
+    static constexpr size_t kMaxScheduledEvents = 16;
+    static constexpr uint64_t kNoEvent = CpuHotState::kNoEvent;
+
+    CpuDebugState GetDebugState() const;
+
+    /**
+     * @brief Copie l'état complet du coeur (registres, attente, interruptions en cours, cycles)
+     * sous forme de CpuSaveState, sans allocation.
+     * @return false si out fait moins de kSaveStateSize octets.
+     */
+    bool SaveState(std::span<std::byte> out) const;
+
+    /**
+     * @brief Restaure un état produit par SaveState.
+     * @return false (état inchangé) si la taille, la signature ou la version ne correspondent pas.
+     */
+    bool LoadState(std::span<const std::byte> in);
+
+    static constexpr size_t kSaveStateSize = sizeof(CpuSaveState);
+
+    /**
+     * @brief État architectural courant, copiable par simple affectation (voir CpuCore).
+     */
+    const CpuCore& GetCore() const { return *this; }
+
+    /**
+     * @brief Remplace l'état courant par une copie de CpuCore, sans toucher au bus ni à la configuration.
+     */
+    void SetCore(const CpuCore& core)
+    {
+        uint64_t previous = m_cycles;
+        static_cast<CpuCore&>(*this) = core;
+        KeepPerfDuration(previous);
+        UpdateIntWanted();
+        if (m_memSel != m_speedMap.GetMemSel())
+        {
+            m_speedMap.SetMemSel(m_memSel);
+            ClearBlockCache();
+        }
+        InvalidateFetch();
+        m_leaveLoop = true;
+    }
+
+    Bus& GetBus() { return m_bus; }
+    const Bus& GetBus() const { return m_bus; }
+
+#if CPU_ENABLE_PERF_COUNTERS
+    /**
+     * @brief Compteurs depuis la construction ou le dernier ResetPerfCounters (par exemple à
+     * chaque image) ; cycles est le temps écoulé, indépendant de SetCycles et LoadState.
+     */
+    CpuPerfCounters GetPerfCounters() const
+    {
+        CpuPerfCounters counters = m_perf;
+        counters.cycles = m_cycles - m_perfStart;
+        return counters;
+    }
+    void ResetPerfCounters() { m_perf = {}; m_perfStart = m_cycles; }
+
+    /**
+     * @brief Ajoute le travail exécuté hors du coeur (chemin parallèle de CpuLanes). counters.cycles
+     * compte dans le temps écoulé : le SetCore qui rend ensuite ces cycles au coeur ne les retire pas.
+     */
+    void AddPerfCounters(const CpuPerfCounters& counters)
+    {
+        m_perf.instructions += counters.instructions;
+        m_perf.opcodeFetches += counters.opcodeFetches;
+        m_perf.fastReads += counters.fastReads;
+        m_perf.handlerReads += counters.handlerReads;
+        m_perf.fastWrites += counters.fastWrites;
+        m_perf.handlerWrites += counters.handlerWrites;
+        m_perf.idleCycles += counters.idleCycles;
+        m_perf.waitCycles += counters.waitCycles;
+        m_perf.interrupts += counters.interrupts;
+        m_perfStart -= counters.cycles;
+    }
+#endif
+
+#if CPU_ENABLE_PROFILER
+    /**
+     * @brief Histogrammes par adresse et par opcode, actifs après GetProfiler().Enable(true).
+     */
+    CpuProfiler& GetProfiler() { return m_profiler; }
+    const CpuProfiler& GetProfiler() const { return m_profiler; }
+#endif
+
+#if CPU_ENABLE_BUS_LOG
+    /**
+     * @brief Attache un journal du bus (nullptr ou CpuBusLogMode::Off le détache).
+     *
+     * Record ajoute au journal chaque octet rendu par Bus::Read (pages sans accès direct) et
+     * chaque changement des lignes d'interruption (SetIrq, Nmi, événements programmés appliqués),
+     * horodatés en cycles maîtres. Replay rejoue le journal depuis son curseur sans aucun appel au
+     * bus : lectures relues, écritures et Idle supprimés, lignes pilotées par le journal ; les appels
+     * SetIrq, Nmi et Schedule* de l'hôte sont alors ignorés. Le coeur doit repartir du même état
+     * (SaveState/LoadState) avec les mêmes pages directes, que les handlers ne doivent pas modifier.
+     */
+    void SetBusLog(CpuBusLog* log, CpuBusLogMode mode);
+    CpuBusLogMode GetBusLogMode() const { return m_busLogMode; }
+
+    /**
+     * @brief Vrai si le rejeu a trouvé une lecture à un autre cycle que l'original, ou un journal épuisé.
+     */
+    bool HasReplayDiverged() const { return m_replayDiverged; }
+#endif
+
+#if CPU_ENABLE_TRACE
+    /**
+     * @brief Enregistre chaque instruction dans ring (nullptr désactive la trace).
+     * L'anneau appartient à l'hôte et doit rester valide tant qu'il est attaché.
+     */
+    void SetTraceRing(CpuTraceRing* ring) { m_traceRing = ring; }
+    CpuTraceRing* GetTraceRing() const { return m_traceRing; }
+#endif
+
+private:
+    // Drapeaux (Flags) compactés dans CpuCore::m_p ; N et Z sont évalués à la demande.
+    static constexpr uint8_t kFlagC = 0x01, kFlagZ = 0x02, kFlagI = 0x04, kFlagD = 0x08;
+    static constexpr uint8_t kFlagX = 0x10, kFlagM = 0x20, kFlagV = 0x40, kFlagN = 0x80;
+
+    // Membres de Données, par ordre de fréquence d'accès. Le bloc chaud (CpuHotState, classe de
+    // base) occupe seul la première ligne de cache ; viennent ensuite la fenêtre de lecture et
+    // l'état de la boucle, puis le bus (handlers de Cpu) et les tables de configuration.
+    struct NoStop { constexpr bool operator()() const { return false; } };
+
+    // Fenêtre de lecture des opcodes : page de 256 octets de K:PC lue directement.
+    // Les octets ne sont pas copiés, les écritures dans la page restent donc visibles.
+    static constexpr uint32_t kNoFetchWindow = ~0u;
+    const uint8_t* m_fetchPage = nullptr;
+    uint32_t m_fetchKey = kNoFetchWindow;
+    uint8_t m_fetchCycles = 0;
+    // Opérandes restants de l'instruction pré-décodée en cours (moteur Block, voir Fetch).
+    const uint8_t* m_operands = nullptr;
+
+    // Moteur d'exécution de RunUntil ; m_leaveLoop force la sortie de RunLoop
+    // (changement de mode, WAI/STP, Reset, RequestExit).
+    CpuEngine m_engine = CpuEngine::Threaded;
+    bool m_leaveLoop = false;
+    bool m_exitRequested = false;
+
+#if CPU_ENABLE_PERF_COUNTERS
+    // Compteurs ; la durée est m_cycles - m_perfStart, l'origine suit les changements de m_cycles.
+    CpuPerfCounters m_perf;
+    uint64_t m_perfStart = 0;
+#endif
+    void KeepPerfDuration(uint64_t previousCycles)
+    {
+#if CPU_ENABLE_PERF_COUNTERS
+        m_perfStart += m_cycles - previousCycles;
+#else
+        static_cast<void>(previousCycles);
+#endif
+    }
+
+    Bus m_bus;
+
+    // Événements programmés par l'hôte, triés par cycle (le premier est m_nextEvent).
+    struct ScheduledEvent
+    {
+        enum Kind : uint8_t { kNmi, kIrqSet, kIrqClear };
+        uint64_t cycle;
+        Kind kind;
+    };
+    std::array<ScheduledEvent, kMaxScheduledEvents> m_events{};
+    size_t m_eventCount = 0;
+    bool ScheduleEvent(uint64_t cycle, typename ScheduledEvent::Kind kind);
+    void PollEvents() { if (m_cycles >= m_nextEvent) [[unlikely]] { FireEvents(); } }
+    void FireEvents();
+
+    // Temps d'accès ; MEMSEL est recopié dans CpuCore::m_memSel.
+    CpuSpeedMap m_speedMap;
+
+    // Accès directs à la mémoire de l'hôte
+    CpuPageTable m_pageTable;
+
+    // Points d'arrêt et surveillances
+    CpuTrapMap m_traps;
+    CpuStopReason m_stopReason = CpuStopReason::None;
+    uint32_t m_stopAddress = 0;
+
+    // Blocs de base décodés ; leurs pages portent CpuPageTable::kTrapCode.
+    CpuDecoder m_decoder;
+
+    // Moteur Block : blocs récemment exécutés par clé (K:PC, mode), compilés depuis CpuDecoder.
+    // fetchCycles et fetches couvrent l'opcode et les opérandes lus par Fetch (pas les immédiats
+    // de AdrImm, relus par Read). count vaut 0 si le code n'est pas décodable (page du handler,
+    // code automodifiant). Vidé (nouveau m_blockStamp) quand un bloc est supprimé ou que les
+    // pièges ou les temps d'accès changent ; alloué au premier passage du moteur Block.
+    struct BlockOp
+    {
+        uint8_t opcode;
+        uint8_t operands[3];
+        uint8_t fetchCycles;
+        uint8_t fetches;
+    };
+    struct BlockEntry
+    {
+        uint32_t key = 0;
+        uint32_t count = 0;
+        uint64_t stamp = 0;
+        std::array<BlockOp, CpuDecoder::kMaxInstructions> ops;
+#if CPU_ENABLE_JIT
+        uint32_t hits = 0;
+        CpuJit::Entry native = nullptr;
+#endif
+    };
+    static constexpr uint32_t kBlockCacheSize = 1024;
+    // Majorant du coût d'une instruction : 9 accès au plus, chacun au plus kXSlowCycles.
+    static constexpr uint64_t kMaxInstructionCycles = 10 * CpuSpeedMap::kXSlowCycles;
+    std::vector<BlockEntry> m_blockCache;
+    uint64_t m_blockStamp = 1;
+    void ClearBlockCache();
+    void CompileBlock(BlockEntry& entry, uint32_t address, uint32_t key);
+    void SpeedChanged() { InvalidateFetch(); ClearBlockCache(); m_leaveLoop = true; }
+
+#if CPU_ENABLE_JIT
+    // Moteur Jit : code natif des blocs chauds ; m_blockEntry est l'entrée du dernier LookupBlock.
+    CpuJit m_jit;
+    BlockEntry* m_blockEntry = nullptr;
+    template<bool E, bool M, bool X> void CompileNative(BlockEntry& entry);
+    template<bool E, bool M, bool X, typename Predicate> bool RunNative(uint32_t count, uint64_t targetCycle);
+
+    // Fonctions du coeur appelées par le code natif (voir CpuJitLayout), core étant le CpuCore.
+    static BasicCpu& JitCore(void* core) { return static_cast<BasicCpu&>(*static_cast<CpuHotState*>(static_cast<CpuCore*>(core))); }
+    static uint32_t JitReadSlow(void* core, uint32_t address) { return JitCore(core).ReadSlow(address); }
+    static void JitWriteSlow(void* core, uint32_t address, uint32_t value) { JitCore(core).WriteSlow(address, static_cast<uint8_t>(value)); }
+    static void JitIdle(void* core) { JitCore(core).Idle(); }
+    static void JitImplied(void* core) { JitCore(core).AdrImp(); }
+    static void JitFireEvents(void* core) { JitCore(core).FireEvents(); }
+    template<bool E, bool M, bool X>
+    static void JitStep(void* core, const void* op)
+    {
+        BasicCpu& cpu = JitCore(core);
+        cpu.template ExecuteOpcode<E, M, X, true>(cpu.ReadDecoded(*static_cast<const BlockOp*>(op)));
+    }
+#endif
+
+#if CPU_ENABLE_PROFILER
+    // Instruction en cours de mesure : enregistrée par EndInstruction au point de dispatch suivant.
+    CpuProfiler m_profiler;
+    uint64_t m_profileStart = 0;
+    uint32_t m_profileAddress = 0;
+    uint8_t m_profileOpcode = 0;
+    bool m_profilePending = false;
+#endif
+
+#if CPU_ENABLE_TRACE
+    CpuTraceRing* m_traceRing = nullptr;
+    void TraceInstruction(uint32_t address, uint64_t startCycles, uint8_t opcode);
+#endif
+
+#if CPU_ENABLE_BUS_LOG
+    CpuBusLog* m_busLog = nullptr;
+    CpuBusLogMode m_busLogMode = CpuBusLogMode::Off;
+    bool m_replayDiverged = false;
+    void LogLine(CpuBusRecord::Kind kind) { if (m_busLogMode == CpuBusLogMode::Record) m_busLog->Append({ kind, 0, m_cycles }); }
+    uint8_t LoggedRead(uint32_t address);
+    void ReplayLines();
+#endif
+    bool IsReplaying() const
+    {
+#if CPU_ENABLE_BUS_LOG
+        return m_busLogMode == CpuBusLogMode::Replay;
+#else
+        return false;
+#endif
+    }
+
+    // Bus / Mémoire
+    uint8_t Read(uint32_t address);
+    void Write(uint32_t address, uint8_t value);
+    uint8_t ReadSlow(uint32_t address);
+    void WriteSlow(uint32_t address, uint8_t value);
+    void SetTraps(uint32_t address, uint32_t size, uint8_t trap, bool enabled);
+    void HitTrap(CpuStopReason reason, uint32_t address);
+    bool AtBreakpoint();
+    bool AtBreakpointSlow(uint32_t address);
+    const BlockOp* LookupBlock(uint32_t& count);
+    void Idle();
+    void IdleWait();
+    void IdleUntilEvent();
+
+    // Interruptions
+    // Échantillonnage des lignes : m_intWanted est tenu à jour par SetIrq, Nmi, les changements
+    // de I et FireEvents, il ne reste qu'à appliquer les événements programmés échus.
+    void CheckInterrupts() { PollEvents(); }
+    void UpdateIntWanted() { m_intWanted = m_nmiWanted || (m_irqWanted && !GetFlag(kFlagI)); }
+    void DoInterrupt();
+
+    // Récupération des Opcodes
+    uint8_t ReadOpcode();
+    uint8_t ReadInstruction();
+    void EndInstruction();
+    uint8_t ReadOpcodeSlow(uint32_t address);
+    uint16_t ReadOpcodeWord(bool intCheck);
+    uint8_t ReadDecoded(const BlockOp& op);
+    void InvalidateFetch() { m_fetchKey = kNoFetchWindow; }
+
+    // Octets d'opérande : ReadOpcode, ou pour Decoded ceux de l'instruction pré-décodée,
+    // dont la lecture a été comptée par ReadDecoded.
+    template<bool Decoded> uint8_t Fetch();
+    template<bool Decoded> uint16_t FetchWord(bool intCheck);
+
+    // Drapeaux
+    uint8_t GetFlags() const { return m_p | (GetN() ? kFlagN : 0) | (GetZ() ? kFlagZ : 0); }
+    void SetFlags(uint8_t value);
+    void SetZnFlags(uint16_t value, bool isByte) { m_zResult = m_nResult = isByte ? static_cast<uint16_t>(value << 8) : value; }
+    bool GetFlag(uint8_t mask) const { return (m_p & mask) != 0; }
+    void SetFlag(uint8_t mask, bool value)
+    {
+        m_p = value ? (m_p | mask) : (m_p & ~mask);
+        if (mask & kFlagI) UpdateIntWanted();
+    }
+    bool GetZ() const { return m_zResult == 0; }
+    bool GetN() const { return (m_nResult & 0x8000) != 0; }
+    void SetZ(bool value) { m_zResult = value ? 0 : 1; }
+    void SetN(bool value) { m_nResult = value ? 0x8000 : 0; }
+
+    // Pile
+    void PushByte(uint8_t value);
+    uint8_t PullByte();
+    void PushWord(uint16_t value, bool intCheck);
+    uint16_t PullWord(bool intCheck);
+
+    // Accès Mémoire
+    uint16_t ReadWord(uint32_t adrL, uint32_t adrH, bool intCheck);
+    void WriteWord(uint32_t adrL, uint32_t adrH, uint16_t value, bool reversed, bool intCheck);
+    template<bool Decoded> void DoBranch(bool condition);
+    template<bool X, int Step> void MoveBlock();
+
+    // Modes d'adressage
+    void AdrImp();
+    template<bool Is8Bit> std::pair<uint32_t, uint32_t> AdrImm();
+    template<bool Decoded> std::pair<uint32_t, uint32_t> AdrDp();
+    template<bool Decoded> std::pair<uint32_t, uint32_t> AdrDpx();
+    template<bool Decoded> std::pair<uint32_t, uint32_t> AdrDpy();
+    template<bool Decoded> std::pair<uint32_t, uint32_t> AdrIdp();
+    template<bool Decoded> std::pair<uint32_t, uint32_t> AdrIdx();
+    template<bool X, bool Decoded> std::pair<uint32_t, uint32_t> AdrIdy(bool write);
+    template<bool Decoded> std::pair<uint32_t, uint32_t> AdrIdl();
+    template<bool Decoded> std::pair<uint32_t, uint32_t> AdrIly();
+    template<bool Decoded> std::pair<uint32_t, uint32_t> AdrSr();
+    template<bool Decoded> std::pair<uint32_t, uint32_t> AdrIsy();
+    template<bool Decoded> std::pair<uint32_t, uint32_t> AdrAbs();
+    template<bool X, bool Decoded> std::pair<uint32_t, uint32_t> AdrAbx(bool write);
+    template<bool X, bool Decoded> std::pair<uint32_t, uint32_t> AdrAby(bool write);
+    template<bool Decoded> std::pair<uint32_t, uint32_t> AdrAbl();
+    template<bool Decoded> std::pair<uint32_t, uint32_t> AdrAlx();
+
+    // Logique des OpCodes
+    template<bool M> void And(uint32_t low, uint32_t high);
+    template<bool M> void Ora(uint32_t low, uint32_t high);
+    template<bool M> void Eor(uint32_t low, uint32_t high);
+    template<bool M> void Adc(uint32_t low, uint32_t high);
+    template<bool M> void Sbc(uint32_t low, uint32_t high);
+    template<bool M> void Cmp(uint32_t low, uint32_t high);
+    template<bool X> void Cpx(uint32_t low, uint32_t high);
+    template<bool X> void Cpy(uint32_t low, uint32_t high);
+    template<bool M> void Bit(uint32_t low, uint32_t high);
+    template<bool M> void Lda(uint32_t low, uint32_t high);
+    template<bool X> void Ldx(uint32_t low, uint32_t high);
+    template<bool X> void Ldy(uint32_t low, uint32_t high);
+    template<bool M> void Sta(uint32_t low, uint32_t high);
+    template<bool X> void Stx(uint32_t low, uint32_t high);
+    template<bool X> void Sty(uint32_t low, uint32_t high);
+    template<bool M> void Stz(uint32_t low, uint32_t high);
+    template<bool M> void Ror(uint32_t low, uint32_t high);
+    template<bool M> void Rol(uint32_t low, uint32_t high);
+    template<bool M> void Lsr(uint32_t low, uint32_t high);
+    template<bool M> void Asl(uint32_t low, uint32_t high);
+    template<bool M> void Inc(uint32_t low, uint32_t high);
+    template<bool M> void Dec(uint32_t low, uint32_t high);
+    template<bool M> void Tsb(uint32_t low, uint32_t high);
+    template<bool M> void Trb(uint32_t low, uint32_t high);
+
+    // Exécution spécialisée par mode : les tests de largeur (M, X) et de mode émulation (E)
+    // sont résolus à la compilation. m_mode désigne l'exécuteur du mode courant.
+    void DoOpcode(uint8_t opcode) { (this->*kExecutors[m_mode])(opcode); }
+    template<bool E, bool M, bool X, bool Decoded> void ExecuteOpcode(uint8_t opcode);
+    void UpdateMode()
+    {
+        uint8_t mode = m_e ? kModeEmulation : ((GetFlag(kFlagM) ? 2 : 0) | (GetFlag(kFlagX) ? 1 : 0));
+        m_leaveLoop |= mode != m_mode;
+        m_mode = mode;
+    }
+
+    // Boucle d'exécution sans retour au niveau de RunUntil entre deux instructions.
+    // Renvoie vrai si le prédicat d'arrêt a été satisfait.
+    template<typename Predicate> bool RunMode(uint64_t targetCycle, Predicate& stop);
+    template<bool E, bool M, bool X, typename Predicate> bool RunLoop(uint64_t targetCycle, Predicate& stop);
+    template<bool E, bool M, bool X, typename Predicate> bool RunBlockLoop(uint64_t targetCycle, Predicate& stop);
+
+    using Executor = void (BasicCpu::*)(uint8_t opcode);
+    static constexpr uint8_t kModeEmulation = 4;
+    static constexpr Executor kExecutors[5] = {
+        &BasicCpu::ExecuteOpcode<false, false, false, false>,
+        &BasicCpu::ExecuteOpcode<false, false, true, false>,
+        &BasicCpu::ExecuteOpcode<false, true, false, false>,
+        &BasicCpu::ExecuteOpcode<false, true, true, false>,
+        &BasicCpu::ExecuteOpcode<true, true, true, false>,
+    };
+};
+
+
+template<CpuBus Bus>
+CpuDebugState BasicCpu<Bus>::GetDebugState() const
+{
+    return {
+        .a = m_a, .x = m_x, .y = m_y, .sp = m_sp, .pc = m_pc, .dp = m_dp,
+        .k = m_k, .db = m_db,
+        .c = GetFlag(kFlagC), .z = GetZ(), .v = GetFlag(kFlagV), .n = GetN(),
+        .i = GetFlag(kFlagI), .d = GetFlag(kFlagD), .xf = GetFlag(kFlagX), .mf = GetFlag(kFlagM), .e = m_e
+    };
+}
+
+template<CpuBus Bus>
+bool BasicCpu<Bus>::SaveState(std::span<std::byte> out) const
+{
+    if (out.size() < kSaveStateSize)
+    {
+        return false;
+    }
+    CpuSaveState state = {
+        .magic = CpuSaveState::kMagic, .version = CpuSaveState::kVersion,
+        .cycles = m_cycles, .wakeCycle = m_wakeCycle,
+        .a = m_a, .x = m_x, .y = m_y, .sp = m_sp, .pc = m_pc, .dp = m_dp,
+        .k = m_k, .db = m_db, .p = GetFlags(),
+        .state = static_cast<uint8_t>(
+            (m_waiting ? CpuSaveState::kWaiting : 0) | (m_stopped ? CpuSaveState::kStopped : 0)
+            | (m_irqWanted ? CpuSaveState::kIrqWanted : 0) | (m_nmiWanted ? CpuSaveState::kNmiWanted : 0)
+            | (m_intWanted ? CpuSaveState::kIntWanted : 0) | (m_resetWanted ? CpuSaveState::kResetWanted : 0)
+            | (m_e ? CpuSaveState::kEmulation : 0) | (m_speedMap.GetMemSel() ? CpuSaveState::kMemSel : 0))
+    };
+    std::memcpy(out.data(), &state, sizeof(state));
+    return true;
+}
+
+template<CpuBus Bus>
+bool BasicCpu<Bus>::LoadState(std::span<const std::byte> in)
+{
+    CpuSaveState state;
+    if (in.size() < kSaveStateSize)
+    {
+        return false;
+    }
+    std::memcpy(&state, in.data(), sizeof(state));
+    if (state.magic != CpuSaveState::kMagic || state.version != CpuSaveState::kVersion)
+    {
+        return false;
+    }
+
+    uint64_t previous = m_cycles;
+    m_cycles = state.cycles; m_wakeCycle = state.wakeCycle;
+    KeepPerfDuration(previous);
+    m_a = state.a; m_x = state.x; m_y = state.y; m_sp = state.sp; m_pc = state.pc; m_dp = state.dp;
+    m_k = state.k; m_db = state.db;
+    m_p = state.p & ~(kFlagN | kFlagZ);
+    SetN((state.p & kFlagN) != 0);
+    SetZ((state.p & kFlagZ) != 0);
+    m_waiting = state.state & CpuSaveState::kWaiting;
+    m_stopped = state.state & CpuSaveState::kStopped;
+    m_irqWanted = state.state & CpuSaveState::kIrqWanted;
+    m_nmiWanted = state.state & CpuSaveState::kNmiWanted;
+    // kIntWanted découle des lignes et de I : il est recalculé plutôt que relu.
+    UpdateIntWanted();
+    m_resetWanted = state.state & CpuSaveState::kResetWanted;
+    m_e = state.state & CpuSaveState::kEmulation;
+    m_memSel = state.state & CpuSaveState::kMemSel;
+    if (m_memSel != m_speedMap.GetMemSel())
+    {
+        m_speedMap.SetMemSel(m_memSel);
+        ClearBlockCache();
+    }
+    InvalidateFetch();
+    UpdateMode();
+    m_leaveLoop = true;
+    return true;
+}
+
+template<CpuBus Bus>
+void BasicCpu<Bus>::Reset(bool hard)
+{
+    if (hard)
+    {
+        m_a = 0; m_x = 0; m_y = 0; m_sp = 0; m_pc = 0; m_dp = 0;
+        m_k = 0; m_db = 0;
+        m_p = 0; SetZ(false); SetN(false);
+        m_e = false; m_irqWanted = false;
+        UpdateMode();
+    }
+    m_waiting = false;
+    m_stopped = false;
+    m_nmiWanted = false;
+    m_intWanted = false;
+    m_resetWanted = true;
+    m_leaveLoop = true;
+}
+
+template<CpuBus Bus>
+void BasicCpu<Bus>::RunOpcode()
+{
+    if (m_resetWanted)
+    {
+        m_resetWanted = false;
+        Read((static_cast<uint32_t>(m_k) << 16) | m_pc);
+        Idle();
+        Read(0x100 | (m_sp-- & 0xff));
+        Read(0x100 | (m_sp-- & 0xff));
+        Read(0x100 | (m_sp-- & 0xff));
+        m_sp = (m_sp & 0xff) | 0x100;
+        m_e = true;
+        SetFlag(kFlagI, true);
+        SetFlag(kFlagD, false);
+        SetFlags(GetFlags());
+        m_k = 0;
+        m_pc = ReadWord(0xfffc, 0xfffd, false);
+        return;
+    }
+
+    if (m_stopped)
+    {
+        IdleUntilEvent();
+        return;
+    }
+
+    if (m_waiting)
+    {
+        PollEvents();
+        if (m_irqWanted || m_nmiWanted)
+        {
+            m_waiting = false;
+            Idle();
+            CheckInterrupts();
+            Idle();
+        }
+        else
+        {
+            IdleUntilEvent();
+        }
+        return;
+    }
+
+    CheckInterrupts();
+    if (m_intWanted)
+    {
+        Read((static_cast<uint32_t>(m_k) << 16) | m_pc);
+        DoInterrupt();
+    }
+    else
+    {
+        uint8_t opcode = ReadInstruction();
+        DoOpcode(opcode);
+        EndInstruction();
+    }
+}
+
+template<CpuBus Bus>
+template<typename Predicate>
+int64_t BasicCpu<Bus>::RunUntil(uint64_t targetCycle, Predicate stop)
+{
+    m_exitRequested = false;
+    m_stopReason = CpuStopReason::None;
+    m_batchTarget = (m_engine != CpuEngine::Interpreter && std::is_same_v<Predicate, NoStop>) ? targetCycle : 0;
+    // La première instruction n'est pas arrêtée par un point d'arrêt : reprise après un arrêt.
+    bool resume = true;
+    while (m_cycles < targetCycle && !m_exitRequested && !stop())
+    {
+        if (!resume && !m_resetWanted && !m_stopped && !m_waiting)
+        {
+            CheckInterrupts();
+            if (!m_intWanted && AtBreakpoint()) break;
+        }
+        resume = false;
+        if (m_engine != CpuEngine::Interpreter && !m_resetWanted && !m_stopped && !m_waiting)
+        {
+            if (RunMode(targetCycle, stop)) break;
+        }
+        else
+        {
+            RunOpcode();
+        }
+    }
+    m_batchTarget = 0;
+    return static_cast<int64_t>(m_cycles - targetCycle);
+}
+
+template<CpuBus Bus>
+template<typename Predicate>
+bool BasicCpu<Bus>::RunMode(uint64_t targetCycle, Predicate& stop)
+{
+    if (m_engine == CpuEngine::Block || m_engine == CpuEngine::Jit)
+    {
+        switch (m_mode)
+        {
+            case 0: return RunBlockLoop<false, false, false>(targetCycle, stop);
+            case 1: return RunBlockLoop<false, false, true>(targetCycle, stop);
+            case 2: return RunBlockLoop<false, true, false>(targetCycle, stop);
+            case 3: return RunBlockLoop<false, true, true>(targetCycle, stop);
+            default: return RunBlockLoop<true, true, true>(targetCycle, stop);
+        }
+    }
+    switch (m_mode)
+    {
+        case 0: return RunLoop<false, false, false>(targetCycle, stop);
+        case 1: return RunLoop<false, false, true>(targetCycle, stop);
+        case 2: return RunLoop<false, true, false>(targetCycle, stop);
+        case 3: return RunLoop<false, true, true>(targetCycle, stop);
+        default: return RunLoop<true, true, true>(targetCycle, stop);
+    }
+}
+
+template<CpuBus Bus>
+uint8_t BasicCpu<Bus>::Read(uint32_t address)
+{
+    m_cycles += m_speedMap.GetAccessCycles(address);
+    if (const uint8_t* page = m_pageTable.Lookup(address).read)
+    {
+        CPU_PERF_COUNT(fastReads, 1);
+        return page[address & (CpuPageTable::kPageSize - 1)];
+    }
+    return ReadSlow(address);
+}
+
+template<CpuBus Bus>
+void BasicCpu<Bus>::Write(uint32_t address, uint8_t value)
+{
+    m_cycles += m_speedMap.GetAccessCycles(address);
+    if (uint8_t* page = m_pageTable.Lookup(address).write)
+    {
+        CPU_PERF_COUNT(fastWrites, 1);
+        page[address & (CpuPageTable::kPageSize - 1)] = value;
+        return;
+    }
+    WriteSlow(address, value);
+}
+
+template<CpuBus Bus>
+uint8_t BasicCpu<Bus>::ReadSlow(uint32_t address)
+{
+    if ((m_pageTable.GetTraps(address) & CpuPageTable::kTrapRead) && m_traps.Test(address, CpuPageTable::kTrapRead))
+    {
+        HitTrap(CpuStopReason::ReadWatch, address);
+    }
+    if (const uint8_t* page = m_pageTable.LookupHost(address).read)
+    {
+        CPU_PERF_COUNT(fastReads, 1);
+        return page[address & (CpuPageTable::kPageSize - 1)];
+    }
+    CPU_PERF_COUNT(handlerReads, 1);
+#if CPU_ENABLE_BUS_LOG
+    if (m_busLogMode != CpuBusLogMode::Off)
+    {
+        return LoggedRead(address);
+    }
+#endif
+    return m_bus.Read(address);
+}
+
+#if CPU_ENABLE_BUS_LOG
+template<CpuBus Bus>
+void BasicCpu<Bus>::SetBusLog(CpuBusLog* log, CpuBusLogMode mode)
+{
+    m_busLog = log;
+    m_busLogMode = log ? mode : CpuBusLogMode::Off;
+    m_replayDiverged = false;
+    if (m_busLogMode == CpuBusLogMode::Replay)
+    {
+        CancelScheduledEvents();
+        ReplayLines();
+    }
+}
+
+template<CpuBus Bus>
+uint8_t BasicCpu<Bus>::LoggedRead(uint32_t address)
+{
+    if (m_busLogMode == CpuBusLogMode::Record)
+    {
+        uint8_t value = m_bus.Read(address);
+        m_busLog->Append({ CpuBusRecord::kRead, value, m_cycles });
+        return value;
+    }
+    ReplayLines();
+    CpuBusRecord record;
+    if (!m_busLog->Next(record) || record.kind != CpuBusRecord::kRead)
+    {
+        m_replayDiverged = true;
+        return 0;
+    }
+    m_replayDiverged |= record.cycle != m_cycles;
+    ReplayLines();
+    return record.value;
+}
+
+/**
+ * @brief Programme les changements de ligne qui précèdent la prochaine lecture du journal.
+ * Ils sont appliqués au premier échantillonnage à partir de leur cycle, comme à l'enregistrement.
+ */
+template<CpuBus Bus>
+void BasicCpu<Bus>::ReplayLines()
+{
+    CpuBusRecord record;
+    while (m_eventCount < kMaxScheduledEvents && m_busLog->Peek(record) && record.kind != CpuBusRecord::kRead)
+    {
+        m_busLog->Next(record);
+        ScheduleEvent(record.cycle, record.kind == CpuBusRecord::kNmi ? ScheduledEvent::kNmi
+            : (record.kind == CpuBusRecord::kIrqHigh ? ScheduledEvent::kIrqSet : ScheduledEvent::kIrqClear));
+    }
+}
+#endif
+
+template<CpuBus Bus>
+void BasicCpu<Bus>::WriteSlow(uint32_t address, uint8_t value)
+{
+    if ((m_pageTable.GetTraps(address) & CpuPageTable::kTrapWrite) && m_traps.Test(address, CpuPageTable::kTrapWrite))
+    {
+        HitTrap(CpuStopReason::WriteWatch, address);
+    }
+    if (m_pageTable.GetTraps(address) & CpuPageTable::kTrapCode)
+    {
+        uint64_t generation = m_decoder.GetGeneration();
+        if (m_decoder.Invalidate(address))
+        {
+            m_pageTable.SetCode((address >> CpuPageTable::kPageShift) & (CpuPageTable::kPageCount - 1), false);
+        }
+        // Le bloc en cours d'exécution a pu être modifié : le moteur Block recompte depuis RunUntil.
+        if (generation != m_decoder.GetGeneration())
+        {
+            ClearBlockCache();
+            m_leaveLoop = true;
+        }
+    }
+    if (uint8_t* page = m_pageTable.LookupHost(address).write)
+    {
+        CPU_PERF_COUNT(fastWrites, 1);
+        page[address & (CpuPageTable::kPageSize - 1)] = value;
+        return;
+    }
+    CPU_PERF_COUNT(handlerWrites, 1);
+    if (!IsReplaying())
+    {
+        m_bus.Write(address, value);
+    }
+}
+
+template<CpuBus Bus>
+void BasicCpu<Bus>::SetTraps(uint32_t address, uint32_t size, uint8_t trap, bool enabled)
+{
+    for (uint32_t offset = 0; offset < size; offset++)
+    {
+        m_traps.Set(address + offset, trap, enabled);
+    }
+    if (size == 0)
+    {
+        return;
+    }
+    uint64_t first = address >> CpuPageTable::kPageShift;
+    uint64_t last = (static_cast<uint64_t>(address) + size - 1) >> CpuPageTable::kPageShift;
+    for (uint64_t page = first; page <= last && page - first < CpuPageTable::kPageCount; page++)
+    {
+        uint32_t index = static_cast<uint32_t>(page) & (CpuPageTable::kPageCount - 1);
+        m_pageTable.SetTraps(index, m_traps.GetPageTraps(index));
+    }
+    InvalidateFetch();
+    ClearBlockCache();
+    m_leaveLoop = true;
+}
+
+template<CpuBus Bus>
+void BasicCpu<Bus>::ClearTraps()
+{
+    m_traps.Clear();
+    for (uint32_t index = 0; index < CpuPageTable::kPageCount; index++)
+    {
+        m_pageTable.SetTraps(index, 0);
+    }
+    InvalidateFetch();
+    ClearBlockCache();
+}
+
+template<CpuBus Bus>
+const CpuBasicBlock* BasicCpu<Bus>::DecodeBlock(uint32_t address, uint8_t mode)
+{
+    const CpuBasicBlock* block = m_decoder.Decode(m_pageTable, address, mode);
+    for (size_t i = 0; block && i < block->instructions.size(); i++)
+    {
+        const CpuInstruction& instruction = block->instructions[i];
+        uint32_t last = (instruction.address & 0xff0000) | ((instruction.address + instruction.length - 1) & 0xffff);
+        m_pageTable.SetCode(instruction.address >> CpuPageTable::kPageShift, true);
+        m_pageTable.SetCode(last >> CpuPageTable::kPageShift, true);
+    }
+    return block;
+}
+
+template<CpuBus Bus>
+void BasicCpu<Bus>::InvalidateCode(uint32_t address, uint32_t size)
+{
+    m_decoder.InvalidatePages(address, size);
+    if (size == 0)
+    {
+        return;
+    }
+    uint64_t first = (address & 0xffffff) >> CpuPageTable::kPageShift;
+    uint64_t last = ((address & 0xffffff) + static_cast<uint64_t>(size) - 1) >> CpuPageTable::kPageShift;
+    for (uint64_t page = first; page <= last && page - first < CpuPageTable::kPageCount; page++)
+    {
+        uint32_t index = static_cast<uint32_t>(page) & (CpuPageTable::kPageCount - 1);
+        m_pageTable.SetCode(index, m_decoder.IsCodePage(index));
+    }
+    ClearBlockCache();
+    m_leaveLoop = true;
+}
+
+template<CpuBus Bus>
+void BasicCpu<Bus>::ClearBlockCache()
+{
+    // Les instructions restent en place : un bloc en cours d'exécution reste lisible jusqu'à m_leaveLoop.
+    m_blockStamp++;
+}
+
+template<CpuBus Bus>
+void BasicCpu<Bus>::HitTrap(CpuStopReason reason, uint32_t address)
+{
+    if (m_stopReason == CpuStopReason::None)
+    {
+        m_stopReason = reason;
+        m_stopAddress = address & (CpuTrapMap::kAddressCount - 1);
+    }
+    m_exitRequested = true;
+    m_leaveLoop = true;
+}
+
+/**
+ * @brief Vrai (et arrêt demandé) si l'instruction en K:PC porte un point d'arrêt.
+ * Une page portant un point d'arrêt perd son accès direct en lecture et n'entre donc jamais dans
+ * la fenêtre des opcodes : une instruction lue dans la fenêtre ne coûte qu'une comparaison.
+ */
+template<CpuBus Bus>
+bool BasicCpu<Bus>::AtBreakpoint()
+{
+    uint32_t address = (static_cast<uint32_t>(m_k) << 16) | m_pc;
+    return (address >> 8) != m_fetchKey && AtBreakpointSlow(address);
+}
+
+template<CpuBus Bus>
+bool BasicCpu<Bus>::AtBreakpointSlow(uint32_t address)
+{
+    if (!(m_pageTable.GetTraps(address) & CpuPageTable::kTrapExecute) || !m_traps.Test(address, CpuPageTable::kTrapExecute))
+    {
+        return false;
+    }
+    HitTrap(CpuStopReason::Breakpoint, address);
+    return true;
+}
+
+/**
+ * @brief Instructions pré-décodées que le moteur Block peut exécuter d'une traite depuis K:PC.
+ *
+ * count est borné pour que le prochain événement programmé ne puisse pas échoir avant la fin de
+ * la dernière instruction : entre deux instructions du bloc, la boucle n'a pas à échantillonner
+ * les lignes. Le budget, lui, est testé après chaque instruction.
+ * @return nullptr (exécution instruction par instruction) si le code passe par le handler ou est
+ * automodifiant, si le profileur ou la trace sont actifs, ou si l'événement est trop proche.
+ */
+template<CpuBus Bus>
+const typename BasicCpu<Bus>::BlockOp* BasicCpu<Bus>::LookupBlock(uint32_t& count)
+{
+#if CPU_ENABLE_PROFILER
+    if (m_profiler.IsEnabled())
+    {
+        return nullptr;
+    }
+#endif
+#if CPU_ENABLE_TRACE
+    if (m_traceRing)
+    {
+        return nullptr;
+    }
+#endif
+    if (m_blockCache.empty())
+    {
+        m_blockCache.resize(kBlockCacheSize);
+    }
+    uint32_t address = (static_cast<uint32_t>(m_k) << 16) | m_pc;
+    uint32_t key = (address << 3) | m_mode;
+    BlockEntry& entry = m_blockCache[(address ^ (address >> 10)) & (kBlockCacheSize - 1)];
+    if (entry.key != key || entry.stamp != m_blockStamp)
+    {
+        CompileBlock(entry, address, key);
+    }
+#if CPU_ENABLE_JIT
+    m_blockEntry = &entry;
+#endif
+    count = entry.count;
+    if (m_nextEvent <= m_cycles + count * kMaxInstructionCycles)
+    {
+        uint64_t affordable = m_nextEvent > m_cycles ? (m_nextEvent - m_cycles - 1) / kMaxInstructionCycles : 0;
+        count = affordable < count ? static_cast<uint32_t>(affordable) : count;
+    }
+    return count ? entry.ops.data() : nullptr;
+}
+
+/**
+ * @brief Compile le bloc de CpuDecoder commençant en address : opcode, opérandes et cycles de
+ * lecture de chaque instruction.
+ *
+ * Le bloc est tronqué avant la première instruction dont une page n'est pas lue directement
+ * (surveillance, point d'arrêt) et après CLI, qui peut démasquer une IRQ en attente.
+ */
+template<CpuBus Bus>
+void BasicCpu<Bus>::CompileBlock(BlockEntry& entry, uint32_t address, uint32_t key)
+{
+    entry.key = key;
+    entry.stamp = m_blockStamp;
+    entry.count = 0;
+#if CPU_ENABLE_JIT
+    entry.hits = 0;
+    entry.native = nullptr;
+#endif
+    const CpuBasicBlock* block = m_pageTable.Lookup(address).read ? DecodeBlock(address, m_mode) : nullptr;
+    for (size_t i = 0; block && i < block->instructions.size(); i++)
+    {
+        const CpuInstruction& instruction = block->instructions[i];
+        uint32_t bank = instruction.address & 0xff0000;
+        uint32_t last = bank | ((instruction.address + instruction.length - 1) & 0xffff);
+        if (!m_pageTable.Lookup(instruction.address).read || !m_pageTable.Lookup(last).read)
+        {
+            break;
+        }
+        // Les immédiats lus par AdrImm ne sont pas des lectures d'opcode (BIT #imm, si).
+        CpuAddressing addressing = CpuDecoder::kOpcodes[instruction.opcode].addressing;
+        bool immediate = (addressing == CpuAddressing::ImmM || addressing == CpuAddressing::ImmX) && instruction.opcode != 0x89;
+        BlockOp& op = entry.ops[entry.count++];
+        op = { instruction.opcode, { instruction.operands[0], instruction.operands[1], instruction.operands[2] }, 0,
+            static_cast<uint8_t>(immediate ? 1 : instruction.length) };
+        for (uint8_t byte = 0; byte < op.fetches; byte++)
+        {
+            op.fetchCycles += m_speedMap.GetAccessCycles(bank | ((instruction.address + byte) & 0xffff));
+        }
+        if (instruction.opcode == 0x58)
+        {
+            break;
+        }
+    }
+}
+
+template<CpuBus Bus>
+void BasicCpu<Bus>::Idle() { m_cycles += CpuSpeedMap::kFastCycles; CPU_PERF_COUNT(idleCycles, CpuSpeedMap::kFastCycles); if (!IsReplaying()) m_bus.Idle(false); }
+template<CpuBus Bus>
+void BasicCpu<Bus>::IdleWait() { m_cycles += CpuSpeedMap::kFastCycles; CPU_PERF_COUNT(waitCycles, CpuSpeedMap::kFastCycles); if (!IsReplaying()) m_bus.Idle(true); }
+
+/**
+ * @brief Attente WAI/STP : saute d'un coup les pas d'IdleWait qui précèdent le prochain événement.
+ *
+ * Le nombre de pas est celui qu'aurait exécuté la boucle pas à pas pour atteindre
+ * min(fin du budget, m_wakeCycle) ; le cycle final et l'unique appel au bus sont donc identiques
+ * à ceux du dernier pas de l'attente classique.
+ */
+template<CpuBus Bus>
+void BasicCpu<Bus>::IdleUntilEvent()
+{
+    // Un réveil déjà dépassé sans interruption n'est plus une borne ; un événement programmé en est une.
+    PollEvents();
+    uint64_t limit = (m_wakeCycle > m_cycles && m_wakeCycle < m_batchTarget) ? m_wakeCycle : m_batchTarget;
+    limit = std::min(limit, m_nextEvent);
+    if (m_cycles + CpuSpeedMap::kFastCycles >= limit)
+    {
+        IdleWait();
+        return;
+    }
+    uint64_t steps = (limit - m_cycles + CpuSpeedMap::kFastCycles - 1) / CpuSpeedMap::kFastCycles;
+    m_cycles += steps * CpuSpeedMap::kFastCycles;
+    CPU_PERF_COUNT(waitCycles, steps * CpuSpeedMap::kFastCycles);
+    if (!IsReplaying())
+    {
+        m_bus.Idle(true);
+    }
+}
+
+template<CpuBus Bus>
+bool BasicCpu<Bus>::ScheduleEvent(uint64_t cycle, typename ScheduledEvent::Kind kind)
+{
+    if (m_eventCount == kMaxScheduledEvents)
+    {
+        return false;
+    }
+    // Insertion après les événements du même cycle : ils sont appliqués dans l'ordre de programmation.
+    size_t i = m_eventCount++;
+    for (; i > 0 && m_events[i - 1].cycle > cycle; i--)
+    {
+        m_events[i] = m_events[i - 1];
+    }
+    m_events[i] = { cycle, kind };
+    // Un bloc pré-décodé en cours a été borné par l'ancien prochain événement.
+    m_leaveLoop |= cycle < m_nextEvent;
+    m_nextEvent = m_events[0].cycle;
+    return true;
+}
+
+/**
+ * @brief Applique les événements échus ; appelé seulement quand m_cycles atteint m_nextEvent.
+ */
+template<CpuBus Bus>
+void BasicCpu<Bus>::FireEvents()
+{
+    size_t fired = 0;
+    for (; fired < m_eventCount && m_events[fired].cycle <= m_cycles; fired++)
+    {
+        switch (m_events[fired].kind)
+        {
+        case ScheduledEvent::kNmi: m_nmiWanted = true; break;
+        case ScheduledEvent::kIrqSet: m_irqWanted = true; break;
+        case ScheduledEvent::kIrqClear: m_irqWanted = false; break;
+        }
+#if CPU_ENABLE_BUS_LOG
+        LogLine(m_events[fired].kind == ScheduledEvent::kNmi ? CpuBusRecord::kNmi
+            : (m_events[fired].kind == ScheduledEvent::kIrqSet ? CpuBusRecord::kIrqHigh : CpuBusRecord::kIrqLow));
+#endif
+    }
+    std::copy(m_events.begin() + fired, m_events.begin() + m_eventCount, m_events.begin());
+    m_eventCount -= fired;
+    m_nextEvent = m_eventCount ? m_events[0].cycle : kNoEvent;
+    UpdateIntWanted();
+#if CPU_ENABLE_BUS_LOG
+    if (IsReplaying())
+    {
+        ReplayLines();
+    }
+#endif
+}
+template<CpuBus Bus>
+uint8_t BasicCpu<Bus>::ReadOpcode()
+{
+    uint32_t address = (static_cast<uint32_t>(m_k) << 16) | m_pc++;
+    CPU_PERF_COUNT(opcodeFetches, 1);
+    if ((address >> 8) == m_fetchKey)
+    {
+        m_cycles += m_fetchCycles;
+        CPU_PERF_COUNT(fastReads, 1);
+        return m_fetchPage[address & 0xff];
+    }
+    return ReadOpcodeSlow(address);
+}
+
+/**
+ * @brief Lecture de l'opcode d'une nouvelle instruction (point d'ancrage du profileur).
+ */
+template<CpuBus Bus>
+uint8_t BasicCpu<Bus>::ReadInstruction()
+{
+    CPU_PERF_COUNT(instructions, 1);
+#if CPU_ENABLE_PROFILER || CPU_ENABLE_TRACE
+    uint32_t address = (static_cast<uint32_t>(m_k) << 16) | m_pc;
+    uint64_t startCycles = m_cycles;
+    uint8_t opcode = ReadOpcode();
+#if CPU_ENABLE_PROFILER
+    if (m_profiler.IsEnabled())
+    {
+        m_profileAddress = address;
+        m_profileStart = startCycles;
+        m_profileOpcode = opcode;
+        m_profilePending = true;
+    }
+#endif
+#if CPU_ENABLE_TRACE
+    if (m_traceRing)
+    {
+        TraceInstruction(address, startCycles, opcode);
+    }
+#endif
+    return opcode;
+#else
+    return ReadOpcode();
+#endif
+}
+
+#if CPU_ENABLE_TRACE
+template<CpuBus Bus>
+void BasicCpu<Bus>::TraceInstruction(uint32_t address, uint64_t startCycles, uint8_t opcode)
+{
+    CpuTraceRecord record = {
+        .cycles = startCycles, .pc = static_cast<uint16_t>(address), .a = m_a, .x = m_x, .y = m_y, .sp = m_sp, .dp = m_dp,
+        .k = m_k, .db = m_db, .p = GetFlags(), .flags = static_cast<uint8_t>(m_e ? CpuTraceRecord::kEmulation : 0),
+        .opcode = opcode, .operands = {}
+    };
+    // Opérandes relus dans les pages directes uniquement : un handler pourrait avoir des effets de bord.
+    bool direct = true;
+    for (int i = 0; i < 3; i++)
+    {
+        uint32_t operand = (address & 0xff0000) | ((address + 1 + i) & 0xffff);
+        const uint8_t* page = m_pageTable.LookupHost(operand).read;
+        direct = direct && page;
+        record.operands[i] = page ? page[operand & (CpuPageTable::kPageSize - 1)] : 0;
+    }
+    if (direct)
+    {
+        record.flags |= CpuTraceRecord::kOperandsValid;
+    }
+    m_traceRing->Push(record);
+}
+#endif
+
+template<CpuBus Bus>
+void BasicCpu<Bus>::EndInstruction()
+{
+#if CPU_ENABLE_PROFILER
+    if (m_profilePending)
+    {
+        m_profilePending = false;
+        m_profiler.Record(m_profileAddress, m_profileOpcode, static_cast<uint32_t>(m_cycles - m_profileStart));
+    }
+#endif
+}
+
+template<CpuBus Bus>
+uint8_t BasicCpu<Bus>::ReadOpcodeSlow(uint32_t address)
+{
+    // Les pages gérées par le handler ne sont jamais mises en cache : chaque octet reste un accès bus.
+    if (const uint8_t* page = m_pageTable.Lookup(address).read)
+    {
+        m_fetchKey = address >> 8;
+        m_fetchPage = page + (address & (CpuPageTable::kPageSize - 1) & ~0xffu);
+        m_fetchCycles = m_speedMap.GetAccessCycles(address);
+    }
+    else
+    {
+        m_fetchKey = kNoFetchWindow;
+    }
+    return Read(address);
+}
+
+template<CpuBus Bus>
+uint16_t BasicCpu<Bus>::ReadOpcodeWord(bool intCheck)
+{
+    uint32_t address = (static_cast<uint32_t>(m_k) << 16) | m_pc;
+    if ((address >> 8) == m_fetchKey && (address & 0xff) != 0xff)
+    {
+        // Les deux octets sont dans la fenêtre : aucun handler n'intervient entre eux.
+        m_pc += 2;
+        m_cycles += m_fetchCycles;
+        CPU_PERF_COUNT(opcodeFetches, 2);
+        CPU_PERF_COUNT(fastReads, 2);
+        if (intCheck) { CheckInterrupts(); }
+        m_cycles += m_fetchCycles;
+        return m_fetchPage[address & 0xff] | (m_fetchPage[(address & 0xff) + 1] << 8);
+    }
+    uint16_t low = ReadOpcode();
+    if (intCheck) { CheckInterrupts(); }
+    uint16_t high = ReadOpcode();
+    return low | (high << 8);
+}
+
+/**
+ * @brief Dispatch d'une instruction pré-décodée (moteur Block) : PC, cycles et compteurs des
+ * lectures d'opcode et d'opérandes sont avancés d'un coup, avant tout autre accès de l'instruction.
+ */
+template<CpuBus Bus>
+uint8_t BasicCpu<Bus>::ReadDecoded(const BlockOp& op)
+{
+    m_pc += op.fetches;
+    m_cycles += op.fetchCycles;
+    m_operands = op.operands;
+    CPU_PERF_COUNT(instructions, 1);
+    CPU_PERF_COUNT(opcodeFetches, op.fetches);
+    CPU_PERF_COUNT(fastReads, op.fetches);
+    return op.opcode;
+}
+
+template<CpuBus Bus>
+template<bool Decoded>
+uint8_t BasicCpu<Bus>::Fetch()
+{
+    if constexpr (Decoded)
+    {
+        return *m_operands++;
+    }
+    else
+    {
+        return ReadOpcode();
+    }
+}
+
+template<CpuBus Bus>
+template<bool Decoded>
+uint16_t BasicCpu<Bus>::FetchWord(bool intCheck)
+{
+    if constexpr (Decoded)
+    {
+        if (intCheck) { CheckInterrupts(); }
+        uint16_t value = m_operands[0] | (m_operands[1] << 8);
+        m_operands += 2;
+        return value;
+    }
+    else
+    {
+        return ReadOpcodeWord(intCheck);
+    }
+}
+
+template<CpuBus Bus>
+void BasicCpu<Bus>::SetFlags(uint8_t val)
+{
+    SetN((val & kFlagN) != 0);
+    SetZ((val & kFlagZ) != 0);
+    m_p = val & ~(kFlagN | kFlagZ);
+    UpdateIntWanted();
+
+    if (m_e)
+    {
+        m_p |= kFlagM | kFlagX;
+    }
+
+    if (m_p & kFlagX)
+    {
+        m_x &= 0xff;
+        m_y &= 0xff;
+    }
+    UpdateMode();
+}
+
+template<CpuBus Bus>
+void BasicCpu<Bus>::PushByte(uint8_t value)
+{
+    Write(m_sp, value);
+    m_sp--;
+    if (m_e) m_sp = (m_sp & 0xff) | 0x100;
+}
+
+template<CpuBus Bus>
+uint8_t BasicCpu<Bus>::PullByte()
+{
+    m_sp++;
+    if (m_e) m_sp = (m_sp & 0xff) | 0x100;
+    return Read(m_sp);
+}
+
+template<CpuBus Bus>
+void BasicCpu<Bus>::PushWord(uint16_t value, bool intCheck)
+{
+    PushByte(value >> 8);
+    if (intCheck) CheckInterrupts();
+    PushByte(value & 0xff);
+}
+
+template<CpuBus Bus>
+uint16_t BasicCpu<Bus>::PullWord(bool intCheck)
+{
+    uint8_t low = PullByte();
+    if (intCheck) CheckInterrupts();
+    return low | (static_cast<uint16_t>(PullByte()) << 8);
+}
+
+template<CpuBus Bus>
+uint16_t BasicCpu<Bus>::ReadWord(uint32_t adrL, uint32_t adrH, bool intCheck)
+{
+    uint16_t low = Read(adrL);
+    if (intCheck) CheckInterrupts();
+    uint16_t high = Read(adrH);
+    return low | (high << 8);
+}
+
+template<CpuBus Bus>
+void BasicCpu<Bus>::WriteWord(uint32_t adrL, uint32_t adrH, uint16_t value, bool reversed, bool intCheck)
+{
+    if (reversed)
+    {
+        Write(adrH, value >> 8);
+        if (intCheck) CheckInterrupts();
+        Write(adrL, value & 0xff);
+    }
+    else
+    {
+        Write(adrL, value & 0xff);
+        if (intCheck) CheckInterrupts();
+        Write(adrH, value >> 8);
+    }
+}
+
+template<CpuBus Bus>
+template<bool Decoded>
+void BasicCpu<Bus>::DoBranch(bool condition)
+{
+    if (!condition)
+    {
+        CheckInterrupts();
+    }
+    uint8_t value = Fetch<Decoded>();
+    if (condition)
+    {
+        CheckInterrupts();
+        Idle();
+        m_pc += static_cast<int8_t>(value);
+    }
+}
+
+/**
+ * @brief Enchaîne les itérations suivantes de MVN (Step = +1) ou MVP (Step = -1)
+ * tant que le code, la source et la destination sont en accès direct.
+ *
+ * Chaque itération reproduit exactement les cycles de la version pas à pas (trois lectures
+ * d'opcode, une lecture, une écriture, deux cycles internes) et s'arrête à chaque point où
+ * la boucle d'exécution reprendrait la main : fin du budget, interruption, m_leaveLoop.
+ * Le profileur et la trace ne voient que les instructions dispatchées : pas d'enchaînement
+ * tant que le profileur est actif ou qu'un anneau de trace est attaché.
+ */
+template<CpuBus Bus>
+template<bool X, int Step>
+void BasicCpu<Bus>::MoveBlock()
+{
+#if CPU_ENABLE_PROFILER
+    if (m_profiler.IsEnabled())
+    {
+        return;
+    }
+#endif
+#if CPU_ENABLE_TRACE
+    if (m_traceRing)
+    {
+        return;
+    }
+#endif
+    uint32_t code = (static_cast<uint32_t>(m_k) << 16) | m_pc;
+    const uint8_t* codePage = m_pageTable.Lookup(code).read;
+    if (!codePage || m_pc > 0xfffd || (code & (CpuPageTable::kPageSize - 1)) > CpuPageTable::kPageSize - 3)
+    {
+        return;
+    }
+    const uint8_t* instruction = codePage + (code & (CpuPageTable::kPageSize - 1));
+    uint32_t fetchCycles = m_speedMap.GetAccessCycles(code) + m_speedMap.GetAccessCycles(code + 1) + m_speedMap.GetAccessCycles(code + 2);
+    uint8_t opcode = instruction[0];
+
+    while (m_a != 0xffff && !m_leaveLoop && m_cycles < m_batchTarget)
+    {
+        CheckInterrupts();
+        if (m_intWanted || instruction[0] != opcode)
+        {
+            return;
+        }
+        uint8_t dest = instruction[1], src = instruction[2];
+        uint32_t srcAddress = (static_cast<uint32_t>(src) << 16) | m_x;
+        uint32_t destAddress = (static_cast<uint32_t>(dest) << 16) | m_y;
+        const uint8_t* srcPage = m_pageTable.Lookup(srcAddress).read;
+        uint8_t* destPage = m_pageTable.Lookup(destAddress).write;
+        if (!srcPage || !destPage)
+        {
+            return;
+        }
+
+        m_cycles += fetchCycles + m_speedMap.GetAccessCycles(srcAddress) + m_speedMap.GetAccessCycles(destAddress);
+        CPU_PERF_COUNT(instructions, 1);
+        CPU_PERF_COUNT(opcodeFetches, 3);
+        CPU_PERF_COUNT(fastReads, 4);
+        CPU_PERF_COUNT(fastWrites, 1);
+        m_db = dest;
+        destPage[destAddress & (CpuPageTable::kPageSize - 1)] = srcPage[srcAddress & (CpuPageTable::kPageSize - 1)];
+        m_a--; m_x += Step; m_y += Step;
+        if (m_a == 0xffff) { m_pc += 3; }
+        if constexpr (X) { m_x &= 0xff; m_y &= 0xff; }
+        Idle(); CheckInterrupts(); Idle();
+    }
+}
+
+template<CpuBus Bus>
+void BasicCpu<Bus>::DoInterrupt()
+{
+    CPU_PERF_COUNT(interrupts, 1);
+    Idle();
+    if (!m_e)
+    {
+        PushByte(m_k);
+    }
+    PushWord(m_pc, false);
+    uint8_t flags = GetFlags() & 0xEF; // Effacer le drapeau B pour les interruptions matérielles
+    PushByte(flags);
+
+    SetFlag(kFlagI, true);
+    SetFlag(kFlagD, false);
+    m_k = 0;
+
+    uint32_t vectorL, vectorH;
+    if (m_e)
+    {
+        vectorL = m_nmiWanted ? 0xfffa : 0xfffe;
+        vectorH = m_nmiWanted ? 0xfffb : 0xffff;
+    }
+    else
+    {
+        vectorL = m_nmiWanted ? 0xffea : 0xffee;
+        vectorH = m_nmiWanted ? 0xffeb : 0xffef;
+    }
+
+    m_nmiWanted = false;
+    UpdateIntWanted();
+    m_pc = ReadWord(vectorL, vectorH, false);
+}
+
+template<CpuBus Bus>
+void BasicCpu<Bus>::AdrImp() { CheckInterrupts(); if (m_intWanted) { Read((static_cast<uint32_t>(m_k) << 16) | m_pc); } else { Idle(); } }
+template<CpuBus Bus>
+template<bool Is8Bit>
+std::pair<uint32_t, uint32_t> BasicCpu<Bus>::AdrImm() { uint32_t low, high = 0; low = (static_cast<uint32_t>(m_k) << 16) | m_pc++; if constexpr (!Is8Bit) { high = (static_cast<uint32_t>(m_k) << 16) | m_pc++; } return { low, high }; }
+template<CpuBus Bus>
+template<bool Decoded>
+std::pair<uint32_t, uint32_t> BasicCpu<Bus>::AdrDp() { uint8_t adr = Fetch<Decoded>(); if (m_dp & 0xff) Idle(); uint32_t low = (m_dp + adr) & 0xffff; return { low, (low + 1) & 0xffff }; }
+template<CpuBus Bus>
+template<bool Decoded>
+std::pair<uint32_t, uint32_t> BasicCpu<Bus>::AdrDpx() { uint8_t adr = Fetch<Decoded>(); if (m_dp & 0xff) Idle(); Idle(); uint32_t low = (m_dp + adr + m_x) & 0xffff; return { low, (low + 1) & 0xffff }; }
+template<CpuBus Bus>
+template<bool Decoded>
+std::pair<uint32_t, uint32_t> BasicCpu<Bus>::AdrDpy() { uint8_t adr = Fetch<Decoded>(); if (m_dp & 0xff) Idle(); Idle(); uint32_t low = (m_dp + adr + m_y) & 0xffff; return { low, (low + 1) & 0xffff }; }
+template<CpuBus Bus>
+template<bool Decoded>
+std::pair<uint32_t, uint32_t> BasicCpu<Bus>::AdrIdp() { uint8_t adr = Fetch<Decoded>(); if (m_dp & 0xff) Idle(); uint16_t pointer = ReadWord((m_dp + adr) & 0xffff, (m_dp + adr + 1) & 0xffff, false); uint32_t low = (static_cast<uint32_t>(m_db) << 16) + pointer; return { low, (low + 1) & 0xffffff }; }
+template<CpuBus Bus>
+template<bool Decoded>
+std::pair<uint32_t, uint32_t> BasicCpu<Bus>::AdrIdx() { uint8_t adr = Fetch<Decoded>(); if (m_dp & 0xff) Idle(); Idle(); uint16_t pointer = ReadWord((m_dp + adr + m_x) & 0xffff, (m_dp + adr + m_x + 1) & 0xffff, false); uint32_t low = (static_cast<uint32_t>(m_db) << 16) + pointer; return { low, (low + 1) & 0xffffff }; }
+template<CpuBus Bus>
+template<bool X, bool Decoded>
+std::pair<uint32_t, uint32_t> BasicCpu<Bus>::AdrIdy(bool write) { uint8_t adr = Fetch<Decoded>(); if (m_dp & 0xff) Idle(); uint16_t pointer = ReadWord((m_dp + adr) & 0xffff, (m_dp + adr + 1) & 0xffff, false); if (write || !X || ((pointer >> 8) != ((pointer + m_y) >> 8))) Idle(); uint32_t low = ((static_cast<uint32_t>(m_db) << 16) + pointer + m_y) & 0xffffff; return { low, (low + 1) & 0xffffff }; }
+template<CpuBus Bus>
+template<bool Decoded>
+std::pair<uint32_t, uint32_t> BasicCpu<Bus>::AdrIdl() { uint8_t adr = Fetch<Decoded>(); if (m_dp & 0xff) Idle(); uint32_t pointer = ReadWord((m_dp + adr) & 0xffff, (m_dp + adr + 1) & 0xffff, false); pointer |= (static_cast<uint32_t>(Read((m_dp + adr + 2) & 0xffff))) << 16; return { pointer, (pointer + 1) & 0xffffff }; }
+template<CpuBus Bus>
+template<bool Decoded>
+std::pair<uint32_t, uint32_t> BasicCpu<Bus>::AdrIly() { uint8_t adr = Fetch<Decoded>(); if (m_dp & 0xff) Idle(); uint32_t pointer = ReadWord((m_dp + adr) & 0xffff, (m_dp + adr + 1) & 0xffff, false); pointer |= (static_cast<uint32_t>(Read((m_dp + adr + 2) & 0xffff))) << 16; uint32_t low = (pointer + m_y) & 0xffffff; return { low, (low + 1) & 0xffffff }; }
+template<CpuBus Bus>
+template<bool Decoded>
+std::pair<uint32_t, uint32_t> BasicCpu<Bus>::AdrSr() { uint8_t adr = Fetch<Decoded>(); Idle(); uint32_t low = (m_sp + adr) & 0xffff; return { low, (low + 1) & 0xffff }; }
+template<CpuBus Bus>
+template<bool Decoded>
+std::pair<uint32_t, uint32_t> BasicCpu<Bus>::AdrIsy() { uint8_t adr = Fetch<Decoded>(); Idle(); uint16_t pointer = ReadWord((m_sp + adr) & 0xffff, (m_sp + adr + 1) & 0xffff, false); Idle(); uint32_t low = ((static_cast<uint32_t>(m_db) << 16) + pointer + m_y) & 0xffffff; return { low, (low + 1) & 0xffffff }; }
+template<CpuBus Bus>
+template<bool Decoded>
+std::pair<uint32_t, uint32_t> BasicCpu<Bus>::AdrAbs() { uint16_t adr = FetchWord<Decoded>(false); uint32_t low = (static_cast<uint32_t>(m_db) << 16) + adr; return { low, (low + 1) & 0xffffff }; }
+template<CpuBus Bus>
+template<bool X, bool Decoded>
+std::pair<uint32_t, uint32_t> BasicCpu<Bus>::AdrAbx(bool write) { uint16_t adr = FetchWord<Decoded>(false); if (write || !X || ((adr >> 8) != ((adr + m_x) >> 8))) Idle(); uint32_t low = ((static_cast<uint32_t>(m_db) << 16) + adr + m_x) & 0xffffff; return { low, (low + 1) & 0xffffff }; }
+template<CpuBus Bus>
+template<bool X, bool Decoded>
+std::pair<uint32_t, uint32_t> BasicCpu<Bus>::AdrAby(bool write) { uint16_t adr = FetchWord<Decoded>(false); if (write || !X || ((adr >> 8) != ((adr + m_y) >> 8))) Idle(); uint32_t low = ((static_cast<uint32_t>(m_db) << 16) + adr + m_y) & 0xffffff; return { low, (low + 1) & 0xffffff }; }
+template<CpuBus Bus>
+template<bool Decoded>
+std::pair<uint32_t, uint32_t> BasicCpu<Bus>::AdrAbl() { uint32_t adr = FetchWord<Decoded>(false); adr |= (static_cast<uint32_t>(Fetch<Decoded>())) << 16; return { adr, (adr + 1) & 0xffffff }; }
+template<CpuBus Bus>
+template<bool Decoded>
+std::pair<uint32_t, uint32_t> BasicCpu<Bus>::AdrAlx() { uint32_t adr = FetchWord<Decoded>(false); adr |= (static_cast<uint32_t>(Fetch<Decoded>())) << 16; uint32_t low = (adr + m_x) & 0xffffff; return { low, (low + 1) & 0xffffff }; }
+
+template<CpuBus Bus>
+template<bool M>
+void BasicCpu<Bus>::And(uint32_t low, uint32_t high) { if constexpr (M) { CheckInterrupts(); uint8_t value = Read(low); m_a = (m_a & 0xff00) | ((m_a & value) & 0xff); } else { uint16_t value = ReadWord(low, high, true); m_a &= value; } SetZnFlags(m_a, M); }
+template<CpuBus Bus>
+template<bool M>
+void BasicCpu<Bus>::Ora(uint32_t low, uint32_t high) { if constexpr (M) { CheckInterrupts(); uint8_t value = Read(low); m_a = (m_a & 0xff00) | ((m_a | value) & 0xff); } else { uint16_t value = ReadWord(low, high, true); m_a |= value; } SetZnFlags(m_a, M); }
+template<CpuBus Bus>
+template<bool M>
+void BasicCpu<Bus>::Eor(uint32_t low, uint32_t high) { if constexpr (M) { CheckInterrupts(); uint8_t value = Read(low); m_a = (m_a & 0xff00) | ((m_a ^ value) & 0xff); } else { uint16_t value = ReadWord(low, high, true); m_a ^= value; } SetZnFlags(m_a, M); }
+template<CpuBus Bus>
+template<bool M>
+void BasicCpu<Bus>::Adc(uint32_t low, uint32_t high) { if constexpr (M) { CheckInterrupts(); uint8_t value = Read(low); if (GetFlag(kFlagD)) { uint32_t result = CpuBcd::Add8(static_cast<uint8_t>(m_a), value, GetFlag(kFlagC)); SetFlag(kFlagV, result & CpuBcd::kOverflow); SetFlag(kFlagC, result & CpuBcd::kCarry); m_a = (m_a & 0xff00) | (result & 0xff); } else { uint16_t result = (m_a & 0xff) + value + GetFlag(kFlagC); SetFlag(kFlagV, !((m_a ^ value) & 0x80) && ((m_a ^ result) & 0x80)); SetFlag(kFlagC, result > 0xff); m_a = (m_a & 0xff00) | (result & 0xff); } } else { uint16_t value = ReadWord(low, high, true); if (GetFlag(kFlagD)) { uint32_t result = CpuBcd::Add16(m_a, value, GetFlag(kFlagC)); SetFlag(kFlagV, result & (CpuBcd::kOverflow << 8)); SetFlag(kFlagC, result & (CpuBcd::kCarry << 8)); m_a = result & 0xffff; } else { uint32_t result = m_a + value + GetFlag(kFlagC); SetFlag(kFlagV, !((m_a ^ value) & 0x8000) && ((m_a ^ result) & 0x8000)); SetFlag(kFlagC, result > 0xffff); m_a = result; } } SetZnFlags(m_a, M); }
+template<CpuBus Bus>
+template<bool M>
+void BasicCpu<Bus>::Sbc(uint32_t low, uint32_t high) { if constexpr (M) { CheckInterrupts(); uint8_t operand = Read(low); uint8_t a_val = m_a & 0xFF; uint16_t result = a_val - operand - (1 - GetFlag(kFlagC)); SetFlag(kFlagV, ((a_val ^ operand) & (a_val ^ result) & 0x80) != 0); if (GetFlag(kFlagD)) { uint32_t bcd = CpuBcd::Sub8(a_val, operand, GetFlag(kFlagC)); SetFlag(kFlagC, bcd & CpuBcd::kCarry); m_a = (m_a & 0xFF00) | (bcd & 0xFF); } else { SetFlag(kFlagC, (result & 0xFF00) == 0); m_a = (m_a & 0xFF00) | (result & 0xFF); } } else { uint16_t operand = ReadWord(low, high, true); uint16_t a_val = m_a; uint32_t result = a_val - operand - (1 - GetFlag(kFlagC)); SetFlag(kFlagV, ((a_val ^ operand) & (a_val ^ result) & 0x8000) != 0); if (GetFlag(kFlagD)) { result = CpuBcd::Sub16(a_val, operand, GetFlag(kFlagC)); SetFlag(kFlagC, result & (CpuBcd::kCarry << 8)); } else { SetFlag(kFlagC, (result & 0xFFFF0000) == 0); } m_a = result & 0xFFFF; } SetZnFlags(m_a, M); }
+template<CpuBus Bus>
+template<bool M>
+void BasicCpu<Bus>::Cmp(uint32_t low, uint32_t high) { uint32_t result; if constexpr (M) { CheckInterrupts(); uint8_t value = Read(low); result = (m_a & 0xff) - value; SetFlag(kFlagC, result < 0x100); } else { uint16_t value = ReadWord(low, high, true); result = m_a - value; SetFlag(kFlagC, result < 0x10000); } SetZnFlags(result, M); }
+template<CpuBus Bus>
+template<bool X>
+void BasicCpu<Bus>::Cpx(uint32_t low, uint32_t high) { uint32_t result; if constexpr (X) { CheckInterrupts(); uint8_t value = Read(low); result = (m_x & 0xff) - value; SetFlag(kFlagC, result < 0x100); } else { uint16_t value = ReadWord(low, high, true); result = m_x - value; SetFlag(kFlagC, result < 0x10000); } SetZnFlags(result, X); }
+template<CpuBus Bus>
+template<bool X>
+void BasicCpu<Bus>::Cpy(uint32_t low, uint32_t high) { uint32_t result; if constexpr (X) { CheckInterrupts(); uint8_t value = Read(low); result = (m_y & 0xff) - value; SetFlag(kFlagC, result < 0x100); } else { uint16_t value = ReadWord(low, high, true); result = m_y - value; SetFlag(kFlagC, result < 0x10000); } SetZnFlags(result, X); }
+template<CpuBus Bus>
+template<bool M>
+void BasicCpu<Bus>::Bit(uint32_t low, uint32_t high) { if constexpr (M) { CheckInterrupts(); uint8_t value = Read(low); SetZ(((m_a & 0xff) & value) == 0); SetN((value & 0x80) != 0); SetFlag(kFlagV, (value & 0x40) != 0); } else { uint16_t value = ReadWord(low, high, true); SetZ((m_a & value) == 0); SetN((value & 0x8000) != 0); SetFlag(kFlagV, (value & 0x4000) != 0); } }
+template<CpuBus Bus>
+template<bool M>
+void BasicCpu<Bus>::Lda(uint32_t low, uint32_t high) { if constexpr (M) { CheckInterrupts(); m_a = (m_a & 0xff00) | Read(low); } else { m_a = ReadWord(low, high, true); } SetZnFlags(m_a, M); }
+template<CpuBus Bus>
+template<bool X>
+void BasicCpu<Bus>::Ldx(uint32_t low, uint32_t high) { if constexpr (X) { CheckInterrupts(); m_x = Read(low); } else { m_x = ReadWord(low, high, true); } SetZnFlags(m_x, X); }
+template<CpuBus Bus>
+template<bool X>
+void BasicCpu<Bus>::Ldy(uint32_t low, uint32_t high) { if constexpr (X) { CheckInterrupts(); m_y = Read(low); } else { m_y = ReadWord(low, high, true); } SetZnFlags(m_y, X); }
+template<CpuBus Bus>
+template<bool M>
+void BasicCpu<Bus>::Sta(uint32_t low, uint32_t high) { if constexpr (M) { CheckInterrupts(); Write(low, m_a); } else { WriteWord(low, high, m_a, false, true); } }
+template<CpuBus Bus>
+template<bool X>
+void BasicCpu<Bus>::Stx(uint32_t low, uint32_t high) { if constexpr (X) { CheckInterrupts(); Write(low, m_x); } else { WriteWord(low, high, m_x, false, true); } }
+template<CpuBus Bus>
+template<bool X>
+void BasicCpu<Bus>::Sty(uint32_t low, uint32_t high) { if constexpr (X) { CheckInterrupts(); Write(low, m_y); } else { WriteWord(low, high, m_y, false, true); } }
+template<CpuBus Bus>
+template<bool M>
+void BasicCpu<Bus>::Stz(uint32_t low, uint32_t high) { if constexpr (M) { CheckInterrupts(); Write(low, 0); } else { WriteWord(low, high, 0, false, true); } }
+template<CpuBus Bus>
+template<bool M>
+void BasicCpu<Bus>::Ror(uint32_t low, uint32_t high) { bool carry; uint16_t result; if constexpr (M) { uint8_t value = Read(low); Idle(); carry = (value & 1) != 0; result = (value >> 1) | (GetFlag(kFlagC) << 7); CheckInterrupts(); Write(low, result); } else { uint16_t value = ReadWord(low, high, false); Idle(); carry = (value & 1) != 0; result = (value >> 1) | (GetFlag(kFlagC) << 15); WriteWord(low, high, result, true, true); } SetZnFlags(result, M); SetFlag(kFlagC, carry); }
+template<CpuBus Bus>
+template<bool M>
+void BasicCpu<Bus>::Rol(uint32_t low, uint32_t high) { uint32_t result; if constexpr (M) { result = (Read(low) << 1) | GetFlag(kFlagC); Idle(); SetFlag(kFlagC, (result & 0x100) != 0); CheckInterrupts(); Write(low, result); } else { result = (ReadWord(low, high, false) << 1) | GetFlag(kFlagC); Idle(); SetFlag(kFlagC, (result & 0x10000) != 0); WriteWord(low, high, result, true, true); } SetZnFlags(result, M); }
+template<CpuBus Bus>
+template<bool M>
+void BasicCpu<Bus>::Lsr(uint32_t low, uint32_t high) { uint16_t result; if constexpr (M) { uint8_t value = Read(low); Idle(); SetFlag(kFlagC, (value & 1) != 0); result = value >> 1; CheckInterrupts(); Write(low, result); } else { uint16_t value = ReadWord(low, high, false); Idle(); SetFlag(kFlagC, (value & 1) != 0); result = value >> 1; WriteWord(low, high, result, true, true); } SetZnFlags(result, M); }
+template<CpuBus Bus>
+template<bool M>
+void BasicCpu<Bus>::Asl(uint32_t low, uint32_t high) { uint32_t result; if constexpr (M) { result = Read(low) << 1; Idle(); SetFlag(kFlagC, (result & 0x100) != 0); CheckInterrupts(); Write(low, result); } else { result = ReadWord(low, high, false) << 1; Idle(); SetFlag(kFlagC, (result & 0x10000) != 0); WriteWord(low, high, result, true, true); } SetZnFlags(result, M); }
+template<CpuBus Bus>
+template<bool M>
+void BasicCpu<Bus>::Inc(uint32_t low, uint32_t high) { uint16_t result; if constexpr (M) { result = Read(low) + 1; Idle(); CheckInterrupts(); Write(low, result); } else { result = ReadWord(low, high, false) + 1; Idle(); WriteWord(low, high, result, true, true); } SetZnFlags(result, M); }
+template<CpuBus Bus>
+template<bool M>
+void BasicCpu<Bus>::Dec(uint32_t low, uint32_t high) { uint16_t result; if constexpr (M) { result = Read(low) - 1; Idle(); CheckInterrupts(); Write(low, result); } else { result = ReadWord(low, high, false) - 1; Idle(); WriteWord(low, high, result, true, true); } SetZnFlags(result, M); }
+template<CpuBus Bus>
+template<bool M>
+void BasicCpu<Bus>::Tsb(uint32_t low, uint32_t high) { if constexpr (M) { uint8_t value = Read(low); Idle(); SetZ(((m_a & 0xff) & value) == 0); CheckInterrupts(); Write(low, value | (m_a & 0xff)); } else { uint16_t value = ReadWord(low, high, false); Idle(); SetZ((m_a & value) == 0); WriteWord(low, high, value | m_a, true, true); } }
+template<CpuBus Bus>
+template<bool M>
+void BasicCpu<Bus>::Trb(uint32_t low, uint32_t high) { if constexpr (M) { uint8_t value = Read(low); Idle(); SetZ(((m_a & 0xff) & value) == 0); CheckInterrupts(); Write(low, value & ~(m_a & 0xff)); } else { uint16_t value = ReadWord(low, high, false); Idle(); SetZ((m_a & value) == 0); WriteWord(low, high, value & ~m_a, true, true); } }
+
+template<CpuBus Bus>
+template<bool E, bool M, bool X, bool Decoded>
+void BasicCpu<Bus>::ExecuteOpcode(uint8_t opcode)
+{
+#define CPU_OPCODE(op) case op:
+#define CPU_NEXT() break
+    switch (opcode)
+    {
+#include "basic_cpu_opcodes.inl"
+    }
+#undef CPU_OPCODE
+#undef CPU_NEXT
+}
+
+#if CPU_COMPUTED_GOTO
+#define CPU_LABEL_TABLE \
+        &&op_0x00, &&op_0x01, &&op_0x02, &&op_0x03, &&op_0x04, &&op_0x05, &&op_0x06, &&op_0x07, &&op_0x08, &&op_0x09, &&op_0x0a, &&op_0x0b, &&op_0x0c, &&op_0x0d, &&op_0x0e, &&op_0x0f, \
+        &&op_0x10, &&op_0x11, &&op_0x12, &&op_0x13, &&op_0x14, &&op_0x15, &&op_0x16, &&op_0x17, &&op_0x18, &&op_0x19, &&op_0x1a, &&op_0x1b, &&op_0x1c, &&op_0x1d, &&op_0x1e, &&op_0x1f, \
+        &&op_0x20, &&op_0x21, &&op_0x22, &&op_0x23, &&op_0x24, &&op_0x25, &&op_0x26, &&op_0x27, &&op_0x28, &&op_0x29, &&op_0x2a, &&op_0x2b, &&op_0x2c, &&op_0x2d, &&op_0x2e, &&op_0x2f, \
+        &&op_0x30, &&op_0x31, &&op_0x32, &&op_0x33, &&op_0x34, &&op_0x35, &&op_0x36, &&op_0x37, &&op_0x38, &&op_0x39, &&op_0x3a, &&op_0x3b, &&op_0x3c, &&op_0x3d, &&op_0x3e, &&op_0x3f, \
+        &&op_0x40, &&op_0x41, &&op_0x42, &&op_0x43, &&op_0x44, &&op_0x45, &&op_0x46, &&op_0x47, &&op_0x48, &&op_0x49, &&op_0x4a, &&op_0x4b, &&op_0x4c, &&op_0x4d, &&op_0x4e, &&op_0x4f, \
+        &&op_0x50, &&op_0x51, &&op_0x52, &&op_0x53, &&op_0x54, &&op_0x55, &&op_0x56, &&op_0x57, &&op_0x58, &&op_0x59, &&op_0x5a, &&op_0x5b, &&op_0x5c, &&op_0x5d, &&op_0x5e, &&op_0x5f, \
+        &&op_0x60, &&op_0x61, &&op_0x62, &&op_0x63, &&op_0x64, &&op_0x65, &&op_0x66, &&op_0x67, &&op_0x68, &&op_0x69, &&op_0x6a, &&op_0x6b, &&op_0x6c, &&op_0x6d, &&op_0x6e, &&op_0x6f, \
+        &&op_0x70, &&op_0x71, &&op_0x72, &&op_0x73, &&op_0x74, &&op_0x75, &&op_0x76, &&op_0x77, &&op_0x78, &&op_0x79, &&op_0x7a, &&op_0x7b, &&op_0x7c, &&op_0x7d, &&op_0x7e, &&op_0x7f, \
+        &&op_0x80, &&op_0x81, &&op_0x82, &&op_0x83, &&op_0x84, &&op_0x85, &&op_0x86, &&op_0x87, &&op_0x88, &&op_0x89, &&op_0x8a, &&op_0x8b, &&op_0x8c, &&op_0x8d, &&op_0x8e, &&op_0x8f, \
+        &&op_0x90, &&op_0x91, &&op_0x92, &&op_0x93, &&op_0x94, &&op_0x95, &&op_0x96, &&op_0x97, &&op_0x98, &&op_0x99, &&op_0x9a, &&op_0x9b, &&op_0x9c, &&op_0x9d, &&op_0x9e, &&op_0x9f, \
+        &&op_0xa0, &&op_0xa1, &&op_0xa2, &&op_0xa3, &&op_0xa4, &&op_0xa5, &&op_0xa6, &&op_0xa7, &&op_0xa8, &&op_0xa9, &&op_0xaa, &&op_0xab, &&op_0xac, &&op_0xad, &&op_0xae, &&op_0xaf, \
+        &&op_0xb0, &&op_0xb1, &&op_0xb2, &&op_0xb3, &&op_0xb4, &&op_0xb5, &&op_0xb6, &&op_0xb7, &&op_0xb8, &&op_0xb9, &&op_0xba, &&op_0xbb, &&op_0xbc, &&op_0xbd, &&op_0xbe, &&op_0xbf, \
+        &&op_0xc0, &&op_0xc1, &&op_0xc2, &&op_0xc3, &&op_0xc4, &&op_0xc5, &&op_0xc6, &&op_0xc7, &&op_0xc8, &&op_0xc9, &&op_0xca, &&op_0xcb, &&op_0xcc, &&op_0xcd, &&op_0xce, &&op_0xcf, \
+        &&op_0xd0, &&op_0xd1, &&op_0xd2, &&op_0xd3, &&op_0xd4, &&op_0xd5, &&op_0xd6, &&op_0xd7, &&op_0xd8, &&op_0xd9, &&op_0xda, &&op_0xdb, &&op_0xdc, &&op_0xdd, &&op_0xde, &&op_0xdf, \
+        &&op_0xe0, &&op_0xe1, &&op_0xe2, &&op_0xe3, &&op_0xe4, &&op_0xe5, &&op_0xe6, &&op_0xe7, &&op_0xe8, &&op_0xe9, &&op_0xea, &&op_0xeb, &&op_0xec, &&op_0xed, &&op_0xee, &&op_0xef, \
+        &&op_0xf0, &&op_0xf1, &&op_0xf2, &&op_0xf3, &&op_0xf4, &&op_0xf5, &&op_0xf6, &&op_0xf7, &&op_0xf8, &&op_0xf9, &&op_0xfa, &&op_0xfb, &&op_0xfc, &&op_0xfd, &&op_0xfe, &&op_0xff
+#endif
+
+template<CpuBus Bus>
+template<bool E, bool M, bool X, typename Predicate>
+bool BasicCpu<Bus>::RunLoop(uint64_t targetCycle, Predicate& stop)
+{
+    m_leaveLoop = false;
+#if CPU_COMPUTED_GOTO
+    // Chaque opcode se termine par son propre saut indirect vers l'opcode suivant,
+    // ce qui donne au prédicteur de branchement un historique par opcode.
+    static const void* const kLabels[256] = { CPU_LABEL_TABLE };
+    constexpr bool Decoded = false;
+#define CPU_OPCODE(op) op_##op:
+#define CPU_NEXT() \
+    EndInstruction(); \
+    if (m_leaveLoop || m_cycles >= targetCycle) return false; \
+    if (stop()) return true; \
+    CheckInterrupts(); \
+    if (m_intWanted) goto interrupt; \
+    if (AtBreakpoint()) return false; \
+    goto *kLabels[ReadInstruction()]
+
+    CheckInterrupts();
+    if (m_intWanted) goto interrupt;
+    goto *kLabels[ReadInstruction()];
+
+interrupt:
+    Read((static_cast<uint32_t>(m_k) << 16) | m_pc);
+    DoInterrupt();
+    CPU_NEXT();
+
+#include "basic_cpu_opcodes.inl"
+#undef CPU_OPCODE
+#undef CPU_NEXT
+#else
+    // Les lignes sont échantillonnées une fois par instruction, en fin d'itération.
+    CheckInterrupts();
+    for (;;)
+    {
+        if (m_intWanted)
+        {
+            Read((static_cast<uint32_t>(m_k) << 16) | m_pc);
+            DoInterrupt();
+        }
+        else
+        {
+            ExecuteOpcode<E, M, X, false>(ReadInstruction());
+            EndInstruction();
+        }
+        if (m_leaveLoop || m_cycles >= targetCycle) return false;
+        if (stop()) return true;
+        CheckInterrupts();
+        if (!m_intWanted && AtBreakpoint()) return false;
+    }
+#endif
+}
+
+#if CPU_ENABLE_JIT
+/**
+ * @brief Traduit le bloc de entry (moteur Jit) : instructions de CpuDecoder, opérandes et cycles
+ * de lecture de entry, immédiats relus depuis leurs pages directes.
+ */
+template<CpuBus Bus>
+template<bool E, bool M, bool X>
+void BasicCpu<Bus>::CompileNative(BlockEntry& entry)
+{
+    uint32_t address = entry.key >> 3;
+    const CpuBasicBlock* block = m_decoder.Find(address, m_mode);
+    if (!CpuJit::IsSupported() || !block || block->instructions.size() < entry.count)
+    {
+        return;
+    }
+    const uint8_t* core = reinterpret_cast<const uint8_t*>(static_cast<CpuCore*>(this));
+    auto offset = [core](const void* member) { return static_cast<int32_t>(static_cast<const uint8_t*>(member) - core); };
+    CpuJitLayout layout = {
+        offset(&m_nextEvent), offset(&m_leaveLoop), offset(&m_blockStamp), offset(m_pageTable.GetPages()), offset(m_speedMap.GetPages()),
+#if CPU_ENABLE_PERF_COUNTERS
+        offset(&m_perf),
+#else
+        -1,
+#endif
+        &JitReadSlow, &JitWriteSlow, &JitIdle, &JitImplied, &JitFireEvents, &JitStep<E, M, X>,
+    };
+    std::array<CpuJitInstruction, CpuDecoder::kMaxInstructions> instructions;
+    for (uint32_t i = 0; i < entry.count; i++)
+    {
+        const CpuInstruction& instruction = block->instructions[i];
+        const BlockOp& op = entry.ops[i];
+        CpuJitInstruction& out = instructions[i];
+        out = { &op, { nullptr, nullptr }, op.opcode, { op.operands[0], op.operands[1], op.operands[2] },
+            instruction.length, op.fetches, op.fetchCycles, { 0, 0 } };
+        for (uint8_t byte = op.fetches; byte < instruction.length; byte++)
+        {
+            // Immédiat de AdrImm : CompileBlock a vérifié que ses pages sont lues directement.
+            uint32_t immediate = (instruction.address & 0xff0000) | ((instruction.address + byte) & 0xffff);
+            out.immediate[byte - 1] = m_pageTable.Lookup(immediate).read + (immediate & (CpuPageTable::kPageSize - 1));
+            out.immediateCycles[byte - 1] = m_speedMap.GetAccessCycles(immediate);
+        }
+    }
+    entry.native = m_jit.Compile(layout, { address, m_mode, m_blockStamp, entry.count * kMaxInstructionCycles,
+        std::span<const CpuJitInstruction>(instructions.data(), entry.count) });
+    if (!entry.native && m_jit.IsFull())
+    {
+        // Zone de code pleine : tout est recompilé à partir des blocs encore chauds.
+        m_jit.Reset();
+        ClearBlockCache();
+    }
+}
+
+/**
+ * @brief Exécute en code natif le bloc trouvé par LookupBlock, compilé à son entrée numéro
+ * CpuJit::GetHotThreshold.
+ * @return Faux (bloc exécuté par RunBlockLoop) hors moteur Jit, avec un prédicat d'arrêt, si
+ * l'événement suivant a raccourci le bloc ou si le bloc n'est pas traduit.
+ */
+template<CpuBus Bus>
+template<bool E, bool M, bool X, typename Predicate>
+bool BasicCpu<Bus>::RunNative(uint32_t count, uint64_t targetCycle)
+{
+    BlockEntry& entry = *m_blockEntry;
+    if (!std::is_same_v<Predicate, NoStop> || m_engine != CpuEngine::Jit || count != entry.count)
+    {
+        return false;
+    }
+    if (!entry.native)
+    {
+        if (++entry.hits != m_jit.GetHotThreshold())
+        {
+            return false;
+        }
+        CompileNative<E, M, X>(entry);
+        if (!entry.native)
+        {
+            return false;
+        }
+    }
+    entry.native(static_cast<CpuCore*>(this), targetCycle);
+    return true;
+}
+#endif
+
+/**
+ * @brief Boucle du moteur Block : exécute les blocs compilés par LookupBlock sans relire ni
+ * décoder les opcodes et leurs opérandes.
+ *
+ * Entre deux instructions d'un bloc, seuls m_leaveLoop, le budget et le prédicat sont testés :
+ * aucun événement programmé n'échoit avant la fin du bloc, CLI le termine, et les lignes levées
+ * par un handler (SetIrq, Nmi, Schedule*) ou un changement de code, de pièges ou de temps d'accès
+ * forcent m_leaveLoop. Les interruptions et les points d'arrêt sont testés entre deux blocs. Sans
+ * bloc compilé, l'instruction suivante est lue et exécutée seule, comme par RunLoop.
+ */
+template<CpuBus Bus>
+template<bool E, bool M, bool X, typename Predicate>
+bool BasicCpu<Bus>::RunBlockLoop(uint64_t targetCycle, Predicate& stop)
+{
+#if CPU_ENABLE_JIT
+#define CPU_RUN_NATIVE() RunNative<E, M, X, Predicate>(remaining, targetCycle)
+#else
+#define CPU_RUN_NATIVE() false
+#endif
+    m_leaveLoop = false;
+    const BlockOp* op = nullptr;
+    uint32_t remaining = 0;
+#if CPU_COMPUTED_GOTO
+    static const void* const kLabels[256] = { CPU_LABEL_TABLE };
+    constexpr bool Decoded = true;
+#define CPU_OPCODE(op) op_##op:
+#define CPU_NEXT() \
+    if (m_leaveLoop || m_cycles >= targetCycle) return false; \
+    if (stop()) return true; \
+    if (--remaining == 0) goto block; \
+    goto *kLabels[ReadDecoded(*++op)]
+
+    // La première instruction n'est pas arrêtée par un point d'arrêt (reprise après un arrêt).
+    CheckInterrupts();
+    if (m_intWanted) goto interrupt;
+    op = LookupBlock(remaining);
+    if (op && CPU_RUN_NATIVE()) goto native;
+    if (op) goto *kLabels[ReadDecoded(*op)];
+    goto single;
+
+block:
+    CheckInterrupts();
+    if (m_intWanted) goto interrupt;
+    op = LookupBlock(remaining);
+    if (op && CPU_RUN_NATIVE()) goto native;
+    if (op) goto *kLabels[ReadDecoded(*op)];
+    if (AtBreakpoint()) return false;
+
+single:
+    ExecuteOpcode<E, M, X, false>(ReadInstruction());
+    EndInstruction();
+    if (m_leaveLoop || m_cycles >= targetCycle) return false;
+    if (stop()) return true;
+    goto block;
+
+interrupt:
+    Read((static_cast<uint32_t>(m_k) << 16) | m_pc);
+    DoInterrupt();
+    if (m_leaveLoop || m_cycles >= targetCycle) return false;
+    if (stop()) return true;
+    goto block;
+
+native:
+    // Le code natif rend la main au budget, sur m_leaveLoop ou à la fin du bloc.
+    if (m_leaveLoop || m_cycles >= targetCycle) return false;
+    goto block;
+
+#include "basic_cpu_opcodes.inl"
+#undef CPU_OPCODE
+#undef CPU_NEXT
+#else
+    CheckInterrupts();
+    bool resume = true;
+    for (;;)
+    {
+        if (m_intWanted)
+        {
+            Read((static_cast<uint32_t>(m_k) << 16) | m_pc);
+            DoInterrupt();
+        }
+        else if ((op = LookupBlock(remaining)) != nullptr)
+        {
+            if (CPU_RUN_NATIVE())
+            {
+                if (m_leaveLoop || m_cycles >= targetCycle) return false;
+                resume = false;
+                CheckInterrupts();
+                continue;
+            }
+            for (;; op++)
+            {
+                ExecuteOpcode<E, M, X, true>(ReadDecoded(*op));
+                if (m_leaveLoop || m_cycles >= targetCycle) return false;
+                if (stop()) return true;
+                if (--remaining == 0) break;
+            }
+            resume = false;
+            CheckInterrupts();
+            continue;
+        }
+        else
+        {
+            if (!resume && AtBreakpoint()) return false;
+            ExecuteOpcode<E, M, X, false>(ReadInstruction());
+            EndInstruction();
+        }
+        resume = false;
+        if (m_leaveLoop || m_cycles >= targetCycle) return false;
+        if (stop()) return true;
+        CheckInterrupts();
+    }
+#endif
+#undef CPU_RUN_NATIVE
+}
+
+#if CPU_COMPUTED_GOTO
+#undef CPU_LABEL_TABLE
+#endif
+
+#undef CPU_PERF_COUNT
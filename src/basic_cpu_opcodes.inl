@@ -0,0 +1,260 @@
+// Traitement des 256 opcodes, inclus par ExecuteOpcode (switch), RunLoop (code threadé) et RunBlockLoop.
+// CPU_OPCODE(op) ouvre le traitement d'un opcode, CPU_NEXT() enchaîne sur la suite.
+// Decoded (constante du contexte d'inclusion) : opérandes pris dans l'instruction pré-décodée.
+// Ce n'est pas parfait, mais fonctionne sur les jeux les plus connus.
+CPU_OPCODE(0x00) { Fetch<Decoded>(); if constexpr (!E) { PushByte(m_k); } PushWord(m_pc, false); PushByte(GetFlags() | 0x10); SetFlag(kFlagI, true); SetFlag(kFlagD, false); m_k = 0; uint16_t vectorAddr = E ? 0xFFFE : 0xFFE6; m_pc = ReadWord(vectorAddr, vectorAddr + 1, true); } CPU_NEXT();
+CPU_OPCODE(0x01) { auto [low, high] = AdrIdx<Decoded>(); Ora<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x02) { Fetch<Decoded>(); if constexpr (!E) PushByte(m_k); PushWord(m_pc, false); PushByte(GetFlags()); SetFlag(kFlagI, true); SetFlag(kFlagD, false); m_k = 0; m_pc = ReadWord(E ? 0xfff4 : 0xffe4, E ? 0xfff5 : 0xffe5, true); } CPU_NEXT();
+CPU_OPCODE(0x03) { auto [low, high] = AdrSr<Decoded>(); Ora<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x04) { auto [low, high] = AdrDp<Decoded>(); Tsb<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x05) { auto [low, high] = AdrDp<Decoded>(); Ora<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x06) { auto [low, high] = AdrDp<Decoded>(); Asl<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x07) { auto [low, high] = AdrIdl<Decoded>(); Ora<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x08) { AdrImp(); PushByte(GetFlags()); } CPU_NEXT();
+CPU_OPCODE(0x09) { auto [low, high] = AdrImm<M>(); Ora<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x0a) { AdrImp(); if constexpr (M) { SetFlag(kFlagC, (m_a & 0x80) != 0); m_a = (m_a & 0xff00) | ((m_a << 1) & 0xff); } else { SetFlag(kFlagC, (m_a & 0x8000) != 0); m_a <<= 1; } SetZnFlags(m_a, M); } CPU_NEXT();
+CPU_OPCODE(0x0b) { AdrImp(); PushWord(m_dp, true); } CPU_NEXT();
+CPU_OPCODE(0x0c) { auto [low, high] = AdrAbs<Decoded>(); Tsb<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x0d) { auto [low, high] = AdrAbs<Decoded>(); Ora<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x0e) { auto [low, high] = AdrAbs<Decoded>(); Asl<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x0f) { auto [low, high] = AdrAbl<Decoded>(); Ora<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x10) { DoBranch<Decoded>(!GetN()); } CPU_NEXT();
+CPU_OPCODE(0x11) { auto [low, high] = AdrIdy<X, Decoded>(false); Ora<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x12) { auto [low, high] = AdrIdp<Decoded>(); Ora<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x13) { auto [low, high] = AdrIsy<Decoded>(); Ora<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x14) { auto [low, high] = AdrDp<Decoded>(); Trb<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x15) { auto [low, high] = AdrDpx<Decoded>(); Ora<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x16) { auto [low, high] = AdrDpx<Decoded>(); Asl<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x17) { auto [low, high] = AdrIly<Decoded>(); Ora<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x18) { AdrImp(); SetFlag(kFlagC, false); } CPU_NEXT();
+CPU_OPCODE(0x19) { auto [low, high] = AdrAby<X, Decoded>(false); Ora<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x1a) { AdrImp(); if constexpr (M) m_a = (m_a & 0xff00) | ((m_a + 1) & 0xff); else m_a++; SetZnFlags(m_a, M); } CPU_NEXT();
+CPU_OPCODE(0x1b) { AdrImp(); m_sp = m_a; if constexpr (E) m_sp = (m_sp & 0xff) | 0x100; } CPU_NEXT();
+CPU_OPCODE(0x1c) { auto [low, high] = AdrAbs<Decoded>(); Trb<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x1d) { auto [low, high] = AdrAbx<X, Decoded>(false); Ora<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x1e) { auto [low, high] = AdrAbx<X, Decoded>(true); Asl<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x1f) { auto [low, high] = AdrAlx<Decoded>(); Ora<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x20) { uint16_t value = FetchWord<Decoded>(false); Idle(); PushWord(m_pc - 1, true); m_pc = value; } CPU_NEXT();
+CPU_OPCODE(0x21) { auto [low, high] = AdrIdx<Decoded>(); And<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x22) { uint32_t value = FetchWord<Decoded>(false); value |= (static_cast<uint32_t>(Fetch<Decoded>()) << 16); PushWord(m_pc - 1, true); m_k = value >> 16; m_pc = value & 0xffff; } CPU_NEXT();
+CPU_OPCODE(0x23) { auto [low, high] = AdrSr<Decoded>(); And<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x24) { auto [low, high] = AdrDp<Decoded>(); Bit<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x25) { auto [low, high] = AdrDp<Decoded>(); And<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x26) { auto [low, high] = AdrDp<Decoded>(); Rol<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x27) { auto [low, high] = AdrIdl<Decoded>(); And<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x28) { AdrImp(); Idle(); SetFlags(PullByte()); } CPU_NEXT();
+CPU_OPCODE(0x29) { auto [low, high] = AdrImm<M>(); And<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x2a) { AdrImp(); uint32_t result = (m_a << 1) | GetFlag(kFlagC); if constexpr (M) { SetFlag(kFlagC, (result & 0x100) != 0); m_a = (m_a & 0xff00) | (result & 0xff); } else { SetFlag(kFlagC, (result & 0x10000) != 0); m_a = result; } SetZnFlags(m_a, M); } CPU_NEXT();
+CPU_OPCODE(0x2b) { AdrImp(); Idle(); m_dp = PullWord(true); SetZnFlags(m_dp, false); } CPU_NEXT();
+CPU_OPCODE(0x2c) { auto [low, high] = AdrAbs<Decoded>(); Bit<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x2d) { auto [low, high] = AdrAbs<Decoded>(); And<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x2e) { auto [low, high] = AdrAbs<Decoded>(); Rol<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x2f) { auto [low, high] = AdrAbl<Decoded>(); And<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x30) { DoBranch<Decoded>(GetN()); } CPU_NEXT();
+CPU_OPCODE(0x31) { auto [low, high] = AdrIdy<X, Decoded>(false); And<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x32) { auto [low, high] = AdrIdp<Decoded>(); And<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x33) { auto [low, high] = AdrIsy<Decoded>(); And<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x34) { auto [low, high] = AdrDpx<Decoded>(); Bit<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x35) { auto [low, high] = AdrDpx<Decoded>(); And<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x36) { auto [low, high] = AdrDpx<Decoded>(); Rol<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x37) { auto [low, high] = AdrIly<Decoded>(); And<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x38) { AdrImp(); SetFlag(kFlagC, true); } CPU_NEXT();
+CPU_OPCODE(0x39) { auto [low, high] = AdrAby<X, Decoded>(false); And<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x3a) { AdrImp(); if constexpr (M) m_a = (m_a & 0xff00) | ((m_a - 1) & 0xff); else m_a--; SetZnFlags(m_a, M); } CPU_NEXT();
+CPU_OPCODE(0x3b) { AdrImp(); m_a = m_sp; SetZnFlags(m_a, false); } CPU_NEXT();
+CPU_OPCODE(0x3c) { auto [low, high] = AdrAbx<X, Decoded>(false); Bit<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x3d) { auto [low, high] = AdrAbx<X, Decoded>(false); And<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x3e) { auto [low, high] = AdrAbx<X, Decoded>(true); Rol<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x3f) { auto [low, high] = AdrAlx<Decoded>(); And<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x40) { AdrImp(); Idle(); SetFlags(PullByte()); m_pc = PullWord(false); if constexpr (!E) m_k = PullByte(); } CPU_NEXT();
+CPU_OPCODE(0x41) { auto [low, high] = AdrIdx<Decoded>(); Eor<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x42) { Fetch<Decoded>(); } CPU_NEXT();
+CPU_OPCODE(0x43) { auto [low, high] = AdrSr<Decoded>(); Eor<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x44) { uint8_t dest = Fetch<Decoded>(); uint8_t src = Fetch<Decoded>(); m_db = dest; Write((static_cast<uint32_t>(dest) << 16) | m_y, Read((static_cast<uint32_t>(src) << 16) | m_x)); m_a--; m_x--; m_y--; if (m_a != 0xffff) { m_pc -= 3; } if constexpr (X) { m_x &= 0xff; m_y &= 0xff; } Idle(); CheckInterrupts(); Idle(); MoveBlock<X, -1>(); } CPU_NEXT();
+CPU_OPCODE(0x45) { auto [low, high] = AdrDp<Decoded>(); Eor<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x46) { auto [low, high] = AdrDp<Decoded>(); Lsr<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x47) { auto [low, high] = AdrIdl<Decoded>(); Eor<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x48) { AdrImp(); if constexpr (M) PushByte(m_a); else PushWord(m_a, true); } CPU_NEXT();
+CPU_OPCODE(0x49) { auto [low, high] = AdrImm<M>(); Eor<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x4a) { AdrImp(); SetFlag(kFlagC, (m_a & 1) != 0); if constexpr (M) m_a = (m_a & 0xff00) | ((m_a >> 1) & 0x7f); else m_a >>= 1; SetZnFlags(m_a, M); } CPU_NEXT();
+CPU_OPCODE(0x4b) { AdrImp(); PushByte(m_k); } CPU_NEXT();
+CPU_OPCODE(0x4c) { m_pc = FetchWord<Decoded>(true); } CPU_NEXT();
+CPU_OPCODE(0x4d) { auto [low, high] = AdrAbs<Decoded>(); Eor<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x4e) { auto [low, high] = AdrAbs<Decoded>(); Lsr<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x4f) { auto [low, high] = AdrAbl<Decoded>(); Eor<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x50) { DoBranch<Decoded>(!GetFlag(kFlagV)); } CPU_NEXT();
+CPU_OPCODE(0x51) { auto [low, high] = AdrIdy<X, Decoded>(false); Eor<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x52) { auto [low, high] = AdrIdp<Decoded>(); Eor<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x53) { auto [low, high] = AdrIsy<Decoded>(); Eor<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x54) { uint8_t dest = Fetch<Decoded>(); uint8_t src = Fetch<Decoded>(); m_db = dest; Write((static_cast<uint32_t>(dest) << 16) | m_y, Read((static_cast<uint32_t>(src) << 16) | m_x)); m_a--; m_x++; m_y++; if (m_a != 0xffff) { m_pc -= 3; } if constexpr (X) { m_x &= 0xff; m_y &= 0xff; } Idle(); CheckInterrupts(); Idle(); MoveBlock<X, 1>(); } CPU_NEXT();
+CPU_OPCODE(0x55) { auto [low, high] = AdrDpx<Decoded>(); Eor<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x56) { auto [low, high] = AdrDpx<Decoded>(); Lsr<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x57) { auto [low, high] = AdrIly<Decoded>(); Eor<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x58) { AdrImp(); SetFlag(kFlagI, false); } CPU_NEXT();
+CPU_OPCODE(0x59) { auto [low, high] = AdrAby<X, Decoded>(false); Eor<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x5a) { AdrImp(); if constexpr (X) PushByte(m_y); else PushWord(m_y, true); } CPU_NEXT();
+CPU_OPCODE(0x5b) { AdrImp(); m_dp = m_a; SetZnFlags(m_dp, false); } CPU_NEXT();
+CPU_OPCODE(0x5c) { uint16_t value = FetchWord<Decoded>(false); CheckInterrupts(); m_k = Fetch<Decoded>(); m_pc = value; } CPU_NEXT();
+CPU_OPCODE(0x5d) { auto [low, high] = AdrAbx<X, Decoded>(false); Eor<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x5e) { auto [low, high] = AdrAbx<X, Decoded>(true); Lsr<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x5f) { auto [low, high] = AdrAlx<Decoded>(); Eor<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x60) { Idle(); Idle(); m_pc = PullWord(false) + 1; CheckInterrupts(); Idle(); } CPU_NEXT();
+CPU_OPCODE(0x61) { auto [low, high] = AdrIdx<Decoded>(); Adc<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x62) { uint16_t value = FetchWord<Decoded>(false); Idle(); PushWord(m_pc + static_cast<int16_t>(value), true); } CPU_NEXT();
+CPU_OPCODE(0x63) { auto [low, high] = AdrSr<Decoded>(); Adc<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x64) { auto [low, high] = AdrDp<Decoded>(); Stz<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x65) { auto [low, high] = AdrDp<Decoded>(); Adc<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x66) { auto [low, high] = AdrDp<Decoded>(); Ror<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x67) { auto [low, high] = AdrIdl<Decoded>(); Adc<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x68) { AdrImp(); Idle(); if constexpr (M) m_a = (m_a & 0xff00) | PullByte(); else m_a = PullWord(true); SetZnFlags(m_a, M); } CPU_NEXT();
+CPU_OPCODE(0x69) { auto [low, high] = AdrImm<M>(); Adc<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x6a) { AdrImp(); bool carry = (m_a & 1) != 0; if constexpr (M) m_a = (m_a & 0xff00) | ((m_a >> 1) & 0x7f) | (GetFlag(kFlagC) << 7); else m_a = (m_a >> 1) | (GetFlag(kFlagC) << 15); SetFlag(kFlagC, carry); SetZnFlags(m_a, M); } CPU_NEXT();
+CPU_OPCODE(0x6b) { Idle(); Idle(); m_pc = PullWord(false) + 1; CheckInterrupts(); m_k = PullByte(); } CPU_NEXT();
+CPU_OPCODE(0x6c) { uint16_t adr = FetchWord<Decoded>(false); uint16_t adr_h = (E && (adr & 0xff) == 0xff) ? (adr & 0xff00) : (adr + 1); m_pc = ReadWord(adr, adr_h, true); } CPU_NEXT();
+CPU_OPCODE(0x6d) { auto [low, high] = AdrAbs<Decoded>(); Adc<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x6e) { auto [low, high] = AdrAbs<Decoded>(); Ror<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x6f) { auto [low, high] = AdrAbl<Decoded>(); Adc<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x70) { DoBranch<Decoded>(GetFlag(kFlagV)); } CPU_NEXT();
+CPU_OPCODE(0x71) { auto [low, high] = AdrIdy<X, Decoded>(false); Adc<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x72) { auto [low, high] = AdrIdp<Decoded>(); Adc<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x73) { auto [low, high] = AdrIsy<Decoded>(); Adc<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x74) { auto [low, high] = AdrDpx<Decoded>(); Stz<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x75) { auto [low, high] = AdrDpx<Decoded>(); Adc<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x76) { auto [low, high] = AdrDpx<Decoded>(); Ror<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x77) { auto [low, high] = AdrIly<Decoded>(); Adc<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x78) { AdrImp(); SetFlag(kFlagI, true); } CPU_NEXT();
+CPU_OPCODE(0x79) { auto [low, high] = AdrAby<X, Decoded>(false); Adc<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x7a) { AdrImp(); Idle(); if constexpr (X) m_y = PullByte(); else m_y = PullWord(true); SetZnFlags(m_y, X); } CPU_NEXT();
+CPU_OPCODE(0x7b) { AdrImp(); m_a = m_dp; SetZnFlags(m_a, false); } CPU_NEXT();
+CPU_OPCODE(0x7c) { uint16_t adr = FetchWord<Decoded>(false); Idle(); uint32_t base_adr = (static_cast<uint32_t>(m_k) << 16) | adr; m_pc = ReadWord(base_adr + m_x, base_adr + m_x + 1, true); } CPU_NEXT();
+CPU_OPCODE(0x7d) { auto [low, high] = AdrAbx<X, Decoded>(false); Adc<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x7e) { auto [low, high] = AdrAbx<X, Decoded>(true); Ror<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x7f) { auto [low, high] = AdrAlx<Decoded>(); Adc<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x80) { DoBranch<Decoded>(true); } CPU_NEXT();
+CPU_OPCODE(0x81) { auto [low, high] = AdrIdx<Decoded>(); Sta<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x82) { m_pc += static_cast<int16_t>(FetchWord<Decoded>(false)); CheckInterrupts(); Idle(); } CPU_NEXT();
+CPU_OPCODE(0x83) { auto [low, high] = AdrSr<Decoded>(); Sta<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x84) { auto [low, high] = AdrDp<Decoded>(); Sty<X>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x85) { auto [low, high] = AdrDp<Decoded>(); Sta<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x86) { auto [low, high] = AdrDp<Decoded>(); Stx<X>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x87) { auto [low, high] = AdrIdl<Decoded>(); Sta<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x88) { AdrImp(); if constexpr (X) m_y = (m_y - 1) & 0xff; else m_y--; SetZnFlags(m_y, X); } CPU_NEXT();
+CPU_OPCODE(0x89) { if constexpr (M) { CheckInterrupts(); SetZ((m_a & Fetch<Decoded>()) == 0); } else { SetZ((m_a & FetchWord<Decoded>(true)) == 0); } } CPU_NEXT();
+CPU_OPCODE(0x8a) { AdrImp(); if constexpr (M) m_a = (m_a & 0xff00) | (m_x & 0xff); else m_a = m_x; SetZnFlags(m_a, M); } CPU_NEXT();
+CPU_OPCODE(0x8b) { AdrImp(); PushByte(m_db); } CPU_NEXT();
+CPU_OPCODE(0x8c) { auto [low, high] = AdrAbs<Decoded>(); Sty<X>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x8d) { auto [low, high] = AdrAbs<Decoded>(); Sta<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x8e) { auto [low, high] = AdrAbs<Decoded>(); Stx<X>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x8f) { auto [low, high] = AdrAbl<Decoded>(); Sta<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x90) { DoBranch<Decoded>(!GetFlag(kFlagC)); } CPU_NEXT();
+CPU_OPCODE(0x91) { auto [low, high] = AdrIdy<X, Decoded>(true); Sta<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x92) { auto [low, high] = AdrIdp<Decoded>(); Sta<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x93) { auto [low, high] = AdrIsy<Decoded>(); Sta<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x94) { auto [low, high] = AdrDpx<Decoded>(); Sty<X>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x95) { auto [low, high] = AdrDpx<Decoded>(); Sta<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x96) { auto [low, high] = AdrDpy<Decoded>(); Stx<X>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x97) { auto [low, high] = AdrIly<Decoded>(); Sta<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x98) { AdrImp(); if constexpr (M) m_a = (m_a & 0xff00) | (m_y & 0xff); else m_a = m_y; SetZnFlags(m_a, M); } CPU_NEXT();
+CPU_OPCODE(0x99) { auto [low, high] = AdrAby<X, Decoded>(true); Sta<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x9a) { AdrImp(); m_sp = E ? ((m_sp & 0xFF00) | (m_x & 0x00FF)) : m_x; } CPU_NEXT();
+CPU_OPCODE(0x9b) { AdrImp(); if constexpr (X) m_y = m_x & 0xff; else m_y = m_x; SetZnFlags(m_y, X); } CPU_NEXT();
+CPU_OPCODE(0x9c) { auto [low, high] = AdrAbs<Decoded>(); Stz<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x9d) { auto [low, high] = AdrAbx<X, Decoded>(true); Sta<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x9e) { auto [low, high] = AdrAbx<X, Decoded>(true); Stz<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0x9f) { auto [low, high] = AdrAlx<Decoded>(); Sta<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xa0) { auto [low, high] = AdrImm<X>(); Ldy<X>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xa1) { auto [low, high] = AdrIdx<Decoded>(); Lda<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xa2) { auto [low, high] = AdrImm<X>(); Ldx<X>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xa3) { auto [low, high] = AdrSr<Decoded>(); Lda<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xa4) { auto [low, high] = AdrDp<Decoded>(); Ldy<X>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xa5) { auto [low, high] = AdrDp<Decoded>(); Lda<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xa6) { auto [low, high] = AdrDp<Decoded>(); Ldx<X>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xa7) { auto [low, high] = AdrIdl<Decoded>(); Lda<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xa8) { AdrImp(); if constexpr (X) m_y = m_a & 0xff; else m_y = m_a; SetZnFlags(m_y, X); } CPU_NEXT();
+CPU_OPCODE(0xa9) { auto [low, high] = AdrImm<M>(); Lda<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xaa) { AdrImp(); if constexpr (X) m_x = m_a & 0xff; else m_x = m_a; SetZnFlags(m_x, X); } CPU_NEXT();
+CPU_OPCODE(0xab) { AdrImp(); Idle(); m_db = PullByte(); SetZnFlags(m_db, true); } CPU_NEXT();
+CPU_OPCODE(0xac) { auto [low, high] = AdrAbs<Decoded>(); Ldy<X>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xad) { auto [low, high] = AdrAbs<Decoded>(); Lda<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xae) { auto [low, high] = AdrAbs<Decoded>(); Ldx<X>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xaf) { auto [low, high] = AdrAbl<Decoded>(); Lda<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xb0) { DoBranch<Decoded>(GetFlag(kFlagC)); } CPU_NEXT();
+CPU_OPCODE(0xb1) { auto [low, high] = AdrIdy<X, Decoded>(false); Lda<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xb2) { auto [low, high] = AdrIdp<Decoded>(); Lda<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xb3) { auto [low, high] = AdrIsy<Decoded>(); Lda<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xb4) { auto [low, high] = AdrDpx<Decoded>(); Ldy<X>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xb5) { auto [low, high] = AdrDpx<Decoded>(); Lda<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xb6) { auto [low, high] = AdrDpy<Decoded>(); Ldx<X>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xb7) { auto [low, high] = AdrIly<Decoded>(); Lda<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xb8) { AdrImp(); SetFlag(kFlagV, false); } CPU_NEXT();
+CPU_OPCODE(0xb9) { auto [low, high] = AdrAby<X, Decoded>(false); Lda<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xba) { AdrImp(); if constexpr (X) m_x = m_sp & 0xff; else m_x = m_sp; SetZnFlags(m_x, X); } CPU_NEXT();
+CPU_OPCODE(0xbb) { AdrImp(); if constexpr (X) m_x = m_y & 0xff; else m_x = m_y; SetZnFlags(m_x, X); } CPU_NEXT();
+CPU_OPCODE(0xbc) { auto [low, high] = AdrAbx<X, Decoded>(false); Ldy<X>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xbd) { auto [low, high] = AdrAbx<X, Decoded>(false); Lda<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xbe) { auto [low, high] = AdrAby<X, Decoded>(false); Ldx<X>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xbf) { auto [low, high] = AdrAlx<Decoded>(); Lda<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xc0) { auto [low, high] = AdrImm<X>(); Cpy<X>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xc1) { auto [low, high] = AdrIdx<Decoded>(); Cmp<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xc2) { uint8_t valToClear = Fetch<Decoded>(); CheckInterrupts(); valToClear &= (E ? (~0x30) : 0xFF); SetFlags(GetFlags() & ~valToClear); Idle(); } CPU_NEXT();
+CPU_OPCODE(0xc3) { auto [low, high] = AdrSr<Decoded>(); Cmp<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xc4) { auto [low, high] = AdrDp<Decoded>(); Cpy<X>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xc5) { auto [low, high] = AdrDp<Decoded>(); Cmp<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xc6) { auto [low, high] = AdrDp<Decoded>(); Dec<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xc7) { auto [low, high] = AdrIdl<Decoded>(); Cmp<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xc8) { AdrImp(); if constexpr (X) m_y = (m_y + 1) & 0xff; else m_y++; SetZnFlags(m_y, X); } CPU_NEXT();
+CPU_OPCODE(0xc9) { auto [low, high] = AdrImm<M>(); Cmp<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xca) { AdrImp(); if constexpr (X) m_x = (m_x - 1) & 0xff; else m_x--; SetZnFlags(m_x, X); } CPU_NEXT();
+CPU_OPCODE(0xcb) { m_waiting = true; m_leaveLoop = true; Idle(); Idle(); } CPU_NEXT();
+CPU_OPCODE(0xcc) { auto [low, high] = AdrAbs<Decoded>(); Cpy<X>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xcd) { auto [low, high] = AdrAbs<Decoded>(); Cmp<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xce) { auto [low, high] = AdrAbs<Decoded>(); Dec<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xcf) { auto [low, high] = AdrAbl<Decoded>(); Cmp<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xd0) { DoBranch<Decoded>(!GetZ()); } CPU_NEXT();
+CPU_OPCODE(0xd1) { auto [low, high] = AdrIdy<X, Decoded>(false); Cmp<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xd2) { auto [low, high] = AdrIdp<Decoded>(); Cmp<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xd3) { auto [low, high] = AdrIsy<Decoded>(); Cmp<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xd4) { auto [low, high] = AdrDp<Decoded>(); PushWord(ReadWord(low, high, false), true); } CPU_NEXT();
+CPU_OPCODE(0xd5) { auto [low, high] = AdrDpx<Decoded>(); Cmp<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xd6) { auto [low, high] = AdrDpx<Decoded>(); Dec<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xd7) { auto [low, high] = AdrIly<Decoded>(); Cmp<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xd8) { AdrImp(); SetFlag(kFlagD, false); } CPU_NEXT();
+CPU_OPCODE(0xd9) { auto [low, high] = AdrAby<X, Decoded>(false); Cmp<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xda) { AdrImp(); if constexpr (X) PushByte(m_x); else PushWord(m_x, true); } CPU_NEXT();
+CPU_OPCODE(0xdb) { m_stopped = true; m_leaveLoop = true; Idle(); Idle(); } CPU_NEXT();
+CPU_OPCODE(0xdc) { uint16_t adr = FetchWord<Decoded>(false); m_pc = ReadWord(adr, (adr + 1) & 0xffff, false); CheckInterrupts(); m_k = Read((adr + 2) & 0xffff); } CPU_NEXT();
+CPU_OPCODE(0xdd) { auto [low, high] = AdrAbx<X, Decoded>(false); Cmp<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xde) { auto [low, high] = AdrAbx<X, Decoded>(true); Dec<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xdf) { auto [low, high] = AdrAlx<Decoded>(); Cmp<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xe0) { auto [low, high] = AdrImm<X>(); Cpx<X>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xe1) { auto [low, high] = AdrIdx<Decoded>(); Sbc<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xe2) { uint8_t val = Fetch<Decoded>(); CheckInterrupts(); val &= (E ? (~0x30) : 0xFF); SetFlags(GetFlags() | val); Idle(); } CPU_NEXT();
+CPU_OPCODE(0xe3) { auto [low, high] = AdrSr<Decoded>(); Sbc<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xe4) { auto [low, high] = AdrDp<Decoded>(); Cpx<X>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xe5) { auto [low, high] = AdrDp<Decoded>(); Sbc<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xe6) { auto [low, high] = AdrDp<Decoded>(); Inc<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xe7) { auto [low, high] = AdrIdl<Decoded>(); Sbc<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xe8) { AdrImp(); if constexpr (X) m_x = (m_x + 1) & 0xff; else m_x++; SetZnFlags(m_x, X); } CPU_NEXT();
+CPU_OPCODE(0xe9) { auto [low, high] = AdrImm<M>(); Sbc<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xea) { AdrImp(); } CPU_NEXT();
+CPU_OPCODE(0xeb) { AdrImp(); uint8_t high = m_a >> 8; m_a = (m_a << 8) | high; SetZnFlags(m_a, true); } CPU_NEXT();
+CPU_OPCODE(0xec) { auto [low, high] = AdrAbs<Decoded>(); Cpx<X>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xed) { auto [low, high] = AdrAbs<Decoded>(); Sbc<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xee) { auto [low, high] = AdrAbs<Decoded>(); Inc<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xef) { auto [low, high] = AdrAbl<Decoded>(); Sbc<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xf0) { DoBranch<Decoded>(GetZ()); } CPU_NEXT();
+CPU_OPCODE(0xf1) { auto [low, high] = AdrIdy<X, Decoded>(false); Sbc<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xf2) { auto [low, high] = AdrIdp<Decoded>(); Sbc<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xf3) { auto [low, high] = AdrIsy<Decoded>(); Sbc<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xf4) { PushWord(FetchWord<Decoded>(false), true); } CPU_NEXT();
+CPU_OPCODE(0xf5) { auto [low, high] = AdrDpx<Decoded>(); Sbc<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xf6) { auto [low, high] = AdrDpx<Decoded>(); Inc<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xf7) { auto [low, high] = AdrIly<Decoded>(); Sbc<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xf8) { AdrImp(); SetFlag(kFlagD, true); } CPU_NEXT();
+CPU_OPCODE(0xf9) { auto [low, high] = AdrAby<X, Decoded>(false); Sbc<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xfa) { AdrImp(); Idle(); if constexpr (X) m_x = PullByte(); else m_x = PullWord(true); SetZnFlags(m_x, X); } CPU_NEXT();
+CPU_OPCODE(0xfb) { AdrImp(); bool old_e = m_e; m_e = GetFlag(kFlagC); SetFlag(kFlagC, old_e); if (m_e != old_e) { if (m_e) { m_p |= kFlagM | kFlagX; m_sp = (m_sp & 0x00FF) | 0x0100; m_x &= 0x00FF; m_y &= 0x00FF; } else { m_p &= ~(kFlagM | kFlagX); } } UpdateMode(); } CPU_NEXT();
+CPU_OPCODE(0xfc) { uint16_t adr = FetchWord<Decoded>(false); PushWord(m_pc - 1, false); Idle(); uint32_t base_adr = (static_cast<uint32_t>(m_k) << 16) | adr; m_pc = ReadWord(base_adr + m_x, base_adr + m_x + 1, true); } CPU_NEXT();
+CPU_OPCODE(0xfd) { auto [low, high] = AdrAbx<X, Decoded>(false); Sbc<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xfe) { auto [low, high] = AdrAbx<X, Decoded>(true); Inc<M>(low, high); } CPU_NEXT();
+CPU_OPCODE(0xff) { auto [low, high] = AdrAlx<Decoded>(); Sbc<M>(low, high); } CPU_NEXT();
\ No newline at end of file
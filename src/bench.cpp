@@ -0,0 +1,282 @@
+/**
+ * @file bench.cpp
+ * @brief Mesures de débit des chemins chauds du coeur sur des programmes représentatifs.
+ *
+ * Usage : bench [millions de cycles maîtres par mesure]
+ *
+ * Chaque programme est exécuté par Cpu (handlers std::function) et par BasicCpu (bus statique),
+ * avec et sans pages directes, puis par BasicCpu avec le moteur Block (blocs pré-décodés) et, si
+ * CPU_ENABLE_JIT vaut 1, avec le moteur Jit. Le nombre d'instructions exécutées pour le budget est
+ * compté une fois par programme (itérations de MVN et entrées d'interruption comprises) ; il ne
+ * dépend pas du chemin, seul le temps d'exécution varie.
+ *
+ * Les lignes "instances" répartissent le même budget sur kInstances coeurs à mémoires distinctes,
+ * avancés à tour de rôle par tranches courtes comme dans une ferme : l'état de chaque coeur doit
+ * alors être rechargé depuis le cache à chaque tranche.
+ */
+#include "cpu.hpp"
+#include "basic_cpu.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+    /**
+     * @brief Bus statique sur les 64 Ko de la banque 0 (les autres banques en sont des miroirs).
+     */
+    struct BenchBus
+    {
+        uint8_t* m_memory;
+
+        uint8_t Read(uint32_t address) { return m_memory[address & 0xffff]; }
+        void Write(uint32_t address, uint8_t value) { m_memory[address & 0xffff] = value; }
+        void Idle(bool) {}
+    };
+
+    /**
+     * @struct BenchProgram
+     * @brief Image mémoire d'un programme de mesure et état des lignes d'interruption.
+     */
+    struct BenchProgram
+    {
+        std::string m_name;
+        std::vector<uint8_t> m_memory;
+        bool m_irq = false;
+    };
+
+    void Poke(std::vector<uint8_t>& memory, uint16_t address, std::initializer_list<uint8_t> bytes)
+    {
+        for (uint8_t value : bytes)
+        {
+            memory[address++] = value;
+        }
+    }
+
+    void PokeWord(std::vector<uint8_t>& memory, uint16_t address, uint16_t value)
+    {
+        memory[address] = value & 0xff;
+        memory[static_cast<uint16_t>(address + 1)] = value >> 8;
+    }
+
+    /**
+     * @brief Programme commun : reset en $8000, passage en mode natif 16 bits, puis le corps en $8004.
+     */
+    BenchProgram MakeProgram(const std::string& name, std::initializer_list<uint8_t> body)
+    {
+        BenchProgram program{ name, std::vector<uint8_t>(0x10000, 0) };
+        PokeWord(program.m_memory, 0xfffc, 0x8000);
+        Poke(program.m_memory, 0x8000, { 0x18, 0xfb, 0xc2, 0x30 });  // CLC, XCE, REP #$30
+        Poke(program.m_memory, 0x8004, body);
+        return program;
+    }
+
+    /**
+     * @brief Chaîne de pointeurs 16 bits parcourant [base, base + 0x1000) dans un ordre pseudo-aléatoire.
+     */
+    void MakePointerChain(std::vector<uint8_t>& memory, uint16_t base, uint32_t seed)
+    {
+        std::vector<uint16_t> order;
+        for (uint16_t offset = 0; offset < 0x1000; offset += 2)
+        {
+            order.push_back(base + offset);
+        }
+        for (size_t i = order.size() - 1; i > 0; i--)
+        {
+            seed = seed * 1103515245 + 12345;
+            std::swap(order[i], order[(seed >> 8) % (i + 1)]);
+        }
+        for (size_t i = 0; i < order.size(); i++)
+        {
+            PokeWord(memory, order[i], order[(i + 1) % order.size()]);
+        }
+    }
+
+    std::vector<BenchProgram> MakePrograms()
+    {
+        std::vector<BenchProgram> programs;
+
+        // LDX #0 ; DEX ; BNE -3 ; BRA début
+        programs.push_back(MakeProgram("branches", { 0xa2, 0x00, 0x00, 0xca, 0xd0, 0xfd, 0x80, 0xf8 }));
+
+        // CLD/SED ; ADC $10 ; SBC $12 ; ADC #$1234 ; SBC #$4321 ; BRA -12
+        for (bool decimal : { false, true })
+        {
+            BenchProgram program = MakeProgram(decimal ? "adc/sbc 16 bits D=1" : "adc/sbc 16 bits D=0",
+                { static_cast<uint8_t>(decimal ? 0xf8 : 0xd8), 0x65, 0x10, 0xe5, 0x12, 0x69, 0x34, 0x12, 0xe9, 0x21, 0x43, 0x80, 0xf4 });
+            PokeWord(program.m_memory, 0x0010, 0x1234);
+            PokeWord(program.m_memory, 0x0012, 0x0567);
+            programs.push_back(std::move(program));
+        }
+
+        // SEP #$20 ; SED ; ADC $10 ; SBC $12 ; ADC #$12 ; SBC #$43 ; BRA -10
+        {
+            BenchProgram program = MakeProgram("adc/sbc 8 bits D=1",
+                { 0xe2, 0x20, 0xf8, 0x65, 0x10, 0xe5, 0x12, 0x69, 0x12, 0xe9, 0x43, 0x80, 0xf6 });
+            program.m_memory[0x0010] = 0x34;
+            program.m_memory[0x0012] = 0x67;
+            programs.push_back(std::move(program));
+        }
+
+        // LDY #0 ; LDA ($10),Y ; STA $10 ; LDA [$20],Y ; STA $20 ; BRA -10
+        {
+            BenchProgram program = MakeProgram("pointeurs (dp),y [dp],y",
+                { 0xa0, 0x00, 0x00, 0xb1, 0x10, 0x85, 0x10, 0xb7, 0x20, 0x85, 0x20, 0x80, 0xf6 });
+            MakePointerChain(program.m_memory, 0x1000, 1);
+            MakePointerChain(program.m_memory, 0x3000, 2);
+            PokeWord(program.m_memory, 0x0010, 0x1000);
+            Poke(program.m_memory, 0x0020, { 0x00, 0x30, 0x00 });
+            programs.push_back(std::move(program));
+        }
+
+        // LDA #$0FFF ; LDX #$1000 ; LDY #$4000 ; MVN $00,$00 ; BRA début
+        programs.push_back(MakeProgram("mvn 4 Ko",
+            { 0xa9, 0xff, 0x0f, 0xa2, 0x00, 0x10, 0xa0, 0x00, 0x40, 0x54, 0x00, 0x00, 0x80, 0xf2 }));
+
+        // CLI ; NOP ; BRA -3 avec IRQ maintenue : le gestionnaire (RTI) est réentré après chaque retour.
+        {
+            BenchProgram program = MakeProgram("interruptions", { 0x58, 0xea, 0x80, 0xfd });
+            PokeWord(program.m_memory, 0xffee, 0x9000);
+            program.m_memory[0x9000] = 0x40;
+            program.m_irq = true;
+            programs.push_back(std::move(program));
+        }
+        return programs;
+    }
+
+    /**
+     * @brief Exécute le budget et renvoie la durée en secondes (meilleure de trois mesures).
+     */
+    template<typename Core>
+    double Measure(Core& core, const std::vector<uint8_t>& image, std::vector<uint8_t>& memory, bool irq, uint64_t budget)
+    {
+        double best = 1e30;
+        for (int run = 0; run < 3; run++)
+        {
+            std::copy(image.begin(), image.end(), memory.begin());    // les pages directes pointent sur ce tampon
+            core.Reset(true);
+            core.SetIrq(irq);
+            core.SetCycles(0);
+            auto start = std::chrono::steady_clock::now();
+            core.RunUntil(budget);
+            best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        }
+        return best;
+    }
+
+    constexpr size_t kInstances = 64;
+    constexpr uint64_t kInstanceSlice = 1364;
+
+    /**
+     * @brief Exécute budget / kInstances cycles sur chacun des kInstances coeurs créés par makeCore,
+     * tranche par tranche, et renvoie la durée totale en secondes (meilleure de trois mesures).
+     */
+    template<typename MakeCore>
+    double MeasureInstances(MakeCore makeCore, const BenchProgram& program, uint64_t budget)
+    {
+        std::vector<std::vector<uint8_t>> memories(kInstances, program.m_memory);
+        std::vector<decltype(makeCore(memories[0]))> cores;
+        for (std::vector<uint8_t>& memory : memories)
+        {
+            cores.push_back(makeCore(memory));
+        }
+        double best = 1e30;
+        for (int run = 0; run < 3; run++)
+        {
+            for (size_t i = 0; i < kInstances; i++)
+            {
+                std::copy(program.m_memory.begin(), program.m_memory.end(), memories[i].begin());
+                cores[i]->Reset(true);
+                cores[i]->SetIrq(program.m_irq);
+                cores[i]->SetCycles(0);
+            }
+            auto start = std::chrono::steady_clock::now();
+            for (uint64_t cycle = 0; cycle < budget / kInstances;)
+            {
+                cycle = std::min(cycle + kInstanceSlice, budget / kInstances);
+                for (auto& core : cores)
+                {
+                    core->RunUntil(cycle);
+                }
+            }
+            best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        }
+        return best;
+    }
+
+    uint64_t CountInstructions(const BenchProgram& program, uint64_t budget)
+    {
+        std::vector<uint8_t> memory = program.m_memory;
+        BasicCpu<BenchBus> core(BenchBus{ memory.data() });
+        core.Reset(true);
+        core.SetIrq(program.m_irq);
+        core.SetCycles(0);
+        uint64_t instructions = 0;
+        core.RunUntil(budget, [&] { instructions++; return false; });
+        return instructions;
+    }
+
+    void Report(const char* path, uint64_t instructions, uint64_t budget, double seconds)
+    {
+        std::printf("    %-26s %9.1f Minstr/s %7.2f ns/instr %9.1f Mcycles/s\n", path,
+            instructions / seconds / 1e6, seconds * 1e9 / instructions, budget / seconds / 1e6);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    uint64_t budget = (argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100) * 1000000;
+
+    for (const BenchProgram& program : MakePrograms())
+    {
+        uint64_t instructions = CountInstructions(program, budget);
+        std::printf("%s : %llu instructions\n", program.m_name.c_str(), static_cast<unsigned long long>(instructions));
+
+        for (bool mapped : { false, true })
+        {
+            std::vector<uint8_t> memory(0x10000);
+            Cpu cpu(
+                [&](uint32_t address) -> uint8_t { return memory[address & 0xffff]; },
+                [&](uint32_t address, uint8_t value) { memory[address & 0xffff] = value; },
+                [](bool) {});
+            BasicCpu<BenchBus> core(BenchBus{ memory.data() });
+            if (mapped)
+            {
+                cpu.MapPages(0x000000, 0x10000, memory.data(), memory.data());
+                core.MapPages(0x000000, 0x10000, memory.data(), memory.data());
+            }
+            Report(mapped ? "Cpu, pages directes" : "Cpu", instructions, budget, Measure(cpu, program.m_memory, memory, program.m_irq, budget));
+            Report(mapped ? "BasicCpu, pages directes" : "BasicCpu", instructions, budget, Measure(core, program.m_memory, memory, program.m_irq, budget));
+            if (mapped)
+            {
+                core.SetEngine(CpuEngine::Block);
+                Report("BasicCpu, blocs", instructions, budget, Measure(core, program.m_memory, memory, program.m_irq, budget));
+#if CPU_ENABLE_JIT
+                core.SetEngine(CpuEngine::Jit);
+                Report("BasicCpu, jit", instructions, budget, Measure(core, program.m_memory, memory, program.m_irq, budget));
+#endif
+            }
+        }
+
+        uint64_t share = budget / kInstances;
+        uint64_t sharedInstructions = CountInstructions(program, share) * kInstances;
+        std::string cpuLabel = "Cpu, " + std::to_string(kInstances) + " instances";
+        std::string coreLabel = "BasicCpu, " + std::to_string(kInstances) + " instances";
+        Report(cpuLabel.c_str(), sharedInstructions, share * kInstances, MeasureInstances([](std::vector<uint8_t>& memory) {
+            return std::make_unique<Cpu>(
+                [&memory](uint32_t address) -> uint8_t { return memory[address & 0xffff]; },
+                [&memory](uint32_t address, uint8_t value) { memory[address & 0xffff] = value; },
+                [](bool) {});
+        }, program, budget));
+        Report(coreLabel.c_str(), sharedInstructions, share * kInstances, MeasureInstances([](std::vector<uint8_t>& memory) {
+            return std::make_unique<BasicCpu<BenchBus>>(BenchBus{ memory.data() });
+        }, program, budget));
+    }
+    return 0;
+}
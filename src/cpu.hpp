@@ -1,21 +1,44 @@
 ﻿#pragma once
 
-#include "LocaleInitializer.hpp"
+#include "cpu_bus_log.hpp"
+#include "cpu_decoder.hpp"
+#include "cpu_perf.hpp"
+#include "cpu_profiler.hpp"
+#include "cpu_trace.hpp"
+#include "cpu_types.hpp"
 
+#include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <span>
 
 #define CPU_API
 
-struct CpuDebugState
+/**
+ * @struct CpuHandlers
+ * @brief Handlers du bus sous forme de pointeurs de fonction et d'un contexte passé à chaque appel.
+ *
+ * Contrairement aux std::function d'un lambda qui capture, la liaison n'alloue rien. read et
+ * write sont obligatoires, idle peut rester nul.
+ */
+struct CpuHandlers
 {
-    uint16_t a, x, y, sp, pc, dp;
-    uint8_t k, db;
-    bool c, z, v, n, i, d, xf, mf, e;
+    void* context = nullptr;
+    uint8_t (*read)(void* context, uint32_t address) = nullptr;
+    void (*write)(void* context, uint32_t address, uint8_t value) = nullptr;
+    void (*idle)(void* context, bool isWaiting) = nullptr;
 };
 
+class CpuPool;
 
+/**
+ * @class Cpu
+ * @brief Façade à effacement de type au-dessus de BasicCpu (voir basic_cpu.hpp).
+ *
+ * Les accès bus passent par des std::function ; pour un coeur entièrement
+ * inliné, instancier directement BasicCpu avec un bus statique.
+ */
 class CPU_API Cpu
 {
 public:
@@ -25,24 +48,180 @@ public:
 
     Cpu(ReadHandler readHandler, WriteHandler writeHandler, IdleHandler idleHandler);
 
+    /**
+     * @brief Coeur lié par pointeurs de fonction : une seule allocation (l'état du coeur), aucune
+     * si un emplacement de pool est libre. L'emplacement est rendu au pool à la destruction.
+     */
+    explicit Cpu(const CpuHandlers& handlers);
+    Cpu(const CpuHandlers& handlers, CpuPool& pool);
+
     ~Cpu();
 
     Cpu(const Cpu&) = delete;
     Cpu& operator=(const Cpu&) = delete;
-    Cpu(Cpu&&) = delete;
-    Cpu& operator=(Cpu&&) = delete;
+    Cpu(Cpu&&) noexcept;
+    Cpu& operator=(Cpu&&) noexcept;
 
     void Reset(bool hard);
 
     void RunOpcode();
 
+    /**
+     * @brief Exécute des instructions tant que le budget de cycles maîtres n'est pas épuisé.
+     * @return Dépassement en cycles maîtres (négatif si RequestExit a arrêté l'exécution).
+     */
+    int64_t RunCycles(int64_t budget);
+
+    /**
+     * @brief Exécute des instructions jusqu'au cycle maître targetCycle.
+     * @return Dépassement en cycles maîtres (négatif en cas d'arrêt anticipé).
+     */
+    int64_t RunUntil(uint64_t targetCycle);
+    int64_t RunUntil(uint64_t targetCycle, const std::function<bool()>& stop);
+
+    void RequestExit();
+
+    /**
+     * @brief Boucle d'exécution de RunCycles/RunUntil (Threaded par défaut).
+     */
+    void SetEngine(CpuEngine engine);
+    CpuEngine GetEngine() const;
+
+    uint64_t GetCycles() const;
+    void SetCycles(uint64_t cycles);
+
+    /**
+     * @brief Carte des temps d'accès utilisée par le compteur de cycles (carte SNES par défaut).
+     */
+    const CpuSpeedMap& GetSpeedMap() const;
+    void SetSpeedMap(const CpuSpeedMap& speedMap);
+    void SetMemSel(bool fastRom);
+
+    /**
+     * @brief Lit et écrit [address, address + size) directement dans la mémoire de l'hôte,
+     * sans appeler les handlers (pages de 4 Ko, voir CpuPageTable).
+     */
+    void MapPages(uint32_t address, uint32_t size, const uint8_t* read, uint8_t* write);
+    void UnmapPages(uint32_t address, uint32_t size);
+
+    /**
+     * @brief Blocs de base décodés depuis les pages directes (voir BasicCpu::DecodeBlock et CpuDecoder).
+     */
+    const CpuBasicBlock* DecodeBlock(uint32_t address, uint8_t mode);
+    void InvalidateCode(uint32_t address, uint32_t size);
+
+    /**
+     * @brief Points d'arrêt et surveillances : RunCycles/RunUntil s'arrêtent avec une cause
+     * (voir BasicCpu::SetBreakpoint et CpuStopReason).
+     */
+    void SetBreakpoint(uint32_t address, bool enabled = true);
+    void SetWatchpoint(uint32_t address, uint32_t size, bool read, bool write, bool enabled = true);
+    void ClearTraps();
+    CpuStopReason GetStopReason() const;
+    uint32_t GetStopAddress() const;
+
     void Nmi();
 
     void SetIrq(bool state);
 
+    /**
+     * @brief NMI et changements de la ligne IRQ appliqués au cycle donné (voir BasicCpu::ScheduleNmi).
+     */
+    bool ScheduleNmi(uint64_t cycle);
+    bool ScheduleIrq(uint64_t cycle, bool level);
+    void CancelScheduledEvents();
+
+    /**
+     * @brief Cycle maître de la prochaine IRQ/NMI de l'hôte : WAI/STP y avancent en une seule étape.
+     */
+    void SetWakeCycle(uint64_t cycle);
+    uint64_t GetWakeCycle() const;
+
     CpuDebugState GetDebugState() const;
 
+    /**
+     * @brief Sauvegarde et restauration de l'état complet, sans allocation (voir CpuSaveState).
+     */
+    bool SaveState(std::span<std::byte> out) const;
+    bool LoadState(std::span<const std::byte> in);
+    static constexpr size_t kSaveStateSize = sizeof(CpuSaveState);
+
+    /**
+     * @brief Instantané de l'état par affectation de structure, sans reconstruire les handlers (voir CpuCore).
+     */
+    const CpuCore& GetCore() const;
+    void SetCore(const CpuCore& core);
+
+#if CPU_ENABLE_PERF_COUNTERS
+    /**
+     * @brief Instructions, cycles, accès par classe, attente et interruptions depuis le dernier
+     * ResetPerfCounters (voir CpuPerfCounters).
+     */
+    CpuPerfCounters GetPerfCounters() const;
+    void ResetPerfCounters();
+#endif
+
+#if CPU_ENABLE_PROFILER
+    /**
+     * @brief Histogrammes d'exécution par adresse et par opcode (voir CpuProfiler).
+     */
+    CpuProfiler& GetProfiler();
+#endif
+
+#if CPU_ENABLE_BUS_LOG
+    /**
+     * @brief Enregistrement ou rejeu des lectures des handlers et des lignes d'interruption
+     * (voir BasicCpu::SetBusLog) ; en rejeu, aucun handler n'est appelé.
+     */
+    void SetBusLog(CpuBusLog* log, CpuBusLogMode mode);
+    bool HasReplayDiverged() const;
+#endif
+
+#if CPU_ENABLE_TRACE
+    /**
+     * @brief Anneau de trace alimenté à chaque instruction (voir CpuTraceRing), nullptr pour l'arrêter.
+     */
+    void SetTraceRing(CpuTraceRing* ring);
+#endif
+
 private:
+    friend class CpuPool;
     struct PImpl;
-    std::unique_ptr<PImpl> m_pimpl;
+    struct PImplDeleter
+    {
+        CpuPool* pool;      // nul : instance allouée sur le tas
+        void operator()(PImpl* pimpl) const;
+    };
+    std::unique_ptr<PImpl, PImplDeleter> m_pimpl;
+};
+
+/**
+ * @class CpuPool
+ * @brief Emplacements préalloués pour l'état de Cpu, réutilisés sans allocation.
+ *
+ * Les capacity emplacements sont alloués en un bloc à la construction, chacun aligné sur une ligne
+ * de cache. Un Cpu construit avec le pool y prend un emplacement libre et retombe sur le tas s'il
+ * n'en reste aucun. Le pool doit survivre à ses Cpu ; il n'est pas synchronisé (un pool par thread).
+ */
+class CPU_API CpuPool
+{
+public:
+    explicit CpuPool(size_t capacity);
+    ~CpuPool();
+
+    CpuPool(const CpuPool&) = delete;
+    CpuPool& operator=(const CpuPool&) = delete;
+
+    size_t GetCapacity() const { return m_capacity; }
+    size_t GetFreeCount() const { return m_freeCount; }
+
+private:
+    friend class Cpu;
+    static constexpr size_t kCacheLine = 64;
+    void* Acquire() { return m_freeCount ? m_free[--m_freeCount] : nullptr; }
+    void Release(void* slot) { m_free[m_freeCount++] = slot; }
+
+    std::byte* m_storage = nullptr;
+    size_t m_capacity = 0, m_slotSize = 0, m_freeCount = 0;
+    std::unique_ptr<void*[]> m_free;
 };
\ No newline at end of file
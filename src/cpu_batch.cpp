@@ -0,0 +1,356 @@
+/**
+ * @file cpu_batch.cpp
+ * @brief Exécution sans affichage d'un grand nombre d'instances Cpu indépendantes.
+ *
+ * Usage : cpu_batch <manifeste> [threads]
+ *
+ * Chaque ligne du manifeste décrit une instance :
+ *     <programme> <adresse de chargement hex> [clé=valeur ...]
+ * Clés reconnues : name, cycles (budget décimal en cycles maîtres), a, x, y, sp, pc, dp, k, db, p
+ * (hexadécimal) et e (0 ou 1). Sans registre explicite, l'instance démarre par un reset matériel
+ * (vecteur $FFFC lu dans le programme). Les lignes vides et celles qui commencent par '#' sont ignorées.
+ *
+ * Les instances sont réparties entre les threads par vol de tâches ; chacune possède son Cpu et
+ * sa mémoire, aucun état mutable n'est partagé. Une instance s'arrête sur STP ou à la fin de son budget.
+ */
+#include "cpu.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <span>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    constexpr uint32_t kAddressSpace = 0x1000000;
+    constexpr uint64_t kDefaultBudget = 21477272;   // une seconde d'horloge maître NTSC
+
+    /**
+     * @struct BatchTask
+     * @brief Instance décrite par une ligne du manifeste.
+     */
+    struct BatchTask
+    {
+        std::string m_name;
+        std::string m_program;
+        uint32_t m_loadAddress = 0;
+        uint64_t m_budget = kDefaultBudget;
+        bool m_hasState = false;
+        CpuSaveState m_state = {
+            .magic = CpuSaveState::kMagic, .version = CpuSaveState::kVersion,
+            .cycles = 0, .wakeCycle = CpuCore::kNoWakeCycle,
+            .a = 0, .x = 0, .y = 0, .sp = 0x01ff, .pc = 0, .dp = 0,
+            .k = 0, .db = 0, .p = 0x34, .state = CpuSaveState::kEmulation
+        };
+    };
+
+    /**
+     * @struct BatchResult
+     * @brief État final et mesures d'une instance.
+     */
+    struct BatchResult
+    {
+        CpuDebugState m_state = {};
+        uint64_t m_cycles = 0;
+        uint64_t m_instructions = 0;
+        double m_seconds = 0.0;
+        bool m_stopped = false;
+        std::string m_error;
+    };
+
+    /**
+     * @class WorkQueue
+     * @brief File de tâches par thread ; un thread sans travail vole la fin de la file d'un autre.
+     */
+    class WorkQueue
+    {
+    public:
+        WorkQueue(size_t workerCount, size_t taskCount)
+            : m_lanes(workerCount)
+        {
+            // Blocs contigus : chaque thread commence par sa propre tranche du manifeste.
+            for (size_t task = 0; task < taskCount; task++)
+            {
+                m_lanes[task * workerCount / taskCount].m_tasks.push_back(task);
+            }
+        }
+
+        bool Pop(size_t worker, size_t& task)
+        {
+            {
+                Lane& lane = m_lanes[worker];
+                std::lock_guard lock(lane.m_mutex);
+                if (!lane.m_tasks.empty())
+                {
+                    task = lane.m_tasks.front();
+                    lane.m_tasks.pop_front();
+                    return true;
+                }
+            }
+            for (size_t i = 1; i < m_lanes.size(); i++)
+            {
+                Lane& victim = m_lanes[(worker + i) % m_lanes.size()];
+                std::lock_guard lock(victim.m_mutex);
+                if (!victim.m_tasks.empty())
+                {
+                    task = victim.m_tasks.back();
+                    victim.m_tasks.pop_back();
+                    return true;
+                }
+            }
+            return false;
+        }
+
+    private:
+        struct Lane
+        {
+            std::mutex m_mutex;
+            std::deque<size_t> m_tasks;
+        };
+
+        std::vector<Lane> m_lanes;
+    };
+
+    /**
+     * @struct WorkerStats
+     * @brief Cumul des mesures d'un thread.
+     */
+    struct WorkerStats
+    {
+        size_t m_tasks = 0;
+        uint64_t m_instructions = 0;
+        double m_seconds = 0.0;
+    };
+
+    bool ParseTask(const std::string& line, const std::string& baseDirectory, BatchTask& task, std::string& error)
+    {
+        std::istringstream stream(line);
+        std::string program, loadAddress;
+        if (!(stream >> program >> loadAddress))
+        {
+            error = "programme et adresse de chargement attendus";
+            return false;
+        }
+        task.m_program = (program.front() == '/' || baseDirectory.empty()) ? program : baseDirectory + "/" + program;
+        task.m_name = program;
+        task.m_loadAddress = static_cast<uint32_t>(std::stoul(loadAddress, nullptr, 16)) & (kAddressSpace - 1);
+
+        std::string field;
+        while (stream >> field)
+        {
+            size_t separator = field.find('=');
+            if (separator == std::string::npos)
+            {
+                error = "clé=valeur attendu : " + field;
+                return false;
+            }
+            std::string key = field.substr(0, separator), value = field.substr(separator + 1);
+            // cycles est lu par stoull : stoul le limiterait à 32 bits là où unsigned long l'est (LLP64).
+            uint32_t hex = (key == "name" || key == "cycles") ? 0 : static_cast<uint32_t>(std::stoul(value, nullptr, key == "e" ? 10 : 16));
+            CpuSaveState& state = task.m_state;
+            if (key == "name") { task.m_name = value; }
+            else if (key == "cycles") { task.m_budget = std::stoull(value); }
+            else if (key == "a") { state.a = static_cast<uint16_t>(hex); task.m_hasState = true; }
+            else if (key == "x") { state.x = static_cast<uint16_t>(hex); task.m_hasState = true; }
+            else if (key == "y") { state.y = static_cast<uint16_t>(hex); task.m_hasState = true; }
+            else if (key == "sp") { state.sp = static_cast<uint16_t>(hex); task.m_hasState = true; }
+            else if (key == "pc") { state.pc = static_cast<uint16_t>(hex); task.m_hasState = true; }
+            else if (key == "dp") { state.dp = static_cast<uint16_t>(hex); task.m_hasState = true; }
+            else if (key == "k") { state.k = static_cast<uint8_t>(hex); task.m_hasState = true; }
+            else if (key == "db") { state.db = static_cast<uint8_t>(hex); task.m_hasState = true; }
+            else if (key == "p") { state.p = static_cast<uint8_t>(hex); task.m_hasState = true; }
+            else if (key == "e") { state.state = hex ? CpuSaveState::kEmulation : 0; task.m_hasState = true; }
+            else
+            {
+                error = "clé inconnue : " + key;
+                return false;
+            }
+        }
+        if (task.m_state.state & CpuSaveState::kEmulation)
+        {
+            // En mode émulation, M et X sont toujours à 1 et la pile reste en page 1.
+            task.m_state.p |= 0x30;
+            task.m_state.sp = 0x0100 | (task.m_state.sp & 0xff);
+        }
+        return true;
+    }
+
+    bool ParseManifest(const std::string& path, std::vector<BatchTask>& tasks)
+    {
+        std::ifstream file(path);
+        if (!file)
+        {
+            std::cerr << "Impossible d'ouvrir le manifeste " << path << std::endl;
+            return false;
+        }
+        size_t slash = path.find_last_of('/');
+        std::string baseDirectory = slash == std::string::npos ? "" : path.substr(0, slash);
+
+        std::string line;
+        for (int lineNumber = 1; std::getline(file, line); lineNumber++)
+        {
+            size_t start = line.find_first_not_of(" \t\r");
+            if (start == std::string::npos || line[start] == '#')
+            {
+                continue;
+            }
+            BatchTask task;
+            std::string error;
+            try
+            {
+                if (!ParseTask(line.substr(start), baseDirectory, task, error))
+                {
+                    std::cerr << path << ":" << lineNumber << " : " << error << std::endl;
+                    return false;
+                }
+            }
+            catch (const std::exception&)
+            {
+                std::cerr << path << ":" << lineNumber << " : valeur numérique invalide" << std::endl;
+                return false;
+            }
+            tasks.push_back(std::move(task));
+        }
+        return true;
+    }
+
+    BatchResult RunTask(const BatchTask& task)
+    {
+        BatchResult result;
+        std::ifstream file(task.m_program, std::ios::binary);
+        if (!file)
+        {
+            result.m_error = "programme introuvable";
+            return result;
+        }
+        std::vector<uint8_t> program((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        if (task.m_loadAddress + program.size() > kAddressSpace)
+        {
+            result.m_error = "programme hors de l'espace 24 bits";
+            return result;
+        }
+
+        // Toute la mémoire est en accès direct : les handlers de lecture et d'écriture ne servent que
+        // de repli. STP se signale par ses deux cycles internes : le handler Idle arrête alors RunUntil.
+        std::vector<uint8_t> memory(kAddressSpace, 0);
+        std::copy(program.begin(), program.end(), memory.begin() + task.m_loadAddress);
+        Cpu cpu(
+            [&](uint32_t address) -> uint8_t { return memory[address & (kAddressSpace - 1)]; },
+            [&](uint32_t address, uint8_t value) { memory[address & (kAddressSpace - 1)] = value; },
+            [&](bool) { if (cpu.GetCore().m_stopped) cpu.RequestExit(); });
+        cpu.MapPages(0, kAddressSpace, memory.data(), memory.data());
+        if (task.m_hasState)
+        {
+            cpu.LoadState(std::as_bytes(std::span(&task.m_state, 1)));
+        }
+        else
+        {
+            cpu.Reset(true);
+        }
+
+        // Sans prédicat d'arrêt, RunUntil garde ses chemins rapides (MVN enchaîné, attente WAI en
+        // un pas) ; les instructions viennent des compteurs de performance. Sans eux, elles sont
+        // comptées par le prédicat, comme dans bench.
+        auto start = std::chrono::steady_clock::now();
+#if CPU_ENABLE_PERF_COUNTERS
+        cpu.RunUntil(cpu.GetCycles() + task.m_budget);
+#else
+        cpu.RunUntil(cpu.GetCycles() + task.m_budget, [&] { result.m_instructions++; return false; });
+#endif
+        result.m_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        result.m_state = cpu.GetDebugState();
+        result.m_cycles = cpu.GetCycles();
+#if CPU_ENABLE_PERF_COUNTERS
+        result.m_instructions = cpu.GetPerfCounters().instructions;
+#endif
+        result.m_stopped = cpu.GetCore().m_stopped;
+        return result;
+    }
+
+    void PrintResult(const BatchTask& task, const BatchResult& result)
+    {
+        if (!result.m_error.empty())
+        {
+            std::printf("%-24s ERREUR %s\n", task.m_name.c_str(), result.m_error.c_str());
+            return;
+        }
+        const CpuDebugState& s = result.m_state;
+        std::printf("%-24s %-6s cycles=%llu instr=%llu PC=%02X:%04X A=%04X X=%04X Y=%04X SP=%04X DP=%04X DB=%02X P=%c%c%c%c%c%c%c%c%c\n",
+            task.m_name.c_str(), result.m_stopped ? "STP" : "BUDGET",
+            static_cast<unsigned long long>(result.m_cycles), static_cast<unsigned long long>(result.m_instructions),
+            s.k, s.pc, s.a, s.x, s.y, s.sp, s.dp, s.db,
+            s.n ? 'N' : '-', s.v ? 'V' : '-', s.mf ? 'M' : '-', s.xf ? 'X' : '-', s.d ? 'D' : '-',
+            s.i ? 'I' : '-', s.z ? 'Z' : '-', s.c ? 'C' : '-', s.e ? 'E' : '-');
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage : " << argv[0] << " <manifeste> [threads]" << std::endl;
+        return 2;
+    }
+
+    std::vector<BatchTask> tasks;
+    if (!ParseManifest(argv[1], tasks))
+    {
+        return 2;
+    }
+    size_t workerCount = argc > 2 ? std::stoul(argv[2]) : std::thread::hardware_concurrency();
+    workerCount = std::max<size_t>(1, std::min(workerCount == 0 ? 1 : workerCount, std::max<size_t>(tasks.size(), 1)));
+
+    std::vector<BatchResult> results(tasks.size());
+    std::vector<WorkerStats> stats(workerCount);
+    WorkQueue queue(workerCount, tasks.size());
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (size_t worker = 0; worker < workerCount; worker++)
+    {
+        workers.emplace_back([&, worker] {
+            size_t task;
+            while (queue.Pop(worker, task))
+            {
+                results[task] = RunTask(tasks[task]);
+                stats[worker].m_tasks++;
+                stats[worker].m_instructions += results[task].m_instructions;
+                stats[worker].m_seconds += results[task].m_seconds;
+            }
+        });
+    }
+    for (std::thread& worker : workers)
+    {
+        worker.join();
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    bool failed = false;
+    for (size_t i = 0; i < tasks.size(); i++)
+    {
+        PrintResult(tasks[i], results[i]);
+        failed |= !results[i].m_error.empty();
+    }
+
+    uint64_t totalInstructions = 0;
+    for (size_t worker = 0; worker < workerCount; worker++)
+    {
+        const WorkerStats& s = stats[worker];
+        totalInstructions += s.m_instructions;
+        std::printf("thread %2zu : %zu instances, %llu instructions, %.1f Minstr/s\n", worker, s.m_tasks,
+            static_cast<unsigned long long>(s.m_instructions), s.m_seconds > 0 ? s.m_instructions / s.m_seconds / 1e6 : 0.0);
+    }
+    std::printf("total : %zu instances sur %zu threads en %.3f s, %.1f Minstr/s\n", tasks.size(), workerCount, elapsed,
+        elapsed > 0 ? totalInstructions / elapsed / 1e6 : 0.0);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,86 @@
+﻿#pragma once
+
+#include <array>
+#include <cstdint>
+
+/**
+ * @struct CpuBcd
+ * @brief ADC/SBC décimaux (D=1) sans branchement, par octet, à partir de tables constexpr.
+ *
+ * Seul l'ajustement du chiffre bas dépend de ses deux chiffres et de la retenue entrante ; il est
+ * lu dans une table (512 octets pour l'addition, 768 pour la soustraction qui peut emprunter
+ * jusqu'à 2). Le chiffre haut ne demande qu'une comparaison. Le mode 16 bits enchaîne deux
+ * octets. Les résultats, V compris, sont ceux de l'ajustement par quartets historique, y compris
+ * pour des opérandes qui ne sont pas du BCD valide.
+ */
+struct CpuBcd
+{
+    static constexpr uint32_t kCarry = 0x100, kOverflow = 0x200;
+
+    /**
+     * @return Octet résultat, plus kCarry et kOverflow (V de la somme avant l'ajustement du chiffre haut).
+     */
+    static constexpr uint32_t Add8(uint8_t a, uint8_t value, uint32_t carry)
+    {
+        uint32_t result = (a & 0xf0) + (value & 0xf0) + kAddLow[(carry << 8) | ((a & 0xf) << 4) | (value & 0xf)];
+        uint32_t carryOut = result > 0x9f;
+        uint32_t overflow = (~(a ^ value) & (a ^ result) & 0x80) >> 7;
+        return ((result + carryOut * 0x60) & 0xff) | (carryOut << 8) | (overflow << 9);
+    }
+
+    /**
+     * @return Mot résultat, plus kCarry et kOverflow décalés de 8 bits (bits 16 et 17).
+     */
+    static constexpr uint32_t Add16(uint16_t a, uint16_t value, uint32_t carry)
+    {
+        uint32_t low = Add8(static_cast<uint8_t>(a), static_cast<uint8_t>(value), carry);
+        uint32_t high = Add8(static_cast<uint8_t>(a >> 8), static_cast<uint8_t>(value >> 8), low >> 8 & 1);
+        return ((high & 0x3ff) << 8) | (low & 0xff);
+    }
+
+    /**
+     * @return Octet résultat, plus kCarry si aucun emprunt ne sort (V reste celui de la soustraction binaire).
+     */
+    static constexpr uint32_t Sub8(uint8_t a, uint8_t value, uint32_t carry)
+    {
+        int result = SubDigits(a, value, 1 - carry);
+        return (result & 0xff) | ((result >> 8) == 0 ? kCarry : 0);
+    }
+
+    static constexpr uint32_t Sub16(uint16_t a, uint16_t value, uint32_t carry)
+    {
+        int low = SubDigits(static_cast<uint8_t>(a), static_cast<uint8_t>(value), 1 - carry);
+        int high = SubDigits(static_cast<uint8_t>(a >> 8), static_cast<uint8_t>(value >> 8), static_cast<uint32_t>(-(low >> 8)));
+        return ((high & 0xff) << 8) | (low & 0xff) | ((high >> 8) == 0 ? kCarry << 8 : 0);
+    }
+
+private:
+    // Différence de deux chiffres après ajustement ; le poids fort négatif est l'emprunt (0 à 2) vers l'octet suivant.
+    static constexpr int SubDigits(uint8_t a, uint8_t value, uint32_t borrow)
+    {
+        int result = (a & 0xf0) - (value & 0xf0) + kSubLow[(borrow << 8) | ((a & 0xf) << 4) | (value & 0xf)];
+        return result - ((result >> 8) & 1) * 0x60;
+    }
+
+    // Chiffre bas ajusté, indexé par (retenue << 8) | (chiffre de A << 4) | chiffre de l'opérande.
+    static constexpr std::array<uint8_t, 2 * 256> kAddLow = [] {
+        std::array<uint8_t, 2 * 256> table{};
+        for (uint32_t index = 0; index < table.size(); index++)
+        {
+            uint32_t result = ((index >> 4) & 0xf) + (index & 0xf) + (index >> 8);
+            table[index] = static_cast<uint8_t>(result > 0x9 ? ((result + 0x6) & 0xf) + 0x10 : result);
+        }
+        return table;
+    }();
+
+    // Idem pour la soustraction, indexé par l'emprunt ; valeur signée (emprunt vers le chiffre haut).
+    static constexpr std::array<int8_t, 3 * 256> kSubLow = [] {
+        std::array<int8_t, 3 * 256> table{};
+        for (uint32_t index = 0; index < table.size(); index++)
+        {
+            int result = static_cast<int>((index >> 4) & 0xf) - static_cast<int>(index & 0xf) - static_cast<int>(index >> 8);
+            table[index] = static_cast<int8_t>((result & 0x10) ? result - 6 : result);
+        }
+        return table;
+    }();
+};
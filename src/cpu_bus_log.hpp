@@ -0,0 +1,195 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <iterator>
+#include <ostream>
+#include <span>
+#include <vector>
+
+// Enregistrement et rejeu du bus : compilés seulement si CPU_ENABLE_BUS_LOG vaut 1.
+#ifndef CPU_ENABLE_BUS_LOG
+#define CPU_ENABLE_BUS_LOG 0
+#endif
+
+/**
+ * @enum CpuBusLogMode
+ * @brief Rôle du journal attaché au coeur (voir BasicCpu::SetBusLog).
+ */
+enum class CpuBusLogMode : uint8_t
+{
+    Off,
+    Record,     // lectures des handlers et changements des lignes d'interruption ajoutés au journal
+    Replay      // valeurs relues dans le journal, aucun appel au bus (lecture, écriture, Idle)
+};
+
+/**
+ * @struct CpuBusRecord
+ * @brief Événement du journal : lecture d'un handler, changement de ligne ou nouvelle origine des cycles.
+ */
+struct CpuBusRecord
+{
+    enum Kind : uint8_t { kRead, kIrqLow, kIrqHigh, kNmi, kCycles };
+
+    Kind kind;
+    uint8_t value;      // octet lu (kRead)
+    uint64_t cycle;     // cycle maître de la lecture, de l'appel SetIrq/Nmi ou de l'application d'un événement
+};
+
+/**
+ * @class CpuBusLog
+ * @brief Journal compact des entrées non déterministes du coeur.
+ *
+ * Format : par enregistrement un varint (écart de cycles << 3 | type), suivi de l'octet lu pour
+ * kRead ; kCycles porte un cycle absolu (après SetCycles en arrière). Une lecture de handler
+ * tient en deux ou trois octets. Le journal grandit en mémoire pendant l'enregistrement ;
+ * Write/Read le transfèrent vers un flux ("C8BL", version).
+ */
+class CpuBusLog
+{
+public:
+    static constexpr uint8_t kVersion = 1;
+
+    void Append(const CpuBusRecord& record)
+    {
+        if (record.cycle < m_writeCycle)
+        {
+            PutVarint(CpuBusRecord::kCycles);
+            PutVarint(record.cycle);
+            m_writeCycle = record.cycle;
+        }
+        PutVarint(((record.cycle - m_writeCycle) << 3) | record.kind);
+        if (record.kind == CpuBusRecord::kRead)
+        {
+            m_data.push_back(record.value);
+        }
+        m_writeCycle = record.cycle;
+        m_count++;
+    }
+
+    /**
+     * @brief Lit l'enregistrement suivant à partir du curseur de rejeu.
+     * @return false en fin de journal ou sur un journal tronqué.
+     */
+    bool Next(CpuBusRecord& record)
+    {
+        for (;;)
+        {
+            uint64_t tag = 0;
+            if (!GetVarint(tag))
+            {
+                return false;
+            }
+            auto kind = static_cast<CpuBusRecord::Kind>(tag & 7);
+            if (kind == CpuBusRecord::kCycles)
+            {
+                if (!GetVarint(m_readCycle))
+                {
+                    return false;
+                }
+                continue;
+            }
+            m_readCycle += tag >> 3;
+            record = { kind, 0, m_readCycle };
+            if (kind == CpuBusRecord::kRead)
+            {
+                if (m_cursor == m_data.size())
+                {
+                    return false;
+                }
+                record.value = m_data[m_cursor++];
+            }
+            return true;
+        }
+    }
+
+    bool Peek(CpuBusRecord& record)
+    {
+        size_t cursor = m_cursor;
+        uint64_t cycle = m_readCycle;
+        bool valid = Next(record);
+        m_cursor = cursor;
+        m_readCycle = cycle;
+        return valid;
+    }
+
+    void Rewind() { m_cursor = 0; m_readCycle = 0; }
+    void Clear() { m_data.clear(); m_cursor = 0; m_count = 0; m_writeCycle = 0; m_readCycle = 0; }
+
+    std::span<const uint8_t> GetData() const { return m_data; }
+    size_t GetRecordCount() const { return m_count; }
+
+    void Write(std::ostream& out) const
+    {
+        out.write("C8BL", 4);
+        out.put(static_cast<char>(kVersion));
+        out.write(reinterpret_cast<const char*>(m_data.data()), static_cast<std::streamsize>(m_data.size()));
+    }
+
+    /**
+     * @brief Remplace le journal par le contenu d'un flux produit par Write ; le curseur revient au début.
+     * Le nombre d'enregistrements et le dernier cycle sont recalculés : Append prolonge le journal
+     * chargé comme l'original.
+     * @return false sur un en-tête invalide ou un journal corrompu (le journal est alors vide).
+     */
+    bool Read(std::istream& in)
+    {
+        char header[5] = {};
+        in.read(header, 5);
+        if (!in || header[0] != 'C' || header[1] != '8' || header[2] != 'B' || header[3] != 'L' || static_cast<uint8_t>(header[4]) != kVersion)
+        {
+            return false;
+        }
+        m_data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        m_count = 0;
+        Rewind();
+        CpuBusRecord record;
+        while (Next(record))
+        {
+            m_count++;
+        }
+        if (m_cursor != m_data.size())
+        {
+            Clear();
+            return false;
+        }
+        m_writeCycle = m_readCycle;
+        Rewind();
+        return true;
+    }
+
+private:
+    void PutVarint(uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            m_data.push_back(static_cast<uint8_t>(value) | 0x80);
+            value >>= 7;
+        }
+        m_data.push_back(static_cast<uint8_t>(value));
+    }
+
+    bool GetVarint(uint64_t& value)
+    {
+        value = 0;
+        for (int shift = 0; shift < 64; shift += 7)
+        {
+            if (m_cursor == m_data.size())
+            {
+                return false;
+            }
+            uint8_t byte = m_data[m_cursor++];
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::vector<uint8_t> m_data;
+    size_t m_cursor = 0, m_count = 0;
+    uint64_t m_writeCycle = 0, m_readCycle = 0;
+};
@@ -0,0 +1,454 @@
+﻿#pragma once
+
+#include "cpu_trace.hpp"
+#include "cpu_types.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Modes d'adressage des opcodes, nommés comme les fonctions Adr* de BasicCpu.
+ * ImmM et ImmX ont un opérande de 1 ou 2 octets selon M ou X ; Imm8 est toujours sur un octet
+ * (REP, SEP, BRK, COP, WDM). Ind, Iax et Ial sont les indirections de JMP/JSR/JML, Rel et Rll
+ * les branches courtes et longues (PER compris), Blk les adresses de banque de MVN/MVP.
+ */
+enum class CpuAddressing : uint8_t
+{
+    Imp, Acc, ImmM, ImmX, Imm8, Dp, Dpx, Dpy, Idp, Idx, Idy, Idl, Ily, Sr, Isy,
+    Abs, Abx, Aby, Abl, Alx, Ind, Iax, Ial, Rel, Rll, Blk
+};
+
+/**
+ * @struct CpuOpcodeInfo
+ * @brief Description statique d'un opcode : mnémonique, mode d'adressage et effet sur le bloc.
+ *
+ * Toute instruction portant un indicateur termine son bloc de base : branche conditionnelle,
+ * saut (appels, retours, BRK/COP compris), changement possible de M/X/E, attente WAI/STP,
+ * ou MVN/MVP qui se répète sur lui-même.
+ */
+struct CpuOpcodeInfo
+{
+    static constexpr uint8_t kBranch = 0x01, kJump = 0x02, kModeChange = 0x04, kHalt = 0x08, kBlockMove = 0x10;
+
+    char mnemonic[4];
+    CpuAddressing addressing;
+    uint8_t flags;
+};
+
+constexpr std::array<CpuOpcodeInfo, 256> MakeCpuOpcodeTable()
+{
+    using enum CpuAddressing;
+    constexpr uint8_t kBranch = CpuOpcodeInfo::kBranch, kJump = CpuOpcodeInfo::kJump, kModeChange = CpuOpcodeInfo::kModeChange;
+    constexpr uint8_t kHalt = CpuOpcodeInfo::kHalt, kBlockMove = CpuOpcodeInfo::kBlockMove;
+    return { {
+            /* $00 */ { "BRK", Imm8, kJump }, { "ORA", Idx, 0 }, { "COP", Imm8, kJump }, { "ORA", Sr, 0 },
+            /* $04 */ { "TSB", Dp, 0 }, { "ORA", Dp, 0 }, { "ASL", Dp, 0 }, { "ORA", Idl, 0 },
+            /* $08 */ { "PHP", Imp, 0 }, { "ORA", ImmM, 0 }, { "ASL", Acc, 0 }, { "PHD", Imp, 0 },
+            /* $0C */ { "TSB", Abs, 0 }, { "ORA", Abs, 0 }, { "ASL", Abs, 0 }, { "ORA", Abl, 0 },
+            /* $10 */ { "BPL", Rel, kBranch }, { "ORA", Idy, 0 }, { "ORA", Idp, 0 }, { "ORA", Isy, 0 },
+            /* $14 */ { "TRB", Dp, 0 }, { "ORA", Dpx, 0 }, { "ASL", Dpx, 0 }, { "ORA", Ily, 0 },
+            /* $18 */ { "CLC", Imp, 0 }, { "ORA", Aby, 0 }, { "INC", Acc, 0 }, { "TCS", Imp, 0 },
+            /* $1C */ { "TRB", Abs, 0 }, { "ORA", Abx, 0 }, { "ASL", Abx, 0 }, { "ORA", Alx, 0 },
+            /* $20 */ { "JSR", Abs, kJump }, { "AND", Idx, 0 }, { "JSL", Abl, kJump }, { "AND", Sr, 0 },
+            /* $24 */ { "BIT", Dp, 0 }, { "AND", Dp, 0 }, { "ROL", Dp, 0 }, { "AND", Idl, 0 },
+            /* $28 */ { "PLP", Imp, kModeChange }, { "AND", ImmM, 0 }, { "ROL", Acc, 0 }, { "PLD", Imp, 0 },
+            /* $2C */ { "BIT", Abs, 0 }, { "AND", Abs, 0 }, { "ROL", Abs, 0 }, { "AND", Abl, 0 },
+            /* $30 */ { "BMI", Rel, kBranch }, { "AND", Idy, 0 }, { "AND", Idp, 0 }, { "AND", Isy, 0 },
+            /* $34 */ { "BIT", Dpx, 0 }, { "AND", Dpx, 0 }, { "ROL", Dpx, 0 }, { "AND", Ily, 0 },
+            /* $38 */ { "SEC", Imp, 0 }, { "AND", Aby, 0 }, { "DEC", Acc, 0 }, { "TSC", Imp, 0 },
+            /* $3C */ { "BIT", Abx, 0 }, { "AND", Abx, 0 }, { "ROL", Abx, 0 }, { "AND", Alx, 0 },
+            /* $40 */ { "RTI", Imp, kJump | kModeChange }, { "EOR", Idx, 0 }, { "WDM", Imm8, 0 }, { "EOR", Sr, 0 },
+            /* $44 */ { "MVP", Blk, kBlockMove }, { "EOR", Dp, 0 }, { "LSR", Dp, 0 }, { "EOR", Idl, 0 },
+            /* $48 */ { "PHA", Imp, 0 }, { "EOR", ImmM, 0 }, { "LSR", Acc, 0 }, { "PHK", Imp, 0 },
+            /* $4C */ { "JMP", Abs, kJump }, { "EOR", Abs, 0 }, { "LSR", Abs, 0 }, { "EOR", Abl, 0 },
+            /* $50 */ { "BVC", Rel, kBranch }, { "EOR", Idy, 0 }, { "EOR", Idp, 0 }, { "EOR", Isy, 0 },
+            /* $54 */ { "MVN", Blk, kBlockMove }, { "EOR", Dpx, 0 }, { "LSR", Dpx, 0 }, { "EOR", Ily, 0 },
+            /* $58 */ { "CLI", Imp, 0 }, { "EOR", Aby, 0 }, { "PHY", Imp, 0 }, { "TCD", Imp, 0 },
+            /* $5C */ { "JML", Abl, kJump }, { "EOR", Abx, 0 }, { "LSR", Abx, 0 }, { "EOR", Alx, 0 },
+            /* $60 */ { "RTS", Imp, kJump }, { "ADC", Idx, 0 }, { "PER", Rll, 0 }, { "ADC", Sr, 0 },
+            /* $64 */ { "STZ", Dp, 0 }, { "ADC", Dp, 0 }, { "ROR", Dp, 0 }, { "ADC", Idl, 0 },
+            /* $68 */ { "PLA", Imp, 0 }, { "ADC", ImmM, 0 }, { "ROR", Acc, 0 }, { "RTL", Imp, kJump },
+            /* $6C */ { "JMP", Ind, kJump }, { "ADC", Abs, 0 }, { "ROR", Abs, 0 }, { "ADC", Abl, 0 },
+            /* $70 */ { "BVS", Rel, kBranch }, { "ADC", Idy, 0 }, { "ADC", Idp, 0 }, { "ADC", Isy, 0 },
+            /* $74 */ { "STZ", Dpx, 0 }, { "ADC", Dpx, 0 }, { "ROR", Dpx, 0 }, { "ADC", Ily, 0 },
+            /* $78 */ { "SEI", Imp, 0 }, { "ADC", Aby, 0 }, { "PLY", Imp, 0 }, { "TDC", Imp, 0 },
+            /* $7C */ { "JMP", Iax, kJump }, { "ADC", Abx, 0 }, { "ROR", Abx, 0 }, { "ADC", Alx, 0 },
+            /* $80 */ { "BRA", Rel, kJump }, { "STA", Idx, 0 }, { "BRL", Rll, kJump }, { "STA", Sr, 0 },
+            /* $84 */ { "STY", Dp, 0 }, { "STA", Dp, 0 }, { "STX", Dp, 0 }, { "STA", Idl, 0 },
+            /* $88 */ { "DEY", Imp, 0 }, { "BIT", ImmM, 0 }, { "TXA", Imp, 0 }, { "PHB", Imp, 0 },
+            /* $8C */ { "STY", Abs, 0 }, { "STA", Abs, 0 }, { "STX", Abs, 0 }, { "STA", Abl, 0 },
+            /* $90 */ { "BCC", Rel, kBranch }, { "STA", Idy, 0 }, { "STA", Idp, 0 }, { "STA", Isy, 0 },
+            /* $94 */ { "STY", Dpx, 0 }, { "STA", Dpx, 0 }, { "STX", Dpy, 0 }, { "STA", Ily, 0 },
+            /* $98 */ { "TYA", Imp, 0 }, { "STA", Aby, 0 }, { "TXS", Imp, 0 }, { "TXY", Imp, 0 },
+            /* $9C */ { "STZ", Abs, 0 }, { "STA", Abx, 0 }, { "STZ", Abx, 0 }, { "STA", Alx, 0 },
+            /* $A0 */ { "LDY", ImmX, 0 }, { "LDA", Idx, 0 }, { "LDX", ImmX, 0 }, { "LDA", Sr, 0 },
+            /* $A4 */ { "LDY", Dp, 0 }, { "LDA", Dp, 0 }, { "LDX", Dp, 0 }, { "LDA", Idl, 0 },
+            /* $A8 */ { "TAY", Imp, 0 }, { "LDA", ImmM, 0 }, { "TAX", Imp, 0 }, { "PLB", Imp, 0 },
+            /* $AC */ { "LDY", Abs, 0 }, { "LDA", Abs, 0 }, { "LDX", Abs, 0 }, { "LDA", Abl, 0 },
+            /* $B0 */ { "BCS", Rel, kBranch }, { "LDA", Idy, 0 }, { "LDA", Idp, 0 }, { "LDA", Isy, 0 },
+            /* $B4 */ { "LDY", Dpx, 0 }, { "LDA", Dpx, 0 }, { "LDX", Dpy, 0 }, { "LDA", Ily, 0 },
+            /* $B8 */ { "CLV", Imp, 0 }, { "LDA", Aby, 0 }, { "TSX", Imp, 0 }, { "TYX", Imp, 0 },
+            /* $BC */ { "LDY", Abx, 0 }, { "LDA", Abx, 0 }, { "LDX", Aby, 0 }, { "LDA", Alx, 0 },
+            /* $C0 */ { "CPY", ImmX, 0 }, { "CMP", Idx, 0 }, { "REP", Imm8, kModeChange }, { "CMP", Sr, 0 },
+            /* $C4 */ { "CPY", Dp, 0 }, { "CMP", Dp, 0 }, { "DEC", Dp, 0 }, { "CMP", Idl, 0 },
+            /* $C8 */ { "INY", Imp, 0 }, { "CMP", ImmM, 0 }, { "DEX", Imp, 0 }, { "WAI", Imp, kHalt },
+            /* $CC */ { "CPY", Abs, 0 }, { "CMP", Abs, 0 }, { "DEC", Abs, 0 }, { "CMP", Abl, 0 },
+            /* $D0 */ { "BNE", Rel, kBranch }, { "CMP", Idy, 0 }, { "CMP", Idp, 0 }, { "CMP", Isy, 0 },
+            /* $D4 */ { "PEI", Idp, 0 }, { "CMP", Dpx, 0 }, { "DEC", Dpx, 0 }, { "CMP", Ily, 0 },
+            /* $D8 */ { "CLD", Imp, 0 }, { "CMP", Aby, 0 }, { "PHX", Imp, 0 }, { "STP", Imp, kHalt },
+            /* $DC */ { "JML", Ial, kJump }, { "CMP", Abx, 0 }, { "DEC", Abx, 0 }, { "CMP", Alx, 0 },
+            /* $E0 */ { "CPX", ImmX, 0 }, { "SBC", Idx, 0 }, { "SEP", Imm8, kModeChange }, { "SBC", Sr, 0 },
+            /* $E4 */ { "CPX", Dp, 0 }, { "SBC", Dp, 0 }, { "INC", Dp, 0 }, { "SBC", Idl, 0 },
+            /* $E8 */ { "INX", Imp, 0 }, { "SBC", ImmM, 0 }, { "NOP", Imp, 0 }, { "XBA", Imp, 0 },
+            /* $EC */ { "CPX", Abs, 0 }, { "SBC", Abs, 0 }, { "INC", Abs, 0 }, { "SBC", Abl, 0 },
+            /* $F0 */ { "BEQ", Rel, kBranch }, { "SBC", Idy, 0 }, { "SBC", Idp, 0 }, { "SBC", Isy, 0 },
+            /* $F4 */ { "PEA", Abs, 0 }, { "SBC", Dpx, 0 }, { "INC", Dpx, 0 }, { "SBC", Ily, 0 },
+            /* $F8 */ { "SED", Imp, 0 }, { "SBC", Aby, 0 }, { "PLX", Imp, 0 }, { "XCE", Imp, kModeChange },
+            /* $FC */ { "JSR", Iax, kJump }, { "SBC", Abx, 0 }, { "INC", Abx, 0 }, { "SBC", Alx, 0 }
+        } };
+}
+
+/**
+ * @struct CpuInstruction
+ * @brief Instruction décodée : adresse K:PC, opcode et octets d'opérande déjà lus.
+ */
+struct CpuInstruction
+{
+    uint32_t address;
+    uint8_t opcode;
+    uint8_t length;
+    uint8_t operands[3];
+};
+
+/**
+ * @brief Cause de la fin d'un bloc de base.
+ * Control : la dernière instruction porte un indicateur de CpuOpcodeInfo.
+ * Unmapped : l'instruction suivante n'est pas entièrement dans les pages directes.
+ * Limit : le bloc a atteint CpuDecoder::kMaxInstructions.
+ */
+enum class CpuBlockEnd : uint8_t { Control, Unmapped, Limit };
+
+/**
+ * @struct CpuBasicBlock
+ * @brief Suite d'instructions exécutées sans rupture depuis address dans un mode donné.
+ * nextAddress est l'adresse qui suit la dernière instruction (PC reboucle dans la banque).
+ */
+struct CpuBasicBlock
+{
+    uint32_t address;
+    uint32_t nextAddress;
+    uint8_t mode;
+    CpuBlockEnd end;
+    std::vector<CpuInstruction> instructions;
+};
+
+/**
+ * @class CpuDecoder
+ * @brief Décodeur et cache de blocs de base par clé (K:PC, mode).
+ *
+ * Le mode est celui de CpuCore::m_mode : bit 1 pour M, bit 0 pour X, kModeEmulation pour E.
+ * Les octets ne sont lus que dans les pages directes de CpuPageTable (LookupHost), sans effet
+ * de bord : le code exécuté depuis une page gérée par le handler n'est jamais décodé.
+ *
+ * Chaque page de 4 Ko garde la liste des blocs qui y ont des octets. Invalidate supprime les
+ * blocs couvrant un octet écrit ; l'hôte doit l'appeler pour les écritures qui ne passent pas
+ * par le coeur (DMA, chargement de Rom). Une page dont les blocs ont été invalidés
+ * kSelfModifyingLimit fois n'est plus décodée, jusqu'à InvalidatePages ou Clear.
+ * GetGeneration change à chaque suppression : les pointeurs de bloc conservés ailleurs
+ * sont à revalider.
+ */
+class CpuDecoder
+{
+public:
+    static constexpr uint8_t kModeEmulation = 4;
+    static constexpr size_t kMaxInstructions = 64;
+    static constexpr uint8_t kSelfModifyingLimit = 16;
+    static constexpr std::array<CpuOpcodeInfo, 256> kOpcodes = MakeCpuOpcodeTable();
+
+    static constexpr uint8_t GetMode(bool e, bool m, bool x) { return e ? kModeEmulation : ((m ? 2 : 0) | (x ? 1 : 0)); }
+    static constexpr bool IsAccumulator8(uint8_t mode) { return mode == kModeEmulation || (mode & 2); }
+    static constexpr bool IsIndex8(uint8_t mode) { return mode == kModeEmulation || (mode & 1); }
+
+    /**
+     * @brief Longueur de l'instruction (opcode compris) dans le mode indiqué.
+     */
+    static constexpr uint8_t GetLength(uint8_t opcode, uint8_t mode)
+    {
+        switch (kOpcodes[opcode].addressing)
+        {
+            case CpuAddressing::Imp: case CpuAddressing::Acc: return 1;
+            case CpuAddressing::ImmM: return IsAccumulator8(mode) ? 2 : 3;
+            case CpuAddressing::ImmX: return IsIndex8(mode) ? 2 : 3;
+            case CpuAddressing::Abs: case CpuAddressing::Abx: case CpuAddressing::Aby: case CpuAddressing::Ind:
+            case CpuAddressing::Iax: case CpuAddressing::Ial: case CpuAddressing::Rll: case CpuAddressing::Blk: return 3;
+            case CpuAddressing::Abl: case CpuAddressing::Alx: return 4;
+            default: return 2;
+        }
+    }
+
+    /**
+     * @brief Décode l'instruction en address depuis les pages directes.
+     * @return false si l'un de ses octets passe par le handler.
+     */
+    static bool DecodeInstruction(const CpuPageTable& pageTable, uint32_t address, uint8_t mode, CpuInstruction& instruction)
+    {
+        uint8_t bytes[4] = {};
+        for (uint8_t i = 0; i == 0 || i < GetLength(bytes[0], mode); i++)
+        {
+            uint32_t byteAddress = (address & 0xff0000) | ((address + i) & 0xffff);
+            const uint8_t* page = pageTable.LookupHost(byteAddress).read;
+            if (!page)
+            {
+                return false;
+            }
+            bytes[i] = page[byteAddress & (CpuPageTable::kPageSize - 1)];
+        }
+        instruction = { .address = address & 0xffffff, .opcode = bytes[0], .length = GetLength(bytes[0], mode),
+            .operands = { bytes[1], bytes[2], bytes[3] } };
+        return true;
+    }
+
+    /**
+     * @brief Bloc commençant en address dans mode, décodé au premier appel puis servi depuis le cache.
+     * @return nullptr si la première instruction n'est pas dans les pages directes.
+     * Le pointeur reste valide jusqu'à l'invalidation du bloc ou Clear.
+     */
+    const CpuBasicBlock* Decode(const CpuPageTable& pageTable, uint32_t address, uint8_t mode)
+    {
+        address &= 0xffffff;
+        uint32_t key = Key(address, mode);
+        if (auto it = m_blocks.find(key); it != m_blocks.end())
+        {
+            return &it->second;
+        }
+
+        if (!m_pageInvalidations.empty() && m_pageInvalidations[address >> CpuPageTable::kPageShift] >= kSelfModifyingLimit)
+        {
+            return nullptr;
+        }
+
+        CpuBasicBlock block{ .address = address, .nextAddress = address, .mode = mode, .end = CpuBlockEnd::Limit, .instructions = {} };
+        CpuInstruction instruction;
+        while (block.instructions.size() < kMaxInstructions)
+        {
+            if (!DecodeInstruction(pageTable, block.nextAddress, mode, instruction))
+            {
+                block.end = CpuBlockEnd::Unmapped;
+                break;
+            }
+            block.instructions.push_back(instruction);
+            block.nextAddress = (address & 0xff0000) | ((block.nextAddress + instruction.length) & 0xffff);
+            if (kOpcodes[instruction.opcode].flags)
+            {
+                block.end = CpuBlockEnd::Control;
+                break;
+            }
+        }
+        if (block.instructions.empty())
+        {
+            return nullptr;
+        }
+
+        if (m_pageBlocks.empty())
+        {
+            m_pageBlocks.resize(CpuPageTable::kPageCount);
+            m_pageInvalidations.resize(CpuPageTable::kPageCount);
+        }
+        for (const CpuInstruction& decoded : block.instructions)
+        {
+            AddToPage(decoded.address >> CpuPageTable::kPageShift, key);
+            AddToPage(LastByte(decoded) >> CpuPageTable::kPageShift, key);
+        }
+        return &m_blocks.emplace(key, std::move(block)).first->second;
+    }
+
+    const CpuBasicBlock* Find(uint32_t address, uint8_t mode) const
+    {
+        auto it = m_blocks.find(Key(address & 0xffffff, mode));
+        return it != m_blocks.end() ? &it->second : nullptr;
+    }
+
+    /**
+     * @brief Supprime les blocs dont une instruction couvre address.
+     * @return Vrai si la page de address ne contient plus aucun bloc.
+     */
+    bool Invalidate(uint32_t address)
+    {
+        address &= 0xffffff;
+        if (m_pageBlocks.empty())
+        {
+            return true;
+        }
+        std::vector<uint32_t>& keys = m_pageBlocks[address >> CpuPageTable::kPageShift];
+        for (size_t i = 0; i < keys.size();)
+        {
+            auto it = m_blocks.find(keys[i]);
+            if (it == m_blocks.end())
+            {
+                keys[i] = keys.back();
+                keys.pop_back();
+            }
+            else if (Covers(it->second, address))
+            {
+                m_blocks.erase(it);
+                keys[i] = keys.back();
+                keys.pop_back();
+                m_generation++;
+                uint8_t& invalidations = m_pageInvalidations[address >> CpuPageTable::kPageShift];
+                invalidations += invalidations < kSelfModifyingLimit;
+            }
+            else
+            {
+                i++;
+            }
+        }
+        return keys.empty();
+    }
+
+    /**
+     * @brief Supprime tous les blocs ayant des octets dans les pages de [address, address + size).
+     */
+    void InvalidatePages(uint32_t address, uint32_t size)
+    {
+        if (m_pageBlocks.empty() || size == 0)
+        {
+            return;
+        }
+        uint64_t first = (address & 0xffffff) >> CpuPageTable::kPageShift;
+        uint64_t last = ((address & 0xffffff) + static_cast<uint64_t>(size) - 1) >> CpuPageTable::kPageShift;
+        for (uint64_t page = first; page <= last && page - first < CpuPageTable::kPageCount; page++)
+        {
+            std::vector<uint32_t>& keys = m_pageBlocks[page & (CpuPageTable::kPageCount - 1)];
+            for (uint32_t key : keys)
+            {
+                m_generation += m_blocks.erase(key);
+            }
+            keys.clear();
+            m_pageInvalidations[page & (CpuPageTable::kPageCount - 1)] = 0;
+        }
+    }
+
+    void Clear()
+    {
+        m_blocks.clear();
+        m_pageBlocks.clear();
+        m_pageInvalidations.clear();
+        m_generation++;
+    }
+
+    bool IsCodePage(uint32_t index) const { return !m_pageBlocks.empty() && !m_pageBlocks[index].empty(); }
+    size_t GetBlockCount() const { return m_blocks.size(); }
+    uint64_t GetGeneration() const { return m_generation; }
+
+    /**
+     * @brief Texte assembleur de l'instruction, par exemple "LDA $12,X" ou "BNE $8002".
+     */
+    static std::string Disassemble(const CpuInstruction& instruction)
+    {
+        const CpuOpcodeInfo& info = kOpcodes[instruction.opcode];
+        const uint8_t* operands = instruction.operands;
+        uint32_t byte = operands[0], word = operands[0] | (operands[1] << 8), isWord = instruction.length == 3;
+        uint32_t next = instruction.address + instruction.length;
+        char text[32];
+        switch (info.addressing)
+        {
+            case CpuAddressing::Imp: std::snprintf(text, sizeof(text), "%s", info.mnemonic); break;
+            case CpuAddressing::Acc: std::snprintf(text, sizeof(text), "%s A", info.mnemonic); break;
+            case CpuAddressing::ImmM: case CpuAddressing::ImmX: case CpuAddressing::Imm8:
+                std::snprintf(text, sizeof(text), isWord ? "%s #$%04X" : "%s #$%02X", info.mnemonic, isWord ? word : byte); break;
+            case CpuAddressing::Dp: std::snprintf(text, sizeof(text), "%s $%02X", info.mnemonic, byte); break;
+            case CpuAddressing::Dpx: std::snprintf(text, sizeof(text), "%s $%02X,X", info.mnemonic, byte); break;
+            case CpuAddressing::Dpy: std::snprintf(text, sizeof(text), "%s $%02X,Y", info.mnemonic, byte); break;
+            case CpuAddressing::Idp: std::snprintf(text, sizeof(text), "%s ($%02X)", info.mnemonic, byte); break;
+            case CpuAddressing::Idx: std::snprintf(text, sizeof(text), "%s ($%02X,X)", info.mnemonic, byte); break;
+            case CpuAddressing::Idy: std::snprintf(text, sizeof(text), "%s ($%02X),Y", info.mnemonic, byte); break;
+            case CpuAddressing::Idl: std::snprintf(text, sizeof(text), "%s [$%02X]", info.mnemonic, byte); break;
+            case CpuAddressing::Ily: std::snprintf(text, sizeof(text), "%s [$%02X],Y", info.mnemonic, byte); break;
+            case CpuAddressing::Sr: std::snprintf(text, sizeof(text), "%s $%02X,S", info.mnemonic, byte); break;
+            case CpuAddressing::Isy: std::snprintf(text, sizeof(text), "%s ($%02X,S),Y", info.mnemonic, byte); break;
+            case CpuAddressing::Abs: std::snprintf(text, sizeof(text), "%s $%04X", info.mnemonic, word); break;
+            case CpuAddressing::Abx: std::snprintf(text, sizeof(text), "%s $%04X,X", info.mnemonic, word); break;
+            case CpuAddressing::Aby: std::snprintf(text, sizeof(text), "%s $%04X,Y", info.mnemonic, word); break;
+            case CpuAddressing::Abl: std::snprintf(text, sizeof(text), "%s $%06X", info.mnemonic, word | (operands[2] << 16)); break;
+            case CpuAddressing::Alx: std::snprintf(text, sizeof(text), "%s $%06X,X", info.mnemonic, word | (operands[2] << 16)); break;
+            case CpuAddressing::Ind: std::snprintf(text, sizeof(text), "%s ($%04X)", info.mnemonic, word); break;
+            case CpuAddressing::Iax: std::snprintf(text, sizeof(text), "%s ($%04X,X)", info.mnemonic, word); break;
+            case CpuAddressing::Ial: std::snprintf(text, sizeof(text), "%s [$%04X]", info.mnemonic, word); break;
+            case CpuAddressing::Rel: std::snprintf(text, sizeof(text), "%s $%04X", info.mnemonic, (next + static_cast<int8_t>(byte)) & 0xffff); break;
+            case CpuAddressing::Rll: std::snprintf(text, sizeof(text), "%s $%04X", info.mnemonic, (next + word) & 0xffff); break;
+            case CpuAddressing::Blk: std::snprintf(text, sizeof(text), "%s $%02X,$%02X", info.mnemonic, operands[1], operands[0]); break;
+        }
+        return text;
+    }
+
+    /**
+     * @brief Texte assembleur d'un enregistrement de trace (mnémonique seul sans kOperandsValid).
+     */
+    static std::string Disassemble(const CpuTraceRecord& record)
+    {
+        uint8_t mode = (record.flags & CpuTraceRecord::kEmulation) ? kModeEmulation : ((record.p >> 4) & 3);
+        if (!(record.flags & CpuTraceRecord::kOperandsValid))
+        {
+            return kOpcodes[record.opcode].mnemonic;
+        }
+        CpuInstruction instruction = { .address = (static_cast<uint32_t>(record.k) << 16) | record.pc, .opcode = record.opcode,
+            .length = GetLength(record.opcode, mode), .operands = { record.operands[0], record.operands[1], record.operands[2] } };
+        return Disassemble(instruction);
+    }
+
+    /**
+     * @brief Écrit une ligne par instruction : adresse, octets et texte assembleur.
+     */
+    static void WriteBlock(std::ostream& out, const CpuBasicBlock& block)
+    {
+        char line[64];
+        for (const CpuInstruction& instruction : block.instructions)
+        {
+            char bytes[16] = {};
+            int size = std::snprintf(bytes, sizeof(bytes), "%02X", instruction.opcode);
+            for (int i = 1; i < instruction.length; i++)
+            {
+                size += std::snprintf(bytes + size, sizeof(bytes) - size, " %02X", instruction.operands[i - 1]);
+            }
+            std::snprintf(line, sizeof(line), "%02X:%04X  %-12s %s\n", instruction.address >> 16, instruction.address & 0xffff,
+                bytes, Disassemble(instruction).c_str());
+            out << line;
+        }
+    }
+
+private:
+    static uint32_t Key(uint32_t address, uint8_t mode) { return (address << 3) | mode; }
+    static uint32_t LastByte(const CpuInstruction& instruction)
+    {
+        return (instruction.address & 0xff0000) | ((instruction.address + instruction.length - 1) & 0xffff);
+    }
+
+    static bool Covers(const CpuBasicBlock& block, uint32_t address)
+    {
+        return std::any_of(block.instructions.begin(), block.instructions.end(), [&](const CpuInstruction& instruction)
+        {
+            return (address & 0xff0000) == (instruction.address & 0xff0000)
+                && static_cast<uint16_t>(address - instruction.address) < instruction.length;
+        });
+    }
+
+    void AddToPage(uint32_t page, uint32_t key)
+    {
+        std::vector<uint32_t>& keys = m_pageBlocks[page];
+        if (std::find(keys.begin(), keys.end(), key) == keys.end())
+        {
+            keys.push_back(key);
+        }
+    }
+
+    std::unordered_map<uint32_t, CpuBasicBlock> m_blocks;
+    std::vector<std::vector<uint32_t>> m_pageBlocks;
+    std::vector<uint8_t> m_pageInvalidations;
+    uint64_t m_generation = 0;
+};
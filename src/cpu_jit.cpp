@@ -0,0 +1,1065 @@
+#include "cpu_jit.hpp"
+
+#if CPU_ENABLE_JIT
+#include "cpu_decoder.hpp"
+#include "cpu_perf.hpp"
+#include "cpu_types.hpp"
+
+#include <cstddef>
+#include <initializer_list>
+#include <string_view>
+#include <vector>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+#if CPU_JIT_X64
+namespace
+{
+    // Registres x86-64, numérotés comme dans l'encodage.
+    enum Register : uint8_t { kRax, kRcx, kRdx, kRbx, kRsp, kRbp, kRsi, kRdi, kR8, kR9, kR10, kR11, kR12, kR13, kR14, kR15 };
+
+    // Conditions des sauts (Jcc).
+    enum Condition : uint8_t { kBelow = 0x2, kAboveEqual = 0x3, kEqual = 0x4, kNotEqual = 0x5 };
+
+    // Préfixes d'une instruction : registre 8 bits (spl..dil exigent REX), opérande 16 bits, opérande 64 bits.
+    enum Prefix : uint8_t { kNone, kByteReg, kWord, kWide };
+
+    // Arguments entiers des fonctions du coeur.
+#if defined(_WIN32)
+    constexpr uint8_t kArg0 = kRcx, kArg1 = kRdx, kArg2 = kR8;
+#else
+    constexpr uint8_t kArg0 = kRdi, kArg1 = kRsi, kArg2 = kRdx;
+#endif
+
+    constexpr size_t kNoLabel = ~size_t(0);
+
+    static_assert(sizeof(CpuPage) == 16 && offsetof(CpuPage, read) == 0 && offsetof(CpuPage, write) == 8);
+
+    /**
+     * @class Assembler
+     * @brief Écriture des instructions x86-64 dans la zone de code.
+     *
+     * Les opérandes mémoire sont relatifs à rbx (le CpuCore). Un dépassement de la place restante
+     * est noté et rend le code produit inutilisable.
+     */
+    class Assembler
+    {
+    public:
+        Assembler(uint8_t* code, size_t capacity) : m_code(code), m_capacity(capacity) {}
+
+        size_t GetSize() const { return m_size; }
+        bool IsOverflowed() const { return m_overflowed; }
+
+        void Byte(uint8_t value)
+        {
+            if (m_size < m_capacity)
+            {
+                m_code[m_size++] = value;
+            }
+            else
+            {
+                m_overflowed = true;
+            }
+        }
+        void Bytes(std::initializer_list<uint8_t> values) { for (uint8_t value : values) Byte(value); }
+        void Imm16(uint32_t value) { Byte(value & 0xff); Byte((value >> 8) & 0xff); }
+        void Imm32(uint32_t value) { Imm16(value & 0xffff); Imm16(value >> 16); }
+        void Imm64(uint64_t value) { Imm32(static_cast<uint32_t>(value)); Imm32(static_cast<uint32_t>(value >> 32)); }
+
+        // op reg, [rbx + disp] ; reg est un registre ou l'extension /n de l'opcode.
+        void Field(std::initializer_list<uint8_t> opcode, uint8_t reg, int32_t disp, Prefix prefix = kNone)
+        {
+            Rex(prefix, reg, 0, kRbx);
+            Bytes(opcode);
+            Byte(0x80 | ((reg & 7) << 3) | kRbx);
+            Imm32(static_cast<uint32_t>(disp));
+        }
+
+        // op reg, [rbx + index + disp]
+        void Table(std::initializer_list<uint8_t> opcode, uint8_t reg, uint8_t index, int32_t disp, Prefix prefix = kNone)
+        {
+            Rex(prefix, reg, index, kRbx);
+            Bytes(opcode);
+            Byte(0x84 | ((reg & 7) << 3));
+            Byte(((index & 7) << 3) | kRbx);
+            Imm32(static_cast<uint32_t>(disp));
+        }
+
+        // op reg, [base + index] ; base n'est ni rbp ni r13.
+        void Indexed(std::initializer_list<uint8_t> opcode, uint8_t reg, uint8_t base, uint8_t index, Prefix prefix = kNone)
+        {
+            Rex(prefix, reg, index, base);
+            Bytes(opcode);
+            Byte(0x04 | ((reg & 7) << 3));
+            Byte(((index & 7) << 3) | (base & 7));
+        }
+
+        // op rm, reg entre registres.
+        void Direct(std::initializer_list<uint8_t> opcode, uint8_t reg, uint8_t rm, Prefix prefix = kNone)
+        {
+            Rex(prefix, reg, 0, rm);
+            Bytes(opcode);
+            Byte(0xc0 | ((reg & 7) << 3) | (rm & 7));
+        }
+
+        // op rm, imm32 (ou imm16 avec kWord) ; extension : 0 add, 1 or, 4 and, 5 sub, 6 xor, 7 cmp.
+        void Immediate(uint8_t extension, uint8_t rm, uint32_t value, Prefix prefix = kNone)
+        {
+            Direct({ 0x81 }, extension, rm, prefix);
+            if (prefix == kWord) Imm16(value); else Imm32(value);
+        }
+
+        // Décalage ou rotation de rm : 0 rol, 1 ror, 4 shl, 5 shr.
+        void Shift(uint8_t extension, uint8_t rm, uint8_t count, Prefix prefix = kNone)
+        {
+            Direct({ 0xc1 }, extension, rm, prefix);
+            Byte(count);
+        }
+
+        void Move(uint8_t destination, uint8_t source, Prefix prefix = kNone) { Direct({ 0x89 }, source, destination, prefix); }
+        void MoveImm64(uint8_t reg, uint64_t value)
+        {
+            Rex(kWide, 0, 0, reg);
+            Byte(0xb8 | (reg & 7));
+            Imm64(value);
+        }
+
+        void Push(uint8_t reg) { if (reg & 8) Byte(0x41); Byte(0x50 | (reg & 7)); }
+        void Pop(uint8_t reg) { if (reg & 8) Byte(0x41); Byte(0x58 | (reg & 7)); }
+
+        // Sauts vers l'avant : renvoient la position du déplacement, fixée par Bind.
+        size_t Jump(Condition condition)
+        {
+            Bytes({ 0x0f, static_cast<uint8_t>(0x80 | condition) });
+            Imm32(0);
+            return m_size - 4;
+        }
+        size_t Jump()
+        {
+            Byte(0xe9);
+            Imm32(0);
+            return m_size - 4;
+        }
+        void Bind(size_t label)
+        {
+            if (label + 4 <= m_size)
+            {
+                uint32_t offset = static_cast<uint32_t>(m_size - (label + 4));
+                for (int i = 0; i < 4; i++)
+                {
+                    m_code[label + i] = static_cast<uint8_t>(offset >> (8 * i));
+                }
+            }
+        }
+        void JumpTo(size_t target)
+        {
+            Byte(0xe9);
+            Imm32(static_cast<uint32_t>(target - (m_size + 4)));
+        }
+        size_t Here() const { return m_size; }
+
+    private:
+        void Rex(Prefix prefix, uint8_t reg, uint8_t index, uint8_t base)
+        {
+            if (prefix == kWord)
+            {
+                Byte(0x66);
+            }
+            uint8_t rex = (prefix == kWide ? 8 : 0) | ((reg & 8) >> 1) | ((index & 8) >> 2) | ((base & 8) >> 3);
+            if (rex || (prefix == kByteReg && ((reg >= 4 && reg < 8) || (base >= 4 && base < 8))))
+            {
+                Byte(0x40 | rex);
+            }
+        }
+
+        uint8_t* m_code;
+        size_t m_capacity;
+        size_t m_size = 0;
+        bool m_overflowed = false;
+    };
+
+    constexpr int32_t Core(size_t offset) { return static_cast<int32_t>(offset); }
+    constexpr int32_t kA = Core(offsetof(CpuCore, m_a)), kX = Core(offsetof(CpuCore, m_x)), kY = Core(offsetof(CpuCore, m_y));
+    constexpr int32_t kSp = Core(offsetof(CpuCore, m_sp)), kPc = Core(offsetof(CpuCore, m_pc)), kDp = Core(offsetof(CpuCore, m_dp));
+    constexpr int32_t kK = Core(offsetof(CpuCore, m_k)), kDb = Core(offsetof(CpuCore, m_db)), kP = Core(offsetof(CpuCore, m_p));
+    constexpr int32_t kZResult = Core(offsetof(CpuCore, m_zResult)), kNResult = Core(offsetof(CpuCore, m_nResult));
+    constexpr int32_t kIrqWanted = Core(offsetof(CpuCore, m_irqWanted)), kNmiWanted = Core(offsetof(CpuCore, m_nmiWanted));
+    constexpr int32_t kIntWanted = Core(offsetof(CpuCore, m_intWanted)), kCycles = Core(offsetof(CpuCore, m_cycles));
+
+    constexpr uint8_t kFlagC = 0x01, kFlagI = 0x04, kFlagD = 0x08, kFlagV = 0x40;
+
+    /**
+     * @class Translator
+     * @brief Traduction d'un bloc, instruction par instruction (voir CpuJit).
+     *
+     * Registres : rbx = CpuCore, r12 = cycle de fin du budget, r13 = m_cycles (rangé avant chaque
+     * appel au coeur et à la sortie), r14 = adresse de l'accès en cours, r15 = donnée. Les lectures
+     * d'opcode et les accès directs sont comptés à la compilation et ajoutés aux compteurs à la
+     * sortie du bloc ; les fonctions du coeur comptent leurs propres accès.
+     */
+    class Translator
+    {
+    public:
+        Translator(Assembler& assembler, const CpuJitLayout& layout, const CpuJitBlock& block)
+            : m_as(assembler), m_layout(layout), m_block(block)
+        {
+            m_e = block.mode == CpuDecoder::kModeEmulation;
+            m_m = CpuDecoder::IsAccumulator8(block.mode);
+            m_x = CpuDecoder::IsIndex8(block.mode);
+        }
+
+        void Translate()
+        {
+            for (uint8_t reg : { kRbx, kR12, kR13, kR14, kR15 })
+            {
+                m_as.Push(reg);
+            }
+#if defined(_WIN32)
+            m_as.Bytes({ 0x48, 0x83, 0xec, 0x20 });     // sub rsp, 32 (zone des arguments)
+#endif
+            m_as.Move(kRbx, kArg0, kWide);
+            m_as.Move(kR12, kArg1, kWide);
+            m_as.Field({ 0x8b }, kR13, kCycles, kWide);
+            size_t loop = m_as.Here();
+            m_pc = static_cast<uint16_t>(m_block.address);
+            for (size_t i = 0; i < m_block.instructions.size(); i++)
+            {
+                Instruction(m_block.instructions[i]);
+                if (i + 1 < m_block.instructions.size())
+                {
+                    size_t leave = LeaveTest();
+                    m_as.Direct({ 0x39 }, kR12, kR13, kWide);      // cmp r13, r12
+                    size_t next = m_as.Jump(kBelow);
+                    if (leave != kNoLabel) m_as.Bind(leave);
+                    Exit();
+                    m_as.Bind(next);
+                }
+            }
+
+            // Fin du bloc : rebouclage si le bloc a sauté sur lui-même, comme LookupBlock l'aurait accordé.
+            std::vector<size_t> exits;
+            if (size_t leave = LeaveTest(); leave != kNoLabel) exits.push_back(leave);
+            m_as.Direct({ 0x39 }, kR12, kR13, kWide);
+            exits.push_back(m_as.Jump(kAboveEqual));
+            CompareByte(kK, static_cast<uint8_t>(m_block.address >> 16));
+            exits.push_back(m_as.Jump(kNotEqual));
+            m_as.Field({ 0x81 }, 7, kPc, kWord);                    // cmp word [pc], début
+            m_as.Imm16(m_block.address & 0xffff);
+            exits.push_back(m_as.Jump(kNotEqual));
+            CompareByte(kIntWanted, 0);
+            exits.push_back(m_as.Jump(kNotEqual));
+            m_as.Field({ 0x8b }, kRax, m_layout.blockStamp, kWide);
+            m_as.MoveImm64(kRcx, m_block.stamp);
+            m_as.Direct({ 0x39 }, kRcx, kRax, kWide);
+            exits.push_back(m_as.Jump(kNotEqual));
+            m_as.Bytes({ 0x49, 0x8d, 0x85 });                       // lea rax, [r13 + marge]
+            m_as.Imm32(static_cast<uint32_t>(m_block.eventMargin));
+            m_as.Field({ 0x3b }, kRax, m_layout.nextEvent, kWide);
+            exits.push_back(m_as.Jump(kAboveEqual));
+            AddCounts(m_pending, 0);
+            m_as.JumpTo(loop);
+            for (size_t exit : exits)
+            {
+                m_as.Bind(exit);
+            }
+            Exit();
+        }
+
+    private:
+        // Compteurs cumulés par le code natif (CpuPerfCounters).
+        struct Counts
+        {
+            uint32_t instructions = 0, opcodeFetches = 0, fastReads = 0, fastWrites = 0;
+            Counts& operator+=(const Counts& other)
+            {
+                instructions += other.instructions;
+                opcodeFetches += other.opcodeFetches;
+                fastReads += other.fastReads;
+                fastWrites += other.fastWrites;
+                return *this;
+            }
+        };
+
+        // Une instruction : dispatch (PC, cycles et compteurs des lectures d'opcode) puis son corps.
+        void Instruction(const CpuJitInstruction& instruction)
+        {
+            const CpuOpcodeInfo& info = CpuDecoder::kOpcodes[instruction.opcode];
+            std::string_view name(info.mnemonic);
+            uint16_t next = static_cast<uint16_t>(m_pc + instruction.length);
+            m_calls = false;
+            m_current = { 1, instruction.fetches, instruction.fetches, 0 };
+            if (!IsNative(instruction.opcode, name, info.addressing))
+            {
+                Step(instruction);
+                m_current = {};
+            }
+            else
+            {
+                size_t decimal = kNoLabel;
+                if (name == "ADC" || name == "SBC")
+                {
+                    // Mode décimal : l'instruction entière passe par l'interpréteur.
+                    TestByte(kP, kFlagD);
+                    decimal = m_as.Jump(kNotEqual);
+                }
+                StoreWord(kPc, next);
+                AddCycles(instruction.fetchCycles);
+                if (info.addressing == CpuAddressing::Rel)
+                {
+                    Branch(instruction.opcode, static_cast<uint16_t>(next + static_cast<int8_t>(instruction.operands[0])));
+                }
+                else if (info.addressing == CpuAddressing::Imp || info.addressing == CpuAddressing::Acc)
+                {
+                    Implied(name);
+                }
+                else
+                {
+                    Memory(instruction, name, info.addressing);
+                }
+                if (decimal != kNoLabel)
+                {
+                    size_t done = m_as.Jump();
+                    m_as.Bind(decimal);
+                    Step(instruction);
+                    AddCounts(m_current, 5);
+                    m_as.Bind(done);
+                }
+            }
+            m_pending += m_current;
+            m_pc = next;
+        }
+
+        static bool IsNative(uint8_t opcode, std::string_view name, CpuAddressing addressing)
+        {
+            using enum CpuAddressing;
+            switch (addressing)
+            {
+                case Rel:
+                    return opcode != 0x82 && opcode != 0x62;
+                case Imp:
+                case Acc:
+                    for (std::string_view implied : { "CLC", "SEC", "CLD", "SED", "CLV", "SEI", "CLI", "INX", "INY", "DEX", "DEY",
+                        "INC", "DEC", "TAX", "TAY", "TXA", "TYA", "TXY", "TYX", "TSX", "TXS", "TCS", "TSC", "TCD", "TDC", "XBA",
+                        "NOP", "ASL", "LSR", "ROL", "ROR" })
+                    {
+                        if (name == implied) return true;
+                    }
+                    return false;
+                case ImmM: case ImmX: case Dp: case Dpx: case Dpy: case Abs: case Abx: case Aby: case Abl: case Alx:
+                    for (std::string_view memory : { "LDA", "LDX", "LDY", "STA", "STX", "STY", "STZ", "ADC", "SBC", "CMP", "CPX",
+                        "CPY", "AND", "ORA", "EOR", "INC", "DEC" })
+                    {
+                        if (name == memory) return true;
+                    }
+                    return false;
+                default:
+                    return false;
+            }
+        }
+
+        // --- Appels au coeur ---
+
+        void SaveCycles() { m_as.Field({ 0x89 }, kR13, kCycles, kWide); }
+        void LoadCycles() { m_as.Field({ 0x8b }, kR13, kCycles, kWide); }
+
+        // Arguments autres que le CpuCore déjà placés ; m_cycles est à jour pendant l'appel.
+        template<typename Function>
+        void CallCore(Function function)
+        {
+            SaveCycles();
+            m_as.Move(kArg0, kRbx, kWide);
+            m_as.MoveImm64(kRax, reinterpret_cast<uintptr_t>(function));
+            m_as.Bytes({ 0xff, 0xd0 });                             // call rax
+            LoadCycles();
+        }
+
+        void Step(const CpuJitInstruction& instruction)
+        {
+            m_as.MoveImm64(kArg1, reinterpret_cast<uintptr_t>(instruction.op));
+            CallCore(m_layout.step);
+            m_calls = true;
+        }
+
+        void Idle()
+        {
+            CallCore(m_layout.idle);
+            m_calls = true;
+        }
+
+        // PollEvents
+        void Poll()
+        {
+            m_as.Field({ 0x3b }, kR13, m_layout.nextEvent, kWide);  // cmp r13, [m_nextEvent]
+            size_t skip = m_as.Jump(kBelow);
+            CallCore(m_layout.fireEvents);
+            m_as.Bind(skip);
+        }
+
+        // Saut vers la sortie si un appel a pu demander de quitter la boucle.
+        size_t LeaveTest()
+        {
+            if (!m_calls)
+            {
+                return kNoLabel;
+            }
+            CompareByte(m_layout.leaveLoop, 0);
+            return m_as.Jump(kNotEqual);
+        }
+
+        void Exit()
+        {
+            AddCounts(m_pending, 0);
+            SaveCycles();
+#if defined(_WIN32)
+            m_as.Bytes({ 0x48, 0x83, 0xc4, 0x20 });     // add rsp, 32
+#endif
+            for (uint8_t reg : { kR15, kR14, kR13, kR12, kRbx })
+            {
+                m_as.Pop(reg);
+            }
+            m_as.Byte(0xc3);
+        }
+
+        // Ajoute (extension 0) ou retranche (5) counts des compteurs de performance.
+        void AddCounts(const Counts& counts, uint8_t extension)
+        {
+            if (m_layout.perf < 0)
+            {
+                return;
+            }
+            auto add = [&](size_t field, uint32_t count) {
+                if (count)
+                {
+                    m_as.Field({ 0x81 }, extension, m_layout.perf + static_cast<int32_t>(field), kWide);
+                    m_as.Imm32(count);
+                }
+            };
+            add(offsetof(CpuPerfCounters, instructions), counts.instructions);
+            add(offsetof(CpuPerfCounters, opcodeFetches), counts.opcodeFetches);
+            add(offsetof(CpuPerfCounters, fastReads), counts.fastReads);
+            add(offsetof(CpuPerfCounters, fastWrites), counts.fastWrites);
+        }
+
+        void AddCounter(size_t field, uint8_t extension)
+        {
+            if (m_layout.perf >= 0)
+            {
+                m_as.Field({ 0x81 }, extension, m_layout.perf + static_cast<int32_t>(field), kWide);
+                m_as.Imm32(1);
+            }
+        }
+
+        // --- Champs du coeur ---
+
+        void LoadByte(uint8_t reg, int32_t field) { m_as.Field({ 0x0f, 0xb6 }, reg, field); }
+        void LoadWord(uint8_t reg, int32_t field) { m_as.Field({ 0x0f, 0xb7 }, reg, field); }
+        void Load(uint8_t reg, int32_t field, bool isByte) { if (isByte) LoadByte(reg, field); else LoadWord(reg, field); }
+        void StoreByte(int32_t field, uint8_t reg) { m_as.Field({ 0x88 }, reg, field, kByteReg); }
+        void StoreWord(int32_t field, uint8_t reg) { m_as.Field({ 0x89 }, reg, field, kWord); }
+        void StoreWord(int32_t field, uint16_t value)
+        {
+            m_as.Field({ 0xc7 }, 0, field, kWord);
+            m_as.Imm16(value);
+        }
+        void TestByte(int32_t field, uint8_t mask) { m_as.Field({ 0xf6 }, 0, field); m_as.Byte(mask); }
+        void CompareByte(int32_t field, uint8_t value) { m_as.Field({ 0x80 }, 7, field); m_as.Byte(value); }
+        void AndByte(int32_t field, uint8_t mask) { m_as.Field({ 0x80 }, 4, field); m_as.Byte(mask); }
+        void OrByte(int32_t field, uint8_t mask) { m_as.Field({ 0x80 }, 1, field); m_as.Byte(mask); }
+        void AddCycles(uint32_t cycles) { if (cycles) m_as.Immediate(0, kR13, cycles, kWide); }
+
+        // SetZnFlags(reg, isByte)
+        void SetZn(uint8_t reg, bool isByte)
+        {
+            if (isByte)
+            {
+                m_as.Direct({ 0x0f, 0xb6 }, reg, reg, kByteReg);     // movzx reg, reg8
+                m_as.Shift(4, reg, 8);
+            }
+            StoreWord(kZResult, reg);
+            StoreWord(kNResult, reg);
+        }
+
+        // C = reg8 (0 ou 1)
+        void SetCarry(uint8_t reg)
+        {
+            AndByte(kP, static_cast<uint8_t>(~kFlagC));
+            m_as.Field({ 0x08 }, reg, kP, kByteReg);                // or [p], reg8
+        }
+
+        // --- Accès mémoire : adresse dans r14d ---
+
+        // m_cycles += GetAccessCycles(r14d)
+        void AccessCycles()
+        {
+            m_as.Move(kRcx, kR14);
+            m_as.Shift(5, kRcx, 8);
+            m_as.Table({ 0x0f, 0xb6 }, kRcx, kRcx, m_layout.speedMap);
+            m_as.Immediate(4, kRcx, static_cast<uint8_t>(~CpuSpeedMap::kRomBit));
+            m_as.Direct({ 0x01 }, kRcx, kR13, kWide);               // add r13, rcx
+        }
+
+        // rax = pointeur read (0) ou write (8) de la page de r14d, ecx = décalage dans la page
+        void PageLookup(int32_t pointer)
+        {
+            m_as.Move(kRcx, kR14);
+            m_as.Shift(5, kRcx, CpuPageTable::kPageShift);
+            m_as.Shift(4, kRcx, 4);
+            m_as.Table({ 0x8b }, kRax, kRcx, m_layout.pageTable + pointer, kWide);
+            m_as.Move(kRcx, kR14);
+            m_as.Immediate(4, kRcx, CpuPageTable::kPageSize - 1);
+            m_as.Direct({ 0x85 }, kRax, kRax, kWide);               // test rax, rax
+        }
+
+        // Read : eax = octet en r14d
+        void Read()
+        {
+            AccessCycles();
+            PageLookup(0);
+            size_t slow = m_as.Jump(kEqual);
+            m_as.Indexed({ 0x0f, 0xb6 }, kRax, kRax, kRcx);          // movzx eax, byte [rax + rcx]
+            size_t done = m_as.Jump();
+            m_as.Bind(slow);
+            AddCounter(offsetof(CpuPerfCounters, fastReads), 5);
+            m_as.Move(kArg1, kR14);
+            CallCore(m_layout.readSlow);
+            m_as.Bind(done);
+            m_current.fastReads++;
+            m_calls = true;
+        }
+
+        // Write : octet r15b en r14d
+        void Write()
+        {
+            AccessCycles();
+            PageLookup(8);
+            size_t slow = m_as.Jump(kEqual);
+            m_as.Indexed({ 0x88 }, kR15, kRax, kRcx, kByteReg);     // mov [rax + rcx], r15b
+            size_t done = m_as.Jump();
+            m_as.Bind(slow);
+            AddCounter(offsetof(CpuPerfCounters, fastWrites), 5);
+            m_as.Move(kArg1, kR14);
+            m_as.Move(kArg2, kR15);
+            CallCore(m_layout.writeSlow);
+            m_as.Bind(done);
+            m_current.fastWrites++;
+            m_calls = true;
+        }
+
+        // Octet suivant (+1) ou précédent (-1) d'un mot : l'adresse reste dans sa banque pour les modes directs.
+        void StepAddress(bool forward, uint32_t mask)
+        {
+            m_as.Immediate(forward ? 0 : 5, kR14, 1);
+            m_as.Immediate(4, kR14, mask);
+        }
+
+        // Immédiat relu dans la mémoire de l'hôte : eax = octet
+        void ReadImmediate(const CpuJitInstruction& instruction, int byte)
+        {
+            AddCycles(instruction.immediateCycles[byte]);
+            m_as.MoveImm64(kRax, reinterpret_cast<uintptr_t>(instruction.immediate[byte]));
+            m_as.Bytes({ 0x0f, 0xb6, 0x00 });                       // movzx eax, byte [rax]
+            m_current.fastReads++;
+        }
+
+        // Adresse effective dans r14d ; renvoie le masque de l'adresse de l'octet fort.
+        uint32_t Address(const CpuJitInstruction& instruction, CpuAddressing addressing, bool write)
+        {
+            using enum CpuAddressing;
+            uint32_t operand = instruction.operands[0] | (instruction.operands[1] << 8);
+            switch (addressing)
+            {
+                case Dp: case Dpx: case Dpy:
+                {
+                    TestByte(kDp, 0xff);
+                    size_t skip = m_as.Jump(kEqual);
+                    Idle();
+                    m_as.Bind(skip);
+                    if (addressing != Dp) Idle();
+                    LoadWord(kR14, kDp);
+                    m_as.Immediate(0, kR14, instruction.operands[0]);
+                    if (addressing != Dp)
+                    {
+                        LoadWord(kRax, addressing == Dpx ? kX : kY);
+                        m_as.Direct({ 0x01 }, kRax, kR14);
+                    }
+                    m_as.Immediate(4, kR14, 0xffff);
+                    return 0xffff;
+                }
+                case Abs: case Abx: case Aby:
+                {
+                    int32_t index = addressing == Abx ? kX : kY;
+                    if (addressing != Abs && (write || !m_x))
+                    {
+                        Idle();
+                    }
+                    else if (addressing != Abs)
+                    {
+                        // Cycle de plus si l'indexation change de page.
+                        LoadWord(kRax, index);
+                        m_as.Immediate(0, kRax, operand);
+                        m_as.Shift(5, kRax, 8);
+                        m_as.Immediate(7, kRax, operand >> 8);
+                        size_t skip = m_as.Jump(kEqual);
+                        Idle();
+                        m_as.Bind(skip);
+                    }
+                    LoadByte(kR14, kDb);
+                    m_as.Shift(4, kR14, 16);
+                    m_as.Immediate(0, kR14, operand);
+                    if (addressing != Abs)
+                    {
+                        LoadWord(kRax, index);
+                        m_as.Direct({ 0x01 }, kRax, kR14);
+                        m_as.Immediate(4, kR14, 0xffffff);
+                    }
+                    return 0xffffff;
+                }
+                default:    // Abl et Alx : adresse posée par Memory
+                    return 0xffffff;
+            }
+        }
+
+        // Valeur lue par l'instruction dans eax : immédiat, ou ReadWord(low, high, true).
+        void Operand(const CpuJitInstruction& instruction, bool immediate, bool isByte, uint32_t mask)
+        {
+            if (isByte)
+            {
+                Poll();
+                if (immediate) ReadImmediate(instruction, 0); else Read();
+                return;
+            }
+            if (immediate) ReadImmediate(instruction, 0); else Read();
+            m_as.Move(kR15, kRax);
+            Poll();
+            if (immediate)
+            {
+                ReadImmediate(instruction, 1);
+            }
+            else
+            {
+                StepAddress(true, mask);
+                Read();
+            }
+            m_as.Shift(4, kRax, 8);
+            m_as.Direct({ 0x09 }, kR15, kRax);                      // or eax, r15d
+        }
+
+        void Memory(const CpuJitInstruction& instruction, std::string_view name, CpuAddressing addressing)
+        {
+            bool immediate = addressing == CpuAddressing::ImmM || addressing == CpuAddressing::ImmX;
+            bool index = name == "LDX" || name == "LDY" || name == "STX" || name == "STY" || name == "CPX" || name == "CPY";
+            bool isByte = index ? m_x : m_m;
+            uint32_t mask = 0xffffff;
+            if (addressing == CpuAddressing::Abl || addressing == CpuAddressing::Alx)
+            {
+                uint32_t address = instruction.operands[0] | (instruction.operands[1] << 8) | (instruction.operands[2] << 16);
+                m_as.Bytes({ 0x41, 0xbe });                         // mov r14d, imm32
+                m_as.Imm32(address);
+                if (addressing == CpuAddressing::Alx)
+                {
+                    LoadWord(kRax, kX);
+                    m_as.Direct({ 0x01 }, kRax, kR14);
+                    m_as.Immediate(4, kR14, 0xffffff);
+                }
+            }
+            else if (!immediate)
+            {
+                mask = Address(instruction, addressing, name == "STA" || name == "STZ" || name == "INC" || name == "DEC");
+            }
+
+            if (name == "STA" || name == "STX" || name == "STY" || name == "STZ")
+            {
+                if (name == "STZ")
+                {
+                    m_as.Direct({ 0x31 }, kR15, kR15);              // xor r15d, r15d
+                }
+                else
+                {
+                    Load(kR15, name == "STA" ? kA : (name == "STX" ? kX : kY), isByte);
+                }
+                if (isByte)
+                {
+                    Poll();
+                    Write();
+                    return;
+                }
+                Write();
+                Poll();
+                StepAddress(true, mask);
+                m_as.Shift(1, kR15, 8, kWord);                      // ror r15w, 8
+                Write();
+                return;
+            }
+
+            if (name == "INC" || name == "DEC")
+            {
+                uint8_t extension = name == "INC" ? 0 : 5;
+                Read();
+                if (!isByte)
+                {
+                    m_as.Move(kR15, kRax);
+                    StepAddress(true, mask);
+                    Read();
+                    m_as.Shift(4, kRax, 8);
+                    m_as.Direct({ 0x09 }, kR15, kRax);
+                }
+                m_as.Immediate(extension, kRax, 1);
+                m_as.Immediate(4, kRax, isByte ? 0xff : 0xffff);
+                m_as.Move(kR15, kRax);
+                Idle();
+                if (isByte)
+                {
+                    Poll();
+                    Write();
+                }
+                else
+                {
+                    // WriteWord inversé : octet fort d'abord.
+                    m_as.Shift(1, kR15, 8, kWord);
+                    Write();
+                    m_as.Shift(1, kR15, 8, kWord);
+                    StepAddress(false, mask);
+                    Poll();
+                    Write();
+                }
+                m_as.Move(kRax, kR15);
+                SetZn(kRax, isByte);
+                return;
+            }
+
+            Operand(instruction, immediate, isByte, mask);
+            if (name == "LDA")
+            {
+                if (isByte) StoreByte(kA, kRax); else StoreWord(kA, kRax);
+                SetZn(kRax, isByte);
+            }
+            else if (name == "LDX" || name == "LDY")
+            {
+                StoreWord(name == "LDX" ? kX : kY, kRax);
+                SetZn(kRax, isByte);
+            }
+            else if (name == "CMP" || name == "CPX" || name == "CPY")
+            {
+                Load(kRcx, name == "CMP" ? kA : (name == "CPX" ? kX : kY), isByte);
+                m_as.Direct({ 0x29 }, kRax, kRcx);                  // sub ecx, eax
+                m_as.Immediate(7, kRcx, isByte ? 0x100 : 0x10000);
+                m_as.Direct({ 0x0f, 0x92 }, 0, kRdx, kByteReg);     // setb dl
+                SetCarry(kRdx);
+                SetZn(kRcx, isByte);
+            }
+            else if (name == "AND" || name == "ORA" || name == "EOR")
+            {
+                uint8_t opcode = name == "AND" ? 0x20 : (name == "ORA" ? 0x08 : 0x30);
+                if (isByte)
+                {
+                    m_as.Field({ opcode }, kRax, kA, kByteReg);
+                }
+                else
+                {
+                    m_as.Field({ static_cast<uint8_t>(opcode + 1) }, kRax, kA, kWord);
+                }
+                Load(kRax, kA, isByte);
+                SetZn(kRax, isByte);
+            }
+            else
+            {
+                Arithmetic(name == "ADC", isByte);
+            }
+        }
+
+        // ADC/SBC binaires, valeur dans eax.
+        void Arithmetic(bool add, bool isByte)
+        {
+            uint32_t sign = isByte ? 0x80 : 0x8000;
+            uint8_t shift = isByte ? 8 : 16;
+            Load(kRcx, kA, isByte);
+            LoadByte(kRdx, kP);
+            m_as.Immediate(4, kRdx, kFlagC);
+            m_as.Direct({ 0x01 }, kRcx, kRdx);                      // edx = C + a
+            m_as.Move(kR8, kRcx);
+            m_as.Direct({ 0x31 }, kRax, kR8);                       // r8d = a ^ v
+            if (add)
+            {
+                m_as.Direct({ 0x01 }, kRax, kRdx);
+                m_as.Direct({ 0xf7 }, 2, kR8);                      // not r8d
+            }
+            else
+            {
+                m_as.Direct({ 0x29 }, kRax, kRdx);
+                m_as.Immediate(5, kRdx, 1);
+            }
+            m_as.Move(kR9, kRcx);
+            m_as.Direct({ 0x31 }, kRdx, kR9);                       // r9d = a ^ résultat
+            m_as.Direct({ 0x21 }, kR9, kR8);
+            m_as.Immediate(4, kR8, sign);
+            m_as.Shift(5, kR8, isByte ? 1 : 9);                     // r8d = V
+            m_as.Move(kR9, kRdx);
+            m_as.Shift(5, kR9, shift);
+            m_as.Immediate(4, kR9, 1);
+            if (!add)
+            {
+                m_as.Immediate(6, kR9, 1);                          // retenue = pas d'emprunt
+            }
+            m_as.Direct({ 0x09 }, kR9, kR8);
+            AndByte(kP, static_cast<uint8_t>(~(kFlagC | kFlagV)));
+            m_as.Field({ 0x08 }, kR8, kP, kByteReg);
+            if (isByte) StoreByte(kA, kRdx); else StoreWord(kA, kRdx);
+            m_as.Move(kRax, kRdx);
+            if (!isByte)
+            {
+                m_as.Direct({ 0x0f, 0xb7 }, kRax, kRax);            // movzx eax, ax
+            }
+            SetZn(kRax, isByte);
+        }
+
+        void Implied(std::string_view name)
+        {
+            CallCore(m_layout.implied);
+            m_calls = true;
+            if (name == "CLC") AndByte(kP, static_cast<uint8_t>(~kFlagC));
+            else if (name == "SEC") OrByte(kP, kFlagC);
+            else if (name == "CLD") AndByte(kP, static_cast<uint8_t>(~kFlagD));
+            else if (name == "SED") OrByte(kP, kFlagD);
+            else if (name == "CLV") AndByte(kP, static_cast<uint8_t>(~kFlagV));
+            else if (name == "SEI" || name == "CLI")
+            {
+                // UpdateIntWanted
+                LoadByte(kRax, kNmiWanted);
+                if (name == "SEI")
+                {
+                    OrByte(kP, kFlagI);
+                }
+                else
+                {
+                    AndByte(kP, static_cast<uint8_t>(~kFlagI));
+                    m_as.Field({ 0x0a }, kRax, kIrqWanted);         // or al, [m_irqWanted]
+                }
+                StoreByte(kIntWanted, kRax);
+            }
+            else if (name == "INX" || name == "INY" || name == "DEX" || name == "DEY")
+            {
+                int32_t field = (name == "INX" || name == "DEX") ? kX : kY;
+                LoadWord(kRax, field);
+                m_as.Immediate(name[0] == 'I' ? 0 : 5, kRax, 1);
+                m_as.Immediate(4, kRax, m_x ? 0xff : 0xffff);
+                StoreWord(field, kRax);
+                SetZn(kRax, m_x);
+            }
+            else if (name == "INC" || name == "DEC")
+            {
+                Load(kRax, kA, m_m);
+                m_as.Immediate(name == "INC" ? 0 : 5, kRax, 1);
+                if (m_m) StoreByte(kA, kRax); else StoreWord(kA, kRax);
+                SetZn(kRax, m_m);
+            }
+            else if (name == "TAX" || name == "TAY" || name == "TXY" || name == "TYX" || name == "TSX")
+            {
+                int32_t source = name[1] == 'A' ? kA : (name[1] == 'X' ? kX : (name[1] == 'Y' ? kY : kSp));
+                Load(kRax, source, m_x);
+                StoreWord(name[2] == 'X' ? kX : kY, kRax);
+                SetZn(kRax, m_x);
+            }
+            else if (name == "TXA" || name == "TYA")
+            {
+                Load(kRax, name == "TXA" ? kX : kY, m_m);
+                if (m_m) StoreByte(kA, kRax); else StoreWord(kA, kRax);
+                SetZn(kRax, m_m);
+            }
+            else if (name == "TSC" || name == "TDC" || name == "TCD")
+            {
+                LoadWord(kRax, name == "TSC" ? kSp : (name == "TDC" ? kDp : kA));
+                StoreWord(name == "TCD" ? kDp : kA, kRax);
+                SetZn(kRax, false);
+            }
+            else if (name == "TXS")
+            {
+                Load(kRax, kX, m_e);
+                if (m_e) StoreByte(kSp, kRax); else StoreWord(kSp, kRax);
+            }
+            else if (name == "TCS")
+            {
+                Load(kRax, kA, m_e);
+                if (m_e) m_as.Immediate(1, kRax, 0x100);
+                StoreWord(kSp, kRax);
+            }
+            else if (name == "XBA")
+            {
+                LoadWord(kRax, kA);
+                m_as.Shift(0, kRax, 8, kWord);                      // rol ax, 8
+                StoreWord(kA, kRax);
+                SetZn(kRax, true);
+            }
+            else if (name == "ASL" || name == "LSR" || name == "ROL" || name == "ROR")
+            {
+                Shift(name);
+            }
+        }
+
+        // Décalages et rotations de A ; C sortant dans cl.
+        void Shift(std::string_view name)
+        {
+            uint8_t top = m_m ? 7 : 15;
+            Load(kRax, kA, m_m);
+            m_as.Move(kRcx, kRax);
+            if (name == "ASL" || name == "ROL")
+            {
+                m_as.Shift(5, kRcx, top);
+                m_as.Direct({ 0x01 }, kRax, kRax);                  // add eax, eax
+                if (name == "ROL")
+                {
+                    LoadByte(kRdx, kP);
+                    m_as.Immediate(4, kRdx, kFlagC);
+                    m_as.Direct({ 0x09 }, kRdx, kRax);
+                }
+            }
+            else
+            {
+                m_as.Immediate(4, kRcx, 1);
+                m_as.Shift(5, kRax, 1);
+                if (name == "ROR")
+                {
+                    LoadByte(kRdx, kP);
+                    m_as.Immediate(4, kRdx, kFlagC);
+                    m_as.Shift(4, kRdx, top);
+                    m_as.Direct({ 0x09 }, kRdx, kRax);
+                }
+            }
+            if (m_m)
+            {
+                StoreByte(kA, kRax);
+            }
+            else
+            {
+                StoreWord(kA, kRax);
+                m_as.Direct({ 0x0f, 0xb7 }, kRax, kRax);
+            }
+            SetCarry(kRcx);
+            SetZn(kRax, m_m);
+        }
+
+        // DoBranch
+        void Branch(uint8_t opcode, uint16_t target)
+        {
+            size_t taken = kNoLabel;
+            switch (opcode)
+            {
+                case 0x10: TestByte(kNResult + 1, 0x80); taken = m_as.Jump(kEqual); break;         // BPL
+                case 0x30: TestByte(kNResult + 1, 0x80); taken = m_as.Jump(kNotEqual); break;      // BMI
+                case 0x50: TestByte(kP, kFlagV); taken = m_as.Jump(kEqual); break;                 // BVC
+                case 0x70: TestByte(kP, kFlagV); taken = m_as.Jump(kNotEqual); break;              // BVS
+                case 0x90: TestByte(kP, kFlagC); taken = m_as.Jump(kEqual); break;                 // BCC
+                case 0xb0: TestByte(kP, kFlagC); taken = m_as.Jump(kNotEqual); break;             // BCS
+                case 0xd0: m_as.Field({ 0x83 }, 7, kZResult, kWord); m_as.Byte(0); taken = m_as.Jump(kNotEqual); break;  // BNE
+                case 0xf0: m_as.Field({ 0x83 }, 7, kZResult, kWord); m_as.Byte(0); taken = m_as.Jump(kEqual); break;     // BEQ
+                default: break;                                                                     // BRA
+            }
+            size_t done = kNoLabel;
+            if (taken != kNoLabel)
+            {
+                Poll();
+                done = m_as.Jump();
+                m_as.Bind(taken);
+            }
+            Poll();
+            Idle();
+            StoreWord(kPc, target);
+            if (done != kNoLabel)
+            {
+                m_as.Bind(done);
+            }
+        }
+
+        Assembler& m_as;
+        const CpuJitLayout& m_layout;
+        const CpuJitBlock& m_block;
+        bool m_e = false, m_m = false, m_x = false;
+        uint16_t m_pc = 0;
+        bool m_calls = false;           // l'instruction en cours appelle le coeur
+        Counts m_current, m_pending;    // instruction en cours, bloc depuis son entrée
+    };
+}
+#endif
+
+CpuJit::Entry CpuJit::Compile(const CpuJitLayout& layout, const CpuJitBlock& block)
+{
+#if CPU_JIT_X64
+    if (m_full || (!m_code && !Allocate()) || !Protect(false))
+    {
+        return nullptr;
+    }
+    Assembler assembler(m_code + m_used, kCodeSize - m_used);
+    Translator(assembler, layout, block).Translate();
+    if (assembler.IsOverflowed())
+    {
+        m_full = true;
+        return nullptr;
+    }
+    uint8_t* start = m_code + m_used;
+    m_used = (m_used + assembler.GetSize() + 15) & ~static_cast<size_t>(15);
+    if (!Protect(true))
+    {
+        return nullptr;
+    }
+    m_compiled++;
+    return reinterpret_cast<Entry>(start);
+#else
+    static_cast<void>(layout);
+    static_cast<void>(block);
+    return nullptr;
+#endif
+}
+
+bool CpuJit::Allocate()
+{
+#if defined(_WIN32)
+    m_code = static_cast<uint8_t*>(VirtualAlloc(nullptr, kCodeSize, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE));
+#else
+    void* code = mmap(nullptr, kCodeSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    m_code = code == MAP_FAILED ? nullptr : static_cast<uint8_t*>(code);
+#endif
+    m_executable = false;
+    return m_code != nullptr;
+}
+
+bool CpuJit::Protect(bool executable)
+{
+    if (m_executable == executable)
+    {
+        return true;
+    }
+#if defined(_WIN32)
+    DWORD previous;
+    if (!VirtualProtect(m_code, kCodeSize, executable ? PAGE_EXECUTE_READ : PAGE_READWRITE, &previous))
+    {
+        return false;
+    }
+    if (executable)
+    {
+        FlushInstructionCache(GetCurrentProcess(), m_code, kCodeSize);
+    }
+#else
+    if (mprotect(m_code, kCodeSize, executable ? (PROT_READ | PROT_EXEC) : (PROT_READ | PROT_WRITE)) != 0)
+    {
+        return false;
+    }
+#endif
+    m_executable = executable;
+    return true;
+}
+
+void CpuJit::Release()
+{
+#if defined(_WIN32)
+    if (m_code) VirtualFree(m_code, 0, MEM_RELEASE);
+#else
+    if (m_code) munmap(m_code, kCodeSize);
+#endif
+    m_code = nullptr;
+}
+#endif
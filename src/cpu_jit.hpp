@@ -0,0 +1,154 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// Recompilateur des blocs chauds : compilé seulement si CPU_ENABLE_JIT vaut 1.
+#ifndef CPU_ENABLE_JIT
+#define CPU_ENABLE_JIT 0
+#endif
+
+// Générateur natif disponible : x86-64 uniquement. Sur aarch64 (et ailleurs), Compile renvoie
+// nullptr et le moteur Jit se comporte comme Block.
+#if defined(__x86_64__) || defined(_M_X64)
+#define CPU_JIT_X64 1
+#else
+#define CPU_JIT_X64 0
+#endif
+
+/**
+ * @struct CpuJitLayout
+ * @brief Liens du code natif avec le coeur qui l'a compilé.
+ *
+ * Le code natif reçoit le CpuCore du coeur : les registres sont lus et écrits en place, les autres
+ * membres utilisés sont repérés par leur déplacement depuis ce CpuCore. Les fonctions sont celles
+ * de l'interpréteur, appelées avec le CpuCore en premier argument.
+ */
+struct CpuJitLayout
+{
+    int32_t nextEvent;              // CpuHotState::m_nextEvent
+    int32_t leaveLoop;              // bool de sortie de la boucle d'exécution
+    int32_t blockStamp;             // uint64_t, change quand les blocs compilés ne sont plus valides
+    int32_t pageTable;              // CpuPage[CpuPageTable::kPageCount] (voir CpuPageTable::GetPages)
+    int32_t speedMap;               // octets de CpuSpeedMap::GetPages
+    int32_t perf;                   // CpuPerfCounters, négatif sans compteurs
+
+    uint32_t (*readSlow)(void* core, uint32_t address);                 // page sans accès direct
+    void (*writeSlow)(void* core, uint32_t address, uint32_t value);
+    void (*idle)(void* core);
+    void (*implied)(void* core);                                        // AdrImp
+    void (*fireEvents)(void* core);
+    void (*step)(void* core, const void* op);                           // instruction entière par l'interpréteur
+};
+
+/**
+ * @struct CpuJitInstruction
+ * @brief Instruction pré-décodée d'un bloc à traduire.
+ *
+ * fetches et fetchCycles couvrent l'opcode et les opérandes lus au dispatch ; les octets d'un
+ * immédiat (AdrImm) sont relus à l'exécution depuis la mémoire de l'hôte, comme le fait Read.
+ */
+struct CpuJitInstruction
+{
+    const void* op;                     // argument de CpuJitLayout::step
+    const uint8_t* immediate[2];
+    uint8_t opcode;
+    uint8_t operands[3];
+    uint8_t length;
+    uint8_t fetches;
+    uint8_t fetchCycles;
+    uint8_t immediateCycles[2];
+};
+
+/**
+ * @struct CpuJitBlock
+ * @brief Bloc de base à traduire : adresse, mode (CpuDecoder::GetMode) et instructions.
+ */
+struct CpuJitBlock
+{
+    uint32_t address;
+    uint8_t mode;
+    uint64_t stamp;                     // valeur de CpuJitLayout::blockStamp à la compilation
+    uint64_t eventMargin;               // cycles à laisser avant le prochain événement pour reboucler
+    std::span<const CpuJitInstruction> instructions;
+};
+
+/**
+ * @class CpuJit
+ * @brief Recompilateur des blocs de base chauds du moteur Block en code x86-64.
+ *
+ * Chaque instruction est traduite séparément, avec ses cycles, ses échantillonnages des événements
+ * et ses compteurs aux mêmes points que l'interpréteur : transferts, drapeaux, incréments,
+ * décalages de A, chargements, rangements, ADC/SBC binaires, comparaisons, AND/ORA/EOR et INC/DEC
+ * en mémoire (immédiat, direct, absolu et long, indexés ou non), branches. Les autres instructions,
+ * et ADC/SBC quand D est mis, sont exécutées par l'interpréteur (CpuJitLayout::step). Les accès aux
+ * pages directes sont faits en place ; une page sans accès direct (MMIO, surveillance, code décodé)
+ * passe par ReadSlow/WriteSlow de l'interpréteur.
+ *
+ * Le code natif rend la main après l'instruction qui atteint le budget ou qui force la sortie de
+ * la boucle (handler, code modifié, interruption levée). Un bloc qui se termine par un saut sur
+ * lui-même reboucle sans repasser par la boucle tant que le prochain événement est assez loin,
+ * qu'aucune interruption n'est demandée et que les blocs compilés restent valides.
+ *
+ * Le code est écrit dans une zone allouée au premier Compile (cpu_jit.cpp, à lier avec
+ * CPU_ENABLE_JIT), en écriture pendant la génération puis en lecture/exécution. Reset rend toute
+ * la zone : les points d'entrée déjà rendus deviennent invalides.
+ */
+class CpuJit
+{
+public:
+    using Entry = void (*)(void* core, uint64_t targetCycle);
+
+    // Entrées d'un bloc avant sa compilation, par défaut (voir SetHotThreshold).
+    static constexpr uint32_t kHotThreshold = 16;
+    static constexpr size_t kCodeSize = 4u << 20;
+
+    CpuJit() = default;
+    CpuJit(const CpuJit&) = delete;
+    CpuJit& operator=(const CpuJit&) = delete;
+    ~CpuJit()
+    {
+#if CPU_ENABLE_JIT
+        Release();
+#endif
+    }
+
+    static constexpr bool IsSupported() { return CPU_ENABLE_JIT && CPU_JIT_X64; }
+
+    /**
+     * @brief Traduit block en code natif.
+     * @return nullptr si la plateforme n'a pas de générateur ou si la zone de code est pleine (IsFull).
+     */
+    Entry Compile(const CpuJitLayout& layout, const CpuJitBlock& block);
+
+    void Reset()
+    {
+        m_used = 0;
+        m_full = false;
+    }
+
+    /**
+     * @brief Compile les blocs à leur hits-ième entrée (1 : dès la première) ; à régler avant
+     * l'exécution, un bloc déjà entré plus de hits fois n'est plus compilé.
+     */
+    void SetHotThreshold(uint32_t hits) { m_hotThreshold = hits ? hits : 1; }
+    uint32_t GetHotThreshold() const { return m_hotThreshold; }
+
+    bool IsFull() const { return m_full; }
+    size_t GetCompiledCount() const { return m_compiled; }
+    size_t GetCodeUsed() const { return m_used; }
+
+private:
+    // Zone de code du système : seules les cibles compilées avec CPU_ENABLE_JIT en ont besoin.
+    bool Allocate();
+    bool Protect(bool executable);
+    void Release();
+
+    uint8_t* m_code = nullptr;
+    size_t m_used = 0;
+    size_t m_compiled = 0;
+    uint32_t m_hotThreshold = kHotThreshold;
+    bool m_executable = false;
+    bool m_full = false;
+};
@@ -0,0 +1,386 @@
+﻿#pragma once
+
+#include "basic_cpu.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/**
+ * @class CpuLanes
+ * @brief Expérimental : Lanes instances du même programme (une par vecteur d'entrée) dont les
+ * registres sont rangés en structure de tableaux.
+ *
+ * À chaque pas, le couloir le plus en retard est choisi. Si son instruction est un opcode
+ * implicite ou immédiat sans accès au bus (transferts, INX/DEX, LDA #, ADC # binaire, CMP #...),
+ * tous les couloirs au même K:PC, dans le même mode, sans interruption en attente ni événement
+ * programmé (ScheduleIrq/ScheduleNmi) échu avant la fin de l'instruction l'exécutent ensemble :
+ * une boucle sans branchement par registre, que le compilateur vectorise (AVX2, NEON).
+ * Sinon le couloir exécute seul son instruction sur son BasicCpu scalaire (RunOpcode), puis
+ * rejoint les autres dès qu'il retrouve leur PC. Les cycles, les appels Idle du bus et l'état
+ * final de chaque couloir sont ceux du coeur scalaire exécuté avec RunUntil.
+ *
+ * Les points d'arrêt, le profileur et la trace ne voient que les instructions scalaires ; les
+ * compteurs de performance (CpuPerfCounters) de chaque couloir comptent les deux chemins.
+ * Hors de RunUntil, GetLane donne accès à l'état complet de chaque couloir.
+ */
+template<CpuBus Bus, size_t Lanes = 8>
+class CpuLanes
+{
+public:
+    explicit CpuLanes(const std::array<Bus, Lanes>& buses)
+    {
+        for (size_t i = 0; i < Lanes; i++)
+        {
+            m_cores[i] = std::make_unique<BasicCpu<Bus>>(buses[i]);
+        }
+    }
+
+    static constexpr size_t GetLaneCount() { return Lanes; }
+    BasicCpu<Bus>& GetLane(size_t lane) { return *m_cores[lane]; }
+    const BasicCpu<Bus>& GetLane(size_t lane) const { return *m_cores[lane]; }
+
+    /**
+     * @brief Exécute chaque couloir jusqu'à targetCycle, comme BasicCpu::RunUntil.
+     */
+    void RunUntil(uint64_t targetCycle)
+    {
+        for (;;)
+        {
+            size_t lead = Lanes;
+            for (size_t i = 0; i < Lanes; i++)
+            {
+                if (Cycles(i) < targetCycle && (lead == Lanes || Cycles(i) < Cycles(lead)))
+                {
+                    lead = i;
+                }
+            }
+            if (lead == Lanes)
+            {
+                break;
+            }
+            if (!RunVector(lead, targetCycle))
+            {
+                Scatter(lead);
+                m_cores[lead]->RunOpcode();
+                m_scalarInstructions++;
+            }
+        }
+        for (size_t i = 0; i < Lanes; i++)
+        {
+            Scatter(i);
+        }
+    }
+
+    // Instructions exécutées (cumul sur les couloirs) par le chemin vectoriel et par le chemin scalaire.
+    uint64_t GetVectorInstructions() const { return m_vectorInstructions; }
+    uint64_t GetScalarInstructions() const { return m_scalarInstructions; }
+
+private:
+    static constexpr uint8_t kFlagC = 0x01, kFlagI = 0x04, kFlagD = 0x08, kFlagV = 0x40;
+
+    // Forme d'un opcode exécutable en parallèle : implicite, ou immédiat dont la largeur suit M ou X.
+    enum class Form : uint8_t { None, Implied, ImmM, ImmX };
+
+    static constexpr Form GetForm(uint8_t opcode)
+    {
+        switch (opcode)
+        {
+            case 0x18: case 0x38: case 0x58: case 0x78: case 0xb8: case 0xd8: case 0xf8:
+            case 0xe8: case 0xc8: case 0xca: case 0x88: case 0x1a: case 0x3a:
+            case 0xaa: case 0xa8: case 0x8a: case 0x98: case 0x9b: case 0xbb:
+            case 0x0a: case 0x4a: case 0xea:
+                return Form::Implied;
+            case 0xa9: case 0x29: case 0x09: case 0x49: case 0x69: case 0xc9:
+                return Form::ImmM;
+            case 0xa2: case 0xa0: case 0xe0: case 0xc0:
+                return Form::ImmX;
+            default:
+                return Form::None;
+        }
+    }
+
+    uint64_t Cycles(size_t lane) const { return m_inCore[lane] ? m_cores[lane]->GetCycles() : m_cycles[lane]; }
+
+    /**
+     * @brief Octet de code du couloir dans une page directe, sans accès au bus ; -1 sinon.
+     */
+    int CodeByte(size_t lane, uint8_t k, uint16_t pc) const
+    {
+        uint32_t address = (static_cast<uint32_t>(k) << 16) | pc;
+        const uint8_t* page = m_cores[lane]->GetPageTable().Lookup(address).read;
+        return page ? page[address & (CpuPageTable::kPageSize - 1)] : -1;
+    }
+
+    void Gather(size_t lane)
+    {
+        if (!m_inCore[lane])
+        {
+            return;
+        }
+        const CpuCore& core = m_cores[lane]->GetCore();
+        m_a[lane] = core.m_a; m_x[lane] = core.m_x; m_y[lane] = core.m_y;
+        m_pc[lane] = core.m_pc; m_p[lane] = core.m_p;
+        m_zResult[lane] = core.m_zResult; m_nResult[lane] = core.m_nResult;
+        m_cycles[lane] = core.m_cycles;
+        m_inCore[lane] = false;
+    }
+
+    void Scatter(size_t lane)
+    {
+        if (m_inCore[lane])
+        {
+            return;
+        }
+        CpuCore core = m_cores[lane]->GetCore();
+        core.m_a = m_a[lane]; core.m_x = m_x[lane]; core.m_y = m_y[lane];
+        core.m_pc = m_pc[lane]; core.m_p = m_p[lane];
+        core.m_zResult = m_zResult[lane]; core.m_nResult = m_nResult[lane];
+        core.m_cycles = m_cycles[lane];
+        m_cores[lane]->SetCore(core);
+        m_inCore[lane] = true;
+    }
+
+    /**
+     * @brief Exécute l'instruction du couloir lead sur tous les couloirs qui peuvent la suivre.
+     * @return Faux si l'instruction doit passer par le coeur scalaire.
+     */
+    bool RunVector(size_t lead, uint64_t targetCycle)
+    {
+        // Seuls K, P, le mode et les lignes d'interruption décident de l'admission ; les autres
+        // registres sont lus dans CpuCore ou dans les tableaux selon le couloir.
+        const CpuCore& leader = m_cores[lead]->GetCore();
+        uint16_t pc = m_inCore[lead] ? leader.m_pc : m_pc[lead];
+        int opcode = CodeByte(lead, leader.m_k, pc);
+        Form form = opcode < 0 ? Form::None : GetForm(static_cast<uint8_t>(opcode));
+        if (form == Form::None)
+        {
+            return false;
+        }
+        uint8_t mode = leader.m_mode;
+        bool wide = form == Form::ImmM ? !CpuDecoder::IsAccumulator8(mode) : (form == Form::ImmX && !CpuDecoder::IsIndex8(mode));
+        uint16_t length = form == Form::Implied ? 1 : (wide ? 3 : 2);
+
+        size_t count = 0;
+        for (size_t i = 0; i < Lanes; i++)
+        {
+            const CpuCore& core = m_cores[i]->GetCore();
+            uint8_t p = m_inCore[i] ? core.m_p : m_p[i];
+            bool ready = Cycles(i) < targetCycle && core.m_k == leader.m_k && core.m_mode == mode
+                && (m_inCore[i] ? core.m_pc : m_pc[i]) == pc
+                && !core.m_waiting && !core.m_stopped && !core.m_resetWanted
+                && !core.m_nmiWanted && !(core.m_irqWanted && !(p & kFlagI))
+                && !(opcode == 0x69 && (p & kFlagD)) && CodeByte(i, core.m_k, pc) == opcode;
+            for (uint16_t byte = 1; ready && byte < length; byte++)
+            {
+                int value = CodeByte(i, core.m_k, static_cast<uint16_t>(pc + byte));
+                ready = value >= 0;
+                m_operand[i] = byte == 1 ? static_cast<uint16_t>(value) : static_cast<uint16_t>(m_operand[i] | (value << 8));
+            }
+            if (ready)
+            {
+                // Opcode et opérande lus par le coeur dans ses pages, plus le cycle interne d'un implicite.
+                uint32_t cycles = 0;
+                for (uint16_t byte = 0; byte < length; byte++)
+                {
+                    cycles += m_cores[i]->GetSpeedMap().GetAccessCycles((static_cast<uint32_t>(core.m_k) << 16) | static_cast<uint16_t>(pc + byte));
+                }
+                m_fetchCycles[i] = cycles + (form == Form::Implied ? CpuSpeedMap::kFastCycles : 0);
+                // Un événement échu pendant l'instruction serait appliqué par un échantillonnage du coeur scalaire.
+                ready = m_cores[i]->GetNextEventCycle() > Cycles(i) + m_fetchCycles[i];
+            }
+            m_group[i] = ready;
+            if (ready)
+            {
+                Gather(i);
+                count++;
+            }
+        }
+        if (count == 0)
+        {
+            return false;
+        }
+        Execute(static_cast<uint8_t>(opcode), CpuDecoder::IsAccumulator8(mode), CpuDecoder::IsIndex8(mode));
+        for (size_t i = 0; i < Lanes; i++)
+        {
+            m_pc[i] = m_group[i] ? static_cast<uint16_t>(m_pc[i] + length) : m_pc[i];
+            m_cycles[i] += m_group[i] ? m_fetchCycles[i] : 0;
+        }
+        if (form == Form::Implied)
+        {
+            for (size_t i = 0; i < Lanes; i++)
+            {
+                if (m_group[i])
+                {
+                    m_cores[i]->GetBus().Idle(false);
+                }
+            }
+        }
+#if CPU_ENABLE_PERF_COUNTERS
+        for (size_t i = 0; i < Lanes; i++)
+        {
+            if (m_group[i])
+            {
+                CpuPerfCounters counters;
+                counters.instructions = 1;
+                counters.cycles = m_fetchCycles[i];
+                counters.opcodeFetches = counters.fastReads = length;
+                counters.idleCycles = form == Form::Implied ? CpuSpeedMap::kFastCycles : 0;
+                m_cores[i]->AddPerfCounters(counters);
+            }
+        }
+#endif
+        m_vectorInstructions += count;
+        return true;
+    }
+
+    /**
+     * @brief Corps des opcodes parallèles, identiques à basic_cpu_opcodes.inl ; chaque boucle
+     * calcule tous les couloirs et ne conserve le résultat que pour ceux du groupe.
+     */
+    void Execute(uint8_t opcode, bool m8, bool x8)
+    {
+        switch (opcode)
+        {
+            case 0x18: SetFlag(kFlagC, false); break;
+            case 0x38: SetFlag(kFlagC, true); break;
+            case 0x58: SetFlag(kFlagI, false); break;
+            case 0x78: SetFlag(kFlagI, true); break;
+            case 0xb8: SetFlag(kFlagV, false); break;
+            case 0xd8: SetFlag(kFlagD, false); break;
+            case 0xf8: SetFlag(kFlagD, true); break;
+            case 0xe8: Index(m_x, x8, [](uint16_t x, uint16_t, uint16_t) { return static_cast<uint16_t>(x + 1); }); break;
+            case 0xca: Index(m_x, x8, [](uint16_t x, uint16_t, uint16_t) { return static_cast<uint16_t>(x - 1); }); break;
+            case 0xc8: Index(m_y, x8, [](uint16_t y, uint16_t, uint16_t) { return static_cast<uint16_t>(y + 1); }); break;
+            case 0x88: Index(m_y, x8, [](uint16_t y, uint16_t, uint16_t) { return static_cast<uint16_t>(y - 1); }); break;
+            case 0xaa: Index(m_x, x8, [](uint16_t, uint16_t a, uint16_t) { return a; }); break;
+            case 0xa8: Index(m_y, x8, [](uint16_t, uint16_t a, uint16_t) { return a; }); break;
+            case 0x9b: Index(m_y, x8, [this](uint16_t, uint16_t, uint16_t i) { return m_x[i]; }); break;
+            case 0xbb: Index(m_x, x8, [this](uint16_t, uint16_t, uint16_t i) { return m_y[i]; }); break;
+            case 0xa2: Index(m_x, x8, [this](uint16_t, uint16_t, uint16_t i) { return m_operand[i]; }); break;
+            case 0xa0: Index(m_y, x8, [this](uint16_t, uint16_t, uint16_t i) { return m_operand[i]; }); break;
+            case 0x1a: Accumulator(m8, [](uint16_t a, uint16_t) { return static_cast<uint16_t>(a + 1); }); break;
+            case 0x3a: Accumulator(m8, [](uint16_t a, uint16_t) { return static_cast<uint16_t>(a - 1); }); break;
+            case 0x8a: Accumulator(m8, [this](uint16_t, uint16_t i) { return m_x[i]; }); break;
+            case 0x98: Accumulator(m8, [this](uint16_t, uint16_t i) { return m_y[i]; }); break;
+            case 0xa9: Accumulator(m8, [this](uint16_t, uint16_t i) { return m_operand[i]; }); break;
+            case 0x29: Accumulator(m8, [this](uint16_t a, uint16_t i) { return static_cast<uint16_t>(a & m_operand[i]); }); break;
+            case 0x09: Accumulator(m8, [this](uint16_t a, uint16_t i) { return static_cast<uint16_t>(a | m_operand[i]); }); break;
+            case 0x49: Accumulator(m8, [this](uint16_t a, uint16_t i) { return static_cast<uint16_t>(a ^ m_operand[i]); }); break;
+            case 0x0a: Shift(m8, true); break;
+            case 0x4a: Shift(m8, false); break;
+            case 0x69: AddBinary(m8); break;
+            case 0xc9: Compare(m_a, m8); break;
+            case 0xe0: Compare(m_x, x8); break;
+            case 0xc0: Compare(m_y, x8); break;
+            default: break;     // NOP
+        }
+    }
+
+    void SetFlag(uint8_t flag, bool value)
+    {
+        for (size_t i = 0; i < Lanes; i++)
+        {
+            uint8_t p = value ? (m_p[i] | flag) : (m_p[i] & ~flag);
+            m_p[i] = m_group[i] ? p : m_p[i];
+        }
+    }
+
+    void SetZn(size_t i, uint16_t value, bool isByte)
+    {
+        uint16_t result = isByte ? static_cast<uint16_t>(value << 8) : value;
+        m_zResult[i] = m_group[i] ? result : m_zResult[i];
+        m_nResult[i] = m_group[i] ? result : m_nResult[i];
+    }
+
+    // Registre d'index : résultat tronqué à 8 bits si X, N et Z selon la même largeur.
+    template<typename Op>
+    void Index(std::array<uint16_t, Lanes>& reg, bool x8, Op op)
+    {
+        for (size_t i = 0; i < Lanes; i++)
+        {
+            uint16_t value = op(reg[i], m_a[i], static_cast<uint16_t>(i));
+            value = x8 ? (value & 0xff) : value;
+            reg[i] = m_group[i] ? value : reg[i];
+            SetZn(i, reg[i], x8);
+        }
+    }
+
+    // Accumulateur : B est conservé si M.
+    template<typename Op>
+    void Accumulator(bool m8, Op op)
+    {
+        for (size_t i = 0; i < Lanes; i++)
+        {
+            uint16_t value = op(m_a[i], static_cast<uint16_t>(i));
+            value = m8 ? static_cast<uint16_t>((m_a[i] & 0xff00) | (value & 0xff)) : value;
+            m_a[i] = m_group[i] ? value : m_a[i];
+            SetZn(i, m_a[i], m8);
+        }
+    }
+
+    void Shift(bool m8, bool left)
+    {
+        for (size_t i = 0; i < Lanes; i++)
+        {
+            uint16_t a = m_a[i];
+            bool carry = left ? (a & (m8 ? 0x80 : 0x8000)) != 0 : (a & 1) != 0;
+            uint16_t value = left ? static_cast<uint16_t>(a << 1) : static_cast<uint16_t>((m8 ? (a & 0xff) : a) >> 1);
+            value = m8 ? static_cast<uint16_t>((a & 0xff00) | (value & 0xff)) : value;
+            m_p[i] = m_group[i] ? static_cast<uint8_t>((m_p[i] & ~kFlagC) | (carry ? kFlagC : 0)) : m_p[i];
+            m_a[i] = m_group[i] ? value : a;
+            SetZn(i, m_a[i], m8);
+        }
+    }
+
+    void AddBinary(bool m8)
+    {
+        for (size_t i = 0; i < Lanes; i++)
+        {
+            uint32_t a = m8 ? (m_a[i] & 0xff) : m_a[i];
+            uint32_t value = m8 ? (m_operand[i] & 0xff) : m_operand[i];
+            uint32_t result = a + value + (m_p[i] & kFlagC);
+            uint32_t sign = m8 ? 0x80 : 0x8000;
+            bool overflow = !((a ^ value) & sign) && ((a ^ result) & sign);
+            bool carry = result > (m8 ? 0xffu : 0xffffu);
+            uint8_t p = static_cast<uint8_t>((m_p[i] & ~(kFlagC | kFlagV)) | (carry ? kFlagC : 0) | (overflow ? kFlagV : 0));
+            uint16_t sum = m8 ? static_cast<uint16_t>((m_a[i] & 0xff00) | (result & 0xff)) : static_cast<uint16_t>(result);
+            m_p[i] = m_group[i] ? p : m_p[i];
+            m_a[i] = m_group[i] ? sum : m_a[i];
+            SetZn(i, m_a[i], m8);
+        }
+    }
+
+    void Compare(const std::array<uint16_t, Lanes>& reg, bool is8)
+    {
+        for (size_t i = 0; i < Lanes; i++)
+        {
+            uint32_t value = is8 ? (m_operand[i] & 0xff) : m_operand[i];
+            uint32_t result = (is8 ? (reg[i] & 0xff) : reg[i]) - value;
+            bool carry = result < (is8 ? 0x100u : 0x10000u);
+            m_p[i] = m_group[i] ? static_cast<uint8_t>((m_p[i] & ~kFlagC) | (carry ? kFlagC : 0)) : m_p[i];
+            SetZn(i, static_cast<uint16_t>(result), is8);
+        }
+    }
+
+    std::array<std::unique_ptr<BasicCpu<Bus>>, Lanes> m_cores;
+
+    // Registres des couloirs dont m_inCore est faux ; les autres vivent dans leur BasicCpu.
+    // K, DB, D, S, le mode et les lignes d'interruption restent toujours dans le coeur scalaire.
+    alignas(32) std::array<uint16_t, Lanes> m_a{}, m_x{}, m_y{}, m_pc{}, m_zResult{}, m_nResult{}, m_operand{};
+    alignas(32) std::array<uint64_t, Lanes> m_cycles{};
+    alignas(32) std::array<uint32_t, Lanes> m_fetchCycles{};
+    alignas(32) std::array<uint8_t, Lanes> m_p{};
+    std::array<bool, Lanes> m_group{};
+    std::array<bool, Lanes> m_inCore = MakeInCore();
+
+    uint64_t m_vectorInstructions = 0, m_scalarInstructions = 0;
+
+    static constexpr std::array<bool, Lanes> MakeInCore()
+    {
+        std::array<bool, Lanes> inCore{};
+        inCore.fill(true);
+        return inCore;
+    }
+};
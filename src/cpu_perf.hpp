@@ -0,0 +1,29 @@
+﻿#pragma once
+
+#include <cstdint>
+
+// Compteurs de performance : actifs par défaut (quelques additions par accès), CPU_ENABLE_PERF_COUNTERS=0 les retire.
+#ifndef CPU_ENABLE_PERF_COUNTERS
+#define CPU_ENABLE_PERF_COUNTERS 1
+#endif
+
+/**
+ * @struct CpuPerfCounters
+ * @brief Télémétrie du coeur depuis le dernier ResetPerfCounters (voir BasicCpu::GetPerfCounters).
+ *
+ * Chaque lecture est comptée dans fastReads (pages directes, fenêtre des opcodes, MVN enchaîné)
+ * ou dans handlerReads (appel au bus, ou journal en rejeu) ; opcodeFetches est la part du flux
+ * d'instructions (opcodes et opérandes). Les écritures suivent la même répartition. Les durées
+ * sont en cycles maîtres.
+ */
+struct CpuPerfCounters
+{
+    uint64_t instructions = 0;      // instructions exécutées, chaque itération de MVN/MVP comprise
+    uint64_t cycles = 0;
+    uint64_t opcodeFetches = 0;
+    uint64_t fastReads = 0, handlerReads = 0;
+    uint64_t fastWrites = 0, handlerWrites = 0;
+    uint64_t idleCycles = 0;        // cycles internes des instructions
+    uint64_t waitCycles = 0;        // attente WAI/STP
+    uint64_t interrupts = 0;        // IRQ et NMI prises
+};
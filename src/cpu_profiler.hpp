@@ -0,0 +1,155 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+// Profileur d'instructions : compilé seulement si CPU_ENABLE_PROFILER vaut 1.
+#ifndef CPU_ENABLE_PROFILER
+#define CPU_ENABLE_PROFILER 0
+#endif
+
+/**
+ * @class CpuProfiler
+ * @brief Histogrammes d'exécutions et de cycles maîtres par adresse 24 bits et par opcode.
+ *
+ * Les compteurs par adresse sont des paires Counter adjacentes (une seule ligne de cache par
+ * instruction), regroupées par banque de 64 K adresses : une banque (1 Mo) est allouée à sa première
+ * instruction exécutée puis conservée, seules les banques qui contiennent du code coûtent de la mémoire.
+ * Les compteurs de 64 bits ne débordent pas en pratique.
+ */
+class CpuProfiler
+{
+public:
+    static constexpr uint32_t kAddressCount = 0x1000000;
+    static constexpr uint32_t kBankSize = 0x10000;
+
+    struct Counter
+    {
+        uint64_t executions;
+        uint64_t cycles;
+    };
+
+    void Enable(bool enabled) { m_enabled = enabled; }
+    bool IsEnabled() const { return m_enabled; }
+
+    /**
+     * @brief Remet tous les compteurs à zéro (l'allocation est conservée).
+     */
+    void Reset()
+    {
+        for (const std::unique_ptr<Counter[]>& bank : m_banks)
+        {
+            if (bank)
+            {
+                std::fill_n(bank.get(), kBankSize, Counter{});
+            }
+        }
+        std::fill(std::begin(m_opcodes), std::end(m_opcodes), Counter{});
+    }
+
+    void Record(uint32_t address, uint8_t opcode, uint32_t cycles)
+    {
+        Counter* bank = m_banks[address >> 16].get();
+        if (!bank) [[unlikely]]
+        {
+            bank = AllocateBank(address >> 16);
+        }
+        Counter& counter = bank[address & 0xffff];
+        counter.executions++;
+        counter.cycles += cycles;
+        m_opcodes[opcode].executions++;
+        m_opcodes[opcode].cycles += cycles;
+    }
+
+    Counter GetOpcode(uint8_t opcode) const { return m_opcodes[opcode]; }
+    Counter GetAddress(uint32_t address) const
+    {
+        address &= kAddressCount - 1;
+        const std::unique_ptr<Counter[]>& bank = m_banks[address >> 16];
+        return bank ? bank[address & 0xffff] : Counter{};
+    }
+
+    /**
+     * @brief Écrit les opcodes exécutés et les topCount adresses les plus coûteuses, triés par cycles.
+     */
+    void WriteReport(std::ostream& out, size_t topCount = 32) const
+    {
+        char line[96];
+        uint64_t totalCycles = 0;
+        std::vector<uint8_t> opcodes;
+        for (int opcode = 0; opcode < 256; opcode++)
+        {
+            totalCycles += m_opcodes[opcode].cycles;
+            if (m_opcodes[opcode].executions)
+            {
+                opcodes.push_back(static_cast<uint8_t>(opcode));
+            }
+        }
+        std::sort(opcodes.begin(), opcodes.end(), [&](uint8_t a, uint8_t b) { return m_opcodes[a].cycles > m_opcodes[b].cycles; });
+
+        out << "opcode  executions        cycles      %\n";
+        for (uint8_t opcode : opcodes)
+        {
+            const Counter& counter = m_opcodes[opcode];
+            std::snprintf(line, sizeof(line), "  $%02X %12llu %14llu %6.2f\n", opcode,
+                static_cast<unsigned long long>(counter.executions), static_cast<unsigned long long>(counter.cycles),
+                100.0 * counter.cycles / totalCycles);
+            out << line;
+        }
+
+        std::vector<uint32_t> addresses;
+        for (uint32_t address = 0; address < kAddressCount; address += kBankSize)
+        {
+            if (!m_banks[address >> 16])
+            {
+                continue;
+            }
+            for (uint32_t offset = 0; offset < kBankSize; offset++)
+            {
+                if (m_banks[address >> 16][offset].executions)
+                {
+                    addresses.push_back(address | offset);
+                }
+            }
+        }
+        if (addresses.empty())
+        {
+            return;
+        }
+        auto byCycles = [&](uint32_t a, uint32_t b) { return GetAddress(a).cycles > GetAddress(b).cycles; };
+        size_t count = std::min(topCount, addresses.size());
+        std::partial_sort(addresses.begin(), addresses.begin() + count, addresses.end(), byCycles);
+
+        out << "adresse  executions        cycles      %\n";
+        for (size_t i = 0; i < count; i++)
+        {
+            uint32_t address = addresses[i];
+            Counter counter = GetAddress(address);
+            std::snprintf(line, sizeof(line), "%02X:%04X %12llu %14llu %6.2f\n", address >> 16, address & 0xffff,
+                static_cast<unsigned long long>(counter.executions), static_cast<unsigned long long>(counter.cycles),
+                100.0 * counter.cycles / totalCycles);
+            out << line;
+        }
+    }
+
+private:
+    // Hors ligne pour que Record reste court une fois inliné dans la boucle d'exécution.
+#if defined(__GNUC__)
+    [[gnu::noinline, gnu::cold]]
+#elif defined(_MSC_VER)
+    __declspec(noinline)
+#endif
+    Counter* AllocateBank(uint32_t bank)
+    {
+        m_banks[bank] = std::make_unique<Counter[]>(kBankSize);
+        return m_banks[bank].get();
+    }
+
+    bool m_enabled = false;
+    std::unique_ptr<Counter[]> m_banks[kAddressCount / kBankSize];
+    Counter m_opcodes[256] = {};
+};
@@ -0,0 +1,126 @@
+﻿#pragma once
+
+#include "basic_cpu.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/**
+ * @class CpuScheduler
+ * @brief Plusieurs coeurs BasicCpu (CPU principal, SA-1...) avancés à tour de rôle sur un thread.
+ *
+ * Le temps commun est découpé en tranches de GetGranularity() cycles maîtres : chaque coeur
+ * exécute sa tranche par RunUntil, dans l'ordre d'ajout, puis la tranche suivante commence.
+ * Un coeur ne voit donc les écritures des autres qu'avec au plus une tranche de décalage ;
+ * une granularité faible rapproche l'exécution du pas à pas, une granularité forte réduit le
+ * coût de synchronisation. Les coeurs gardent leurs propres bus (registres MMIO propres au
+ * coprocesseur) ; MapSharedPages lie la même mémoire de l'hôte à tous.
+ *
+ * Les écritures d'un coeur dans une page directe partagée n'invalident pas les blocs décodés
+ * des autres : un coeur exécutant du code écrit par un autre doit garder le moteur Threaded ou
+ * Interpreter, ou l'hôte doit appeler InvalidateCode sur ce coeur.
+ */
+template<CpuBus Bus>
+class CpuScheduler
+{
+public:
+    // Une ligne de balayage : bon compromis par défaut entre précision et coût des changements de coeur.
+    static constexpr uint64_t kDefaultGranularity = 1364;
+
+    explicit CpuScheduler(uint64_t granularity = kDefaultGranularity) { SetGranularity(granularity); }
+
+    /**
+     * @brief Ajoute un coeur démarré au temps commun courant.
+     * @return Index du coeur, utilisé par GetCore et GetStoppedCore.
+     */
+    size_t AddCore(Bus bus)
+    {
+        m_cores.push_back(std::make_unique<BasicCpu<Bus>>(std::move(bus)));
+        m_cores.back()->SetCycles(m_cycles);
+        for (const SharedPages& pages : m_shared)
+        {
+            m_cores.back()->MapPages(pages.address, pages.size, pages.read, pages.write);
+        }
+        return m_cores.size() - 1;
+    }
+
+    size_t GetCoreCount() const { return m_cores.size(); }
+    BasicCpu<Bus>& GetCore(size_t index) { return *m_cores[index]; }
+    const BasicCpu<Bus>& GetCore(size_t index) const { return *m_cores[index]; }
+
+    /**
+     * @brief Taille des tranches en cycles maîtres (au moins 1).
+     */
+    void SetGranularity(uint64_t granularity) { m_granularity = std::max<uint64_t>(granularity, 1); }
+    uint64_t GetGranularity() const { return m_granularity; }
+
+    /**
+     * @brief Pages directes communes à tous les coeurs, y compris ceux ajoutés plus tard.
+     */
+    void MapSharedPages(uint32_t address, uint32_t size, const uint8_t* read, uint8_t* write)
+    {
+        m_shared.push_back({ address, size, read, write });
+        for (auto& core : m_cores)
+        {
+            core->MapPages(address, size, read, write);
+        }
+    }
+
+    /**
+     * @brief Avance tous les coeurs jusqu'à targetCycle, tranche par tranche.
+     * @return Faux si un coeur s'est arrêté sur un point d'arrêt ou une surveillance (voir
+     * GetStoppedCore) ; le temps commun reste alors au début de la tranche interrompue.
+     */
+    bool RunUntil(uint64_t targetCycle)
+    {
+        m_stoppedCore = kNoCore;
+        while (m_cycles < targetCycle)
+        {
+            uint64_t sliceEnd = std::min(targetCycle, m_cycles + m_granularity);
+            for (size_t i = 0; i < m_cores.size(); i++)
+            {
+                BasicCpu<Bus>& core = *m_cores[i];
+                if (core.GetCycles() < sliceEnd)
+                {
+                    core.RunUntil(sliceEnd);
+                    if (core.GetStopReason() != CpuStopReason::None)
+                    {
+                        m_stoppedCore = i;
+                        return false;
+                    }
+                }
+            }
+            m_cycles = sliceEnd;
+        }
+        return true;
+    }
+
+    bool RunCycles(uint64_t budget) { return RunUntil(m_cycles + budget); }
+
+    /**
+     * @brief Temps commun : début de la prochaine tranche. Chaque coeur peut l'avoir dépassé de
+     * la fin de sa dernière instruction.
+     */
+    uint64_t GetCycles() const { return m_cycles; }
+
+    static constexpr size_t kNoCore = ~size_t(0);
+    size_t GetStoppedCore() const { return m_stoppedCore; }
+
+private:
+    struct SharedPages
+    {
+        uint32_t address, size;
+        const uint8_t* read;
+        uint8_t* write;
+    };
+
+    std::vector<std::unique_ptr<BasicCpu<Bus>>> m_cores;
+    std::vector<SharedPages> m_shared;
+    uint64_t m_granularity = kDefaultGranularity;
+    uint64_t m_cycles = 0;
+    size_t m_stoppedCore = kNoCore;
+};
@@ -0,0 +1,300 @@
+﻿#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <span>
+#include <type_traits>
+
+// Trace d'exécution : compilée seulement si CPU_ENABLE_TRACE vaut 1.
+#ifndef CPU_ENABLE_TRACE
+#define CPU_ENABLE_TRACE 0
+#endif
+
+/**
+ * @struct CpuTraceRecord
+ * @brief État du coeur au début d'une instruction, après la lecture de son opcode.
+ *
+ * Les octets d'opérande sont relus sans effet de bord dans les pages directes ;
+ * kOperandsValid est absent si le code s'exécute depuis une page gérée par le handler.
+ */
+struct CpuTraceRecord
+{
+    static constexpr uint8_t kEmulation = 0x01, kOperandsValid = 0x02;
+
+    uint64_t cycles;
+    uint16_t pc, a, x, y, sp, dp;
+    uint8_t k, db, p, flags;
+    uint8_t opcode, operands[3];
+};
+static_assert(std::is_trivially_copyable_v<CpuTraceRecord> && sizeof(CpuTraceRecord) == 32);
+
+/**
+ * @class CpuTraceRing
+ * @brief Anneau de taille fixe, un producteur (le coeur) et un consommateur (l'hôte).
+ *
+ * Push n'alloue pas et ne bloque pas : un anneau plein abandonne l'enregistrement et le compte
+ * dans GetDropped. Drain peut être appelé depuis un autre thread pendant l'exécution.
+ */
+class CpuTraceRing
+{
+public:
+    /**
+     * @param capacity Nombre d'enregistrements, arrondi à la puissance de deux supérieure.
+     */
+    explicit CpuTraceRing(size_t capacity)
+    {
+        size_t size = 1;
+        while (size < capacity)
+        {
+            size <<= 1;
+        }
+        m_records = std::make_unique<CpuTraceRecord[]>(size);
+        m_mask = size - 1;
+    }
+
+    bool Push(const CpuTraceRecord& record)
+    {
+        uint64_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_cachedTail > m_mask)
+        {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+            if (head - m_cachedTail > m_mask)
+            {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        }
+        m_records[head & m_mask] = record;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Retire jusqu'à out.size() enregistrements, du plus ancien au plus récent.
+     * @return Nombre d'enregistrements copiés.
+     */
+    size_t Drain(std::span<CpuTraceRecord> out)
+    {
+        uint64_t tail = m_tail.load(std::memory_order_relaxed);
+        uint64_t head = m_head.load(std::memory_order_acquire);
+        size_t count = static_cast<size_t>(head - tail < out.size() ? head - tail : out.size());
+        for (size_t i = 0; i < count; i++)
+        {
+            out[i] = m_records[(tail + i) & m_mask];
+        }
+        m_tail.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+    size_t GetCapacity() const { return m_mask + 1; }
+    uint64_t GetDropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+    std::unique_ptr<CpuTraceRecord[]> m_records;
+    size_t m_mask = 0;
+
+    // Indices séparés sur des lignes de cache distinctes : le producteur et le consommateur
+    // n'écrivent jamais sur la même ligne.
+    alignas(64) std::atomic<uint64_t> m_head = 0;
+    uint64_t m_cachedTail = 0;
+    alignas(64) std::atomic<uint64_t> m_tail = 0;
+    alignas(64) std::atomic<uint64_t> m_dropped = 0;
+};
+
+/**
+ * @class CpuTraceWriter
+ * @brief Écrit des enregistrements sous forme compressée par différence avec le précédent.
+ *
+ * Format : "C8TR", version (1 octet), puis par enregistrement un masque des champs modifiés
+ * (varint), l'écart de cycles (varint) et les champs modifiés en petit-boutiste.
+ */
+class CpuTraceWriter
+{
+public:
+    static constexpr uint8_t kVersion = 1;
+
+    explicit CpuTraceWriter(std::ostream& out)
+        : m_out(out)
+    {
+        m_out.write("C8TR", 4);
+        m_out.put(static_cast<char>(kVersion));
+    }
+
+    void Write(std::span<const CpuTraceRecord> records)
+    {
+        for (const CpuTraceRecord& record : records)
+        {
+            Write(record);
+        }
+    }
+
+    void Write(const CpuTraceRecord& record)
+    {
+        uint8_t buffer[48];
+        size_t size = 0;
+        uint32_t mask = 0;
+        for (int field = 0; field < kFieldCount; field++)
+        {
+            if (Field(record, field) != Field(m_previous, field))
+            {
+                mask |= 1u << field;
+            }
+        }
+        size = PutVarint(buffer, size, mask);
+        size = PutVarint(buffer, size, record.cycles - m_previous.cycles);
+        for (int field = 0; field < kFieldCount; field++)
+        {
+            if (mask & (1u << field))
+            {
+                uint32_t value = Field(record, field);
+                for (int byte = 0; byte < kFieldSizes[field]; byte++)
+                {
+                    buffer[size++] = static_cast<uint8_t>(value >> (8 * byte));
+                }
+            }
+        }
+        m_out.write(reinterpret_cast<const char*>(buffer), size);
+        m_previous = record;
+    }
+
+private:
+    friend class CpuTraceReader;
+
+    // Champs dans l'ordre du masque : pc, a, x, y, sp, dp, k, db, p, flags, opcode + opérandes.
+    static constexpr int kFieldCount = 11;
+    static constexpr int kFieldSizes[kFieldCount] = { 2, 2, 2, 2, 2, 2, 1, 1, 1, 1, 4 };
+
+    static uint32_t Field(const CpuTraceRecord& r, int field)
+    {
+        switch (field)
+        {
+            case 0: return r.pc;
+            case 1: return r.a;
+            case 2: return r.x;
+            case 3: return r.y;
+            case 4: return r.sp;
+            case 5: return r.dp;
+            case 6: return r.k;
+            case 7: return r.db;
+            case 8: return r.p;
+            case 9: return r.flags;
+            default: return r.opcode | (r.operands[0] << 8) | (r.operands[1] << 16) | (static_cast<uint32_t>(r.operands[2]) << 24);
+        }
+    }
+
+    static void SetField(CpuTraceRecord& r, int field, uint32_t value)
+    {
+        switch (field)
+        {
+            case 0: r.pc = static_cast<uint16_t>(value); break;
+            case 1: r.a = static_cast<uint16_t>(value); break;
+            case 2: r.x = static_cast<uint16_t>(value); break;
+            case 3: r.y = static_cast<uint16_t>(value); break;
+            case 4: r.sp = static_cast<uint16_t>(value); break;
+            case 5: r.dp = static_cast<uint16_t>(value); break;
+            case 6: r.k = static_cast<uint8_t>(value); break;
+            case 7: r.db = static_cast<uint8_t>(value); break;
+            case 8: r.p = static_cast<uint8_t>(value); break;
+            case 9: r.flags = static_cast<uint8_t>(value); break;
+            default:
+                r.opcode = static_cast<uint8_t>(value);
+                r.operands[0] = static_cast<uint8_t>(value >> 8);
+                r.operands[1] = static_cast<uint8_t>(value >> 16);
+                r.operands[2] = static_cast<uint8_t>(value >> 24);
+                break;
+        }
+    }
+
+    static size_t PutVarint(uint8_t* buffer, size_t size, uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            buffer[size++] = static_cast<uint8_t>(value) | 0x80;
+            value >>= 7;
+        }
+        buffer[size++] = static_cast<uint8_t>(value);
+        return size;
+    }
+
+    std::ostream& m_out;
+    CpuTraceRecord m_previous = {};
+};
+
+/**
+ * @class CpuTraceReader
+ * @brief Relit un flux produit par CpuTraceWriter.
+ */
+class CpuTraceReader
+{
+public:
+    explicit CpuTraceReader(std::istream& in)
+        : m_in(in)
+    {
+        char header[5] = {};
+        m_in.read(header, 5);
+        m_valid = m_in && header[0] == 'C' && header[1] == '8' && header[2] == 'T' && header[3] == 'R'
+            && static_cast<uint8_t>(header[4]) == CpuTraceWriter::kVersion;
+    }
+
+    bool IsValid() const { return m_valid; }
+
+    /**
+     * @return false en fin de flux ou si le flux est invalide.
+     */
+    bool Read(CpuTraceRecord& record)
+    {
+        uint64_t mask = 0, delta = 0;
+        if (!m_valid || !GetVarint(mask) || !GetVarint(delta))
+        {
+            return false;
+        }
+        m_previous.cycles += delta;
+        for (int field = 0; field < CpuTraceWriter::kFieldCount; field++)
+        {
+            if (mask & (1u << field))
+            {
+                uint32_t value = 0;
+                for (int byte = 0; byte < CpuTraceWriter::kFieldSizes[field]; byte++)
+                {
+                    int c = m_in.get();
+                    if (c == std::istream::traits_type::eof())
+                    {
+                        return false;
+                    }
+                    value |= static_cast<uint32_t>(c) << (8 * byte);
+                }
+                CpuTraceWriter::SetField(m_previous, field, value);
+            }
+        }
+        record = m_previous;
+        return true;
+    }
+
+private:
+    bool GetVarint(uint64_t& value)
+    {
+        value = 0;
+        for (int shift = 0; shift < 64; shift += 7)
+        {
+            int c = m_in.get();
+            if (c == std::istream::traits_type::eof())
+            {
+                return false;
+            }
+            value |= static_cast<uint64_t>(c & 0x7f) << shift;
+            if (!(c & 0x80))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::istream& m_in;
+    CpuTraceRecord m_previous = {};
+    bool m_valid = false;
+};
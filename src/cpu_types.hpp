@@ -0,0 +1,356 @@
+﻿#pragma once
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <type_traits>
+
+struct CpuDebugState
+{
+    uint16_t a, x, y, sp, pc, dp;
+    uint8_t k, db;
+    bool c, z, v, n, i, d, xf, mf, e;
+};
+
+/**
+ * @struct CpuCore
+ * @brief État architectural du coeur, séparé du bus et de la configuration de l'hôte.
+ *
+ * Trivialement copiable : un instantané est une affectation de structure, par exemple dans un
+ * anneau préalloué pour le rollback (voir BasicCpu::GetCore/SetCore). Contrairement à
+ * CpuSaveState, la disposition suit la représentation interne et peut changer d'une version à l'autre.
+ */
+struct CpuCore
+{
+    static constexpr uint64_t kNoWakeCycle = ~0ull;
+
+    // Registres
+    uint16_t m_a = 0, m_x = 0, m_y = 0, m_sp = 0, m_pc = 0, m_dp = 0;
+    uint8_t  m_k = 0, m_db = 0;
+
+    // Drapeaux (Flags) : P compacté pour C, I, D, X, M et V. N et Z sont évalués à la demande
+    // à partir du dernier résultat, normalisé sur 16 bits (un octet est décalé en poids fort) :
+    // Z = (m_zResult == 0), N = bit 15 de m_nResult.
+    uint8_t m_p = 0;
+    uint16_t m_zResult = 1, m_nResult = 0;
+    bool m_e = false;
+
+    // Mode (E, M, X) courant, index de l'exécuteur spécialisé
+    uint8_t m_mode = 0;
+
+    // État
+    bool m_waiting = false, m_stopped = false;
+
+    // Interruptions
+    bool m_irqWanted = false, m_nmiWanted = false, m_intWanted = false, m_resetWanted = true;
+
+    // MEMSEL ($420D) : ROM rapide
+    bool m_memSel = false;
+
+    // Temps (cycles maîtres, non affecté par Reset)
+    uint64_t m_cycles = 0;
+
+    // Prochaine interruption annoncée par l'hôte : borne l'avance rapide de WAI/STP.
+    uint64_t m_wakeCycle = kNoWakeCycle;
+};
+static_assert(std::is_trivially_copyable_v<CpuCore>);
+
+/**
+ * @struct CpuSaveState
+ * @brief Image binaire de taille fixe de l'état du coeur (voir BasicCpu::SaveState).
+ *
+ * Disposition sans bourrage, dans l'ordre des octets de l'hôte ; kVersion change à chaque
+ * modification de la disposition. La configuration de l'hôte (carte des vitesses, pages
+ * directes, moteur) n'en fait pas partie, hormis MEMSEL qui est un registre du programme.
+ */
+struct CpuSaveState
+{
+    static constexpr uint32_t kMagic = 0x36313843;     // "C816"
+    static constexpr uint32_t kVersion = 1;
+    static constexpr uint8_t kWaiting = 0x01, kStopped = 0x02, kIrqWanted = 0x04, kNmiWanted = 0x08;
+    static constexpr uint8_t kIntWanted = 0x10, kResetWanted = 0x20, kEmulation = 0x40, kMemSel = 0x80;
+
+    uint32_t magic, version;
+    uint64_t cycles, wakeCycle;
+    uint16_t a, x, y, sp, pc, dp;
+    uint8_t k, db, p, state;
+};
+static_assert(std::is_trivially_copyable_v<CpuSaveState> && sizeof(CpuSaveState) == 40);
+
+/**
+ * @brief Boucle d'exécution utilisée par RunCycles/RunUntil.
+ */
+enum class CpuEngine : uint8_t
+{
+    Interpreter,    // une instruction par appel à RunOpcode
+    Threaded,       // boucle spécialisée par mode, code threadé si le compilateur le permet
+    Block,          // blocs de base pré-décodés exécutés d'une traite, tests d'interruption entre deux blocs
+    Jit,            // Block, blocs chauds traduits en code natif (CPU_ENABLE_JIT, x86-64)
+};
+
+/**
+ * @brief Cause de la dernière sortie anticipée de RunCycles/RunUntil (voir BasicCpu::GetStopReason).
+ */
+enum class CpuStopReason : uint8_t
+{
+    None,           // budget épuisé, prédicat, RequestExit
+    Breakpoint,     // instruction à une adresse de point d'arrêt, non exécutée
+    ReadWatch,      // lecture d'une adresse surveillée, instruction terminée
+    WriteWatch,     // écriture d'une adresse surveillée, instruction terminée
+};
+
+/**
+ * @brief Classe de vitesse d'une région mémoire (en cycles maîtres par accès).
+ * Rom vaut Fast ou Slow selon MEMSEL ($420D).
+ */
+enum class CpuMemorySpeed : uint8_t
+{
+    Fast,   // 6 cycles
+    Slow,   // 8 cycles
+    XSlow,  // 12 cycles
+    Rom,    // 6 cycles si MEMSEL, 8 sinon
+};
+
+/**
+ * @class CpuSpeedMap
+ * @brief Table des temps d'accès par page de 256 octets de l'espace 24 bits.
+ *
+ * Le constructeur par défaut reproduit la carte SNES (WRAM basse lente,
+ * registres B/PPU rapides, $4000-$41FF très lent, ROM rapide selon MEMSEL).
+ */
+class CpuSpeedMap
+{
+public:
+    static constexpr uint8_t kFastCycles = 6, kSlowCycles = 8, kXSlowCycles = 12;
+
+    CpuSpeedMap()
+    {
+        SetRange(0x00, 0xff, 0x0000, 0xffff, CpuMemorySpeed::Slow);
+        for (uint8_t bank : { 0x00, 0x80 })
+        {
+            uint8_t last = bank + 0x3f;
+            SetRange(bank, last, 0x2000, 0x3fff, CpuMemorySpeed::Fast);
+            SetRange(bank, last, 0x4000, 0x41ff, CpuMemorySpeed::XSlow);
+            SetRange(bank, last, 0x4200, 0x5fff, CpuMemorySpeed::Fast);
+        }
+        SetRange(0x80, 0xbf, 0x8000, 0xffff, CpuMemorySpeed::Rom);
+        SetRange(0xc0, 0xff, 0x0000, 0xffff, CpuMemorySpeed::Rom);
+    }
+
+    /**
+     * @brief Affecte une vitesse aux pages [first, last] des banques [firstBank, lastBank].
+     * Les bornes sont arrondies à la page de 256 octets.
+     */
+    void SetRange(uint8_t firstBank, uint8_t lastBank, uint16_t first, uint16_t last, CpuMemorySpeed speed)
+    {
+        for (uint32_t bank = firstBank; bank <= lastBank; bank++)
+        {
+            for (uint32_t page = first >> 8; page <= static_cast<uint32_t>(last >> 8); page++)
+            {
+                m_pages[(bank << 8) | page] = Encode(speed);
+            }
+        }
+    }
+
+    /**
+     * @brief Sélectionne la vitesse des pages Rom (bit 0 de MEMSEL).
+     */
+    void SetMemSel(bool fastRom)
+    {
+        // Les pages Rom suivent toujours m_memSel : rien à réécrire si MEMSEL ne change pas.
+        if (fastRom == m_memSel)
+        {
+            return;
+        }
+        m_memSel = fastRom;
+        for (uint8_t& page : m_pages)
+        {
+            if (page & kRomBit)
+            {
+                page = kRomBit | (fastRom ? kFastCycles : kSlowCycles);
+            }
+        }
+    }
+
+    bool GetMemSel() const { return m_memSel; }
+
+    uint8_t GetAccessCycles(uint32_t address) const { return m_pages[(address >> 8) & 0xffff] & ~kRomBit; }
+
+    // Octet de chaque page de 256 octets : cycles d'accès, kRomBit pour les pages qui suivent MEMSEL.
+    const uint8_t* GetPages() const { return m_pages.data(); }
+    static constexpr uint8_t kRomBit = 0x80;
+
+private:
+    uint8_t Encode(CpuMemorySpeed speed) const
+    {
+        switch (speed)
+        {
+            case CpuMemorySpeed::Fast: return kFastCycles;
+            case CpuMemorySpeed::XSlow: return kXSlowCycles;
+            case CpuMemorySpeed::Rom: return kRomBit | (m_memSel ? kFastCycles : kSlowCycles);
+            default: return kSlowCycles;
+        }
+    }
+
+    // Cycles par page ; kRomBit marque les pages qui suivent MEMSEL.
+    std::array<uint8_t, 0x10000> m_pages{};
+    bool m_memSel = false;
+};
+
+/**
+ * @struct CpuPage
+ * @brief Entrée de la table des pages : pointeurs directs vers la mémoire de l'hôte.
+ * Un pointeur nul renvoie l'accès vers le handler du bus.
+ */
+struct CpuPage
+{
+    const uint8_t* read = nullptr;
+    uint8_t* write = nullptr;
+};
+
+/**
+ * @class CpuPageTable
+ * @brief Table de 4096 pages de 4 Ko couvrant l'espace 24 bits.
+ *
+ * Les pages associées à de la mémoire ordinaire (WRAM, ROM) sont lues et
+ * écrites directement ; les pages restantes (MMIO) passent par le bus.
+ *
+ * Une page portant un point d'arrêt ou une surveillance perd son accès direct pour le
+ * type d'accès concerné : seuls ses accès empruntent le chemin lent, qui consulte CpuTrapMap
+ * puis relit l'association de l'hôte (LookupHost). Une page contenant des blocs décodés
+ * (kTrapCode) perd de même son accès direct en écriture, pour invalider CpuDecoder.
+ */
+class CpuPageTable
+{
+public:
+    static constexpr uint32_t kPageShift = 12, kPageSize = 1u << kPageShift, kPageCount = 0x1000;
+    static constexpr uint8_t kTrapExecute = 0x01, kTrapRead = 0x02, kTrapWrite = 0x04, kTrapCode = 0x08;
+
+    /**
+     * @brief Associe [address, address + size) à la mémoire de l'hôte.
+     * @param read Mémoire lue à partir de address, ou nullptr pour passer par le handler.
+     * @param write Mémoire écrite à partir de address, ou nullptr pour passer par le handler.
+     * address et size doivent être alignés sur kPageSize.
+     */
+    void Map(uint32_t address, uint32_t size, const uint8_t* read, uint8_t* write)
+    {
+        assert((address % kPageSize) == 0 && (size % kPageSize) == 0);
+        for (uint32_t offset = 0; offset < size; offset += kPageSize)
+        {
+            uint32_t index = ((address + offset) >> kPageShift) & (kPageCount - 1);
+            m_host[index].read = read ? read + offset : nullptr;
+            m_host[index].write = write ? write + offset : nullptr;
+            Refresh(index);
+        }
+    }
+
+    void Unmap(uint32_t address, uint32_t size) { Map(address, size, nullptr, nullptr); }
+
+    /**
+     * @brief Accès effectif : nullptr si la page passe par le handler ou porte un piège pour cet accès.
+     */
+    const CpuPage& Lookup(uint32_t address) const { return m_pages[(address >> kPageShift) & (kPageCount - 1)]; }
+    const CpuPage* GetPages() const { return m_pages.data(); }
+
+    /**
+     * @brief Association de l'hôte, indépendante des pièges.
+     */
+    const CpuPage& LookupHost(uint32_t address) const { return m_host[(address >> kPageShift) & (kPageCount - 1)]; }
+
+    uint8_t GetTraps(uint32_t address) const { return m_traps[(address >> kPageShift) & (kPageCount - 1)]; }
+    void SetTraps(uint32_t index, uint8_t traps) { m_traps[index] = (m_traps[index] & kTrapCode) | traps; Refresh(index); }
+    void SetCode(uint32_t index, bool code) { m_traps[index] = code ? (m_traps[index] | kTrapCode) : (m_traps[index] & ~kTrapCode); Refresh(index); }
+
+private:
+    void Refresh(uint32_t index)
+    {
+        m_pages[index].read = (m_traps[index] & (kTrapExecute | kTrapRead)) ? nullptr : m_host[index].read;
+        m_pages[index].write = (m_traps[index] & (kTrapWrite | kTrapCode)) ? nullptr : m_host[index].write;
+    }
+
+    std::array<CpuPage, kPageCount> m_pages{};
+    std::array<CpuPage, kPageCount> m_host{};
+    std::array<uint8_t, kPageCount> m_traps{};
+};
+
+/**
+ * @class CpuTrapMap
+ * @brief Bitmaps des points d'arrêt et des surveillances sur l'espace 24 bits.
+ *
+ * Chaque type de piège (CpuPageTable::kTrap*) a son bitmap de 2 Mo, alloué à la première
+ * adresse posée, et le nombre de ses adresses posées ; GetPageTraps résume une page pour
+ * CpuPageTable::SetTraps.
+ */
+class CpuTrapMap
+{
+public:
+    static constexpr uint32_t kAddressCount = 0x1000000;
+
+    void Set(uint32_t address, uint8_t trap, bool enabled)
+    {
+        std::unique_ptr<uint64_t[]>& bits = m_bits[Index(trap)];
+        if (!bits)
+        {
+            if (!enabled)
+            {
+                return;
+            }
+            bits = std::make_unique<uint64_t[]>(kAddressCount / 64);
+        }
+        address &= kAddressCount - 1;
+        uint64_t mask = 1ull << (address & 63);
+        uint64_t word = enabled ? (bits[address / 64] | mask) : (bits[address / 64] & ~mask);
+        if (word != bits[address / 64])
+        {
+            bits[address / 64] = word;
+            m_counts[Index(trap)] = enabled ? m_counts[Index(trap)] + 1 : m_counts[Index(trap)] - 1;
+        }
+    }
+
+    /**
+     * @brief Vrai si au moins une adresse porte ce piège (le bitmap reste alloué une fois vidé).
+     */
+    bool Has(uint8_t trap) const { return m_counts[Index(trap)] != 0; }
+
+    bool Test(uint32_t address, uint8_t trap) const
+    {
+        const std::unique_ptr<uint64_t[]>& bits = m_bits[Index(trap)];
+        address &= kAddressCount - 1;
+        return bits && ((bits[address / 64] >> (address & 63)) & 1);
+    }
+
+    uint8_t GetPageTraps(uint32_t index) const
+    {
+        uint8_t traps = 0;
+        for (uint8_t trap : { CpuPageTable::kTrapExecute, CpuPageTable::kTrapRead, CpuPageTable::kTrapWrite })
+        {
+            const std::unique_ptr<uint64_t[]>& bits = m_bits[Index(trap)];
+            for (uint32_t word = 0; bits && word < CpuPageTable::kPageSize / 64; word++)
+            {
+                if (bits[index * (CpuPageTable::kPageSize / 64) + word])
+                {
+                    traps |= trap;
+                    break;
+                }
+            }
+        }
+        return traps;
+    }
+
+    void Clear()
+    {
+        for (std::unique_ptr<uint64_t[]>& bits : m_bits)
+        {
+            bits.reset();
+        }
+        m_counts = {};
+    }
+
+private:
+    static int Index(uint8_t trap) { return trap == CpuPageTable::kTrapExecute ? 0 : (trap == CpuPageTable::kTrapRead ? 1 : 2); }
+
+    std::unique_ptr<uint64_t[]> m_bits[3];
+    std::array<uint32_t, 3> m_counts{};
+};
@@ -1,11 +1,39 @@
+#include "LocaleInitializer.hpp"
 #include "cpu.hpp"
+#include "basic_cpu.hpp"
+#include "cpu_lanes.hpp"
+#include "cpu_scheduler.hpp"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
 #include <iomanip>
 #include <iostream>
+#include <iterator>
+#include <memory>
+#include <sstream>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <vector>
 
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 /**
  * @brief Affiche l'état actuel des registres du CPU d'une manière formatée.
  * @param state La structure contenant l'état du CPU.
@@ -28,6 +56,70 @@ void PrintCpuState(const CpuDebugState& state, const std::string& message = "")
         << std::endl;
 }
 
+/**
+ * @brief Bus statique minimal pour BasicCpu, adossé au même tableau mémoire.
+ */
+struct VectorBus
+{
+    std::vector<uint8_t>* memory;
+
+    uint8_t Read(uint32_t address) { return (*memory)[address & 0xFFFF]; }
+    void Write(uint32_t address, uint8_t value) { (*memory)[address & 0xFFFF] = value; }
+    void Idle(bool) {}
+};
+
+bool SameState(const CpuDebugState& a, const CpuDebugState& b)
+{
+    return a.a == b.a && a.x == b.x && a.y == b.y && a.sp == b.sp && a.pc == b.pc && a.dp == b.dp
+        && a.k == b.k && a.db == b.db
+        && a.c == b.c && a.z == b.z && a.v == b.v && a.n == b.n
+        && a.i == b.i && a.d == b.d && a.xf == b.xf && a.mf == b.mf && a.e == b.e;
+}
+
+/**
+ * @brief ADC décimal par ajustement des quartets (version d'avant CpuBcd), référence des tests.
+ * @return Résultat, plus CpuBcd::kCarry et CpuBcd::kOverflow (décalés de 8 bits en 16 bits).
+ */
+uint32_t ReferenceBcdAdd(uint16_t a, uint16_t value, uint32_t carry, bool wide)
+{
+    uint32_t result = (a & 0xf) + (value & 0xf) + carry;
+    if (result > 0x9) result = ((result + 0x6) & 0xf) + 0x10;
+    result = (a & 0xf0) + (value & 0xf0) + result;
+    if (!wide)
+    {
+        bool overflow = !((a ^ value) & 0x80) && ((a ^ result) & 0x80);
+        if (result > 0x9f) result += 0x60;
+        return (result & 0xff) | (result > 0xff ? CpuBcd::kCarry : 0) | (overflow ? CpuBcd::kOverflow : 0);
+    }
+    if (result > 0x9f) result = ((result + 0x60) & 0xff) + 0x100;
+    result = (a & 0xf00) + (value & 0xf00) + result;
+    if (result > 0x9ff) result = ((result + 0x600) & 0xfff) + 0x1000;
+    result = (a & 0xf000) + (value & 0xf000) + result;
+    bool overflow = !((a ^ value) & 0x8000) && ((a ^ result) & 0x8000);
+    if (result > 0x9fff) result += 0x6000;
+    return (result & 0xffff) | (result > 0xffff ? CpuBcd::kCarry << 8 : 0) | (overflow ? CpuBcd::kOverflow << 8 : 0);
+}
+
+/**
+ * @brief SBC décimal par ajustement des quartets (version d'avant CpuBcd), sans V (calculé en binaire).
+ */
+uint32_t ReferenceBcdSub(uint16_t a, uint16_t value, uint32_t carry, bool wide)
+{
+    uint32_t result = (a & 0xf) - (value & 0xf) - (1 - carry);
+    if (result & 0x10) result -= 6;
+    result = (a & 0xf0) - (value & 0xf0) + result;
+    if (result & 0x100) result -= 0x60;
+    if (!wide)
+    {
+        return (result & 0xff) | ((result & 0xff00) == 0 ? CpuBcd::kCarry : 0);
+    }
+    result = (a & 0xf00) - (value & 0xf00) + result;
+    if (result & 0x1000) result -= 0x600;
+    result = (a & 0xf000) - (value & 0xf000) + result;
+    if (result & 0x10000) result -= 0x6000;
+    return (result & 0xffff) | ((result & 0xffff0000) == 0 ? CpuBcd::kCarry << 8 : 0);
+}
+
 void CheckState(bool condition, const std::string& successMessage)
 {
     std::cout << "  [CHECK] " << successMessage << "... ";
@@ -43,7 +135,810 @@ void CheckState(bool condition, const std::string& successMessage)
 }
 
 
-int main()
+/*
+ * Vecteurs single-step du 65816 (format SingleStepTests : un fichier JSON par opcode et par mode,
+ * tableau d'objets { "name", "initial", "final", "cycles" }).
+ *
+ * Usage : test [fichier.json | répertoire], ou la variable CPU_SINGLE_STEP_TESTS. Sans chemin, les
+ * vecteurs sont ignorés. Chaque fichier est projeté en mémoire et lu par tranches de tests ; les
+ * fichiers sont répartis entre les coeurs. L'interpréteur, sur un bus qui journalise chaque cycle,
+ * sert de référence : il est comparé aux vecteurs, puis chaque moteur lui est comparé (état,
+ * mémoire, cycles maîtres et, hors pages directes, journal du bus).
+ */
+
+/**
+ * @class MappedFile
+ * @brief Projection en lecture seule d'un fichier entier.
+ */
+class MappedFile
+{
+public:
+    explicit MappedFile(const std::filesystem::path& path)
+    {
+#ifdef _WIN32
+        m_file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        LARGE_INTEGER size;
+        if (m_file == INVALID_HANDLE_VALUE || !GetFileSizeEx(m_file, &size) || size.QuadPart == 0)
+        {
+            return;
+        }
+        m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (m_mapping && (m_data = static_cast<const char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0))))
+        {
+            m_size = static_cast<size_t>(size.QuadPart);
+        }
+#else
+        m_fd = open(path.c_str(), O_RDONLY);
+        struct stat info;
+        if (m_fd < 0 || fstat(m_fd, &info) != 0 || info.st_size == 0)
+        {
+            return;
+        }
+        void* data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, m_fd, 0);
+        if (data != MAP_FAILED)
+        {
+            m_data = static_cast<const char*>(data);
+            m_size = static_cast<size_t>(info.st_size);
+            madvise(data, m_size, MADV_SEQUENTIAL);
+        }
+#endif
+    }
+
+    ~MappedFile()
+    {
+#ifdef _WIN32
+        if (m_data) UnmapViewOfFile(m_data);
+        if (m_mapping) CloseHandle(m_mapping);
+        if (m_file != INVALID_HANDLE_VALUE) CloseHandle(m_file);
+#else
+        if (m_data) munmap(const_cast<char*>(m_data), m_size);
+        if (m_fd >= 0) close(m_fd);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool IsOpen() const { return m_data != nullptr; }
+    const char* begin() const { return m_data; }
+    const char* end() const { return m_data + m_size; }
+
+private:
+#ifdef _WIN32
+    HANDLE m_file = INVALID_HANDLE_VALUE;
+    HANDLE m_mapping = nullptr;
+#else
+    int m_fd = -1;
+#endif
+    const char* m_data = nullptr;
+    size_t m_size = 0;
+};
+
+/**
+ * @class JsonReader
+ * @brief Lecteur JSON incrémental sans allocation : les valeurs sont lues au fil du texte.
+ *
+ * Les chaînes sont renvoyées telles qu'elles figurent dans le texte (échappements compris), les
+ * nombres sont des entiers positifs et null vaut -1. Une erreur de syntaxe est mémorisée
+ * (Failed) et arrête les itérations suivantes.
+ */
+class JsonReader
+{
+public:
+    JsonReader(const char* begin, const char* end) : m_pos(begin), m_end(end) {}
+
+    bool Failed() const { return m_failed; }
+
+    void Expect(char c)
+    {
+        if (!Consume(c)) m_failed = true;
+    }
+
+    /**
+     * @brief Passe à l'élément suivant d'un tableau ou d'un objet ouvert par Expect('[') ou Expect('{').
+     * @return false sur le délimiteur fermant close (consommé) ou après une erreur.
+     */
+    bool NextItem(char close, bool& first)
+    {
+        if (m_failed || Consume(close))
+        {
+            return false;
+        }
+        if (!first && !Consume(','))
+        {
+            m_failed = true;
+            return false;
+        }
+        first = false;
+        return true;
+    }
+
+    std::string_view ReadString()
+    {
+        if (!Consume('"'))
+        {
+            m_failed = true;
+            return {};
+        }
+        const char* start = m_pos;
+        while (m_pos < m_end && *m_pos != '"')
+        {
+            m_pos += (*m_pos == '\\' && m_pos + 1 < m_end) ? 2 : 1;
+        }
+        if (m_pos >= m_end)
+        {
+            m_failed = true;
+            return {};
+        }
+        return std::string_view(start, static_cast<size_t>(m_pos++ - start));
+    }
+
+    /**
+     * @brief Clé d'un membre d'objet, suivie de ':'.
+     */
+    std::string_view ReadKey()
+    {
+        std::string_view key = ReadString();
+        Expect(':');
+        return key;
+    }
+
+    int64_t ReadInt()
+    {
+        SkipSpace();
+        if (m_end - m_pos >= 4 && std::memcmp(m_pos, "null", 4) == 0)
+        {
+            m_pos += 4;
+            return -1;
+        }
+        int64_t value = 0;
+        const char* start = m_pos;
+        while (m_pos < m_end && *m_pos >= '0' && *m_pos <= '9')
+        {
+            value = value * 10 + (*m_pos++ - '0');
+        }
+        m_failed |= m_pos == start;
+        return value;
+    }
+
+    void SkipValue()
+    {
+        SkipSpace();
+        if (m_pos >= m_end)
+        {
+            m_failed = true;
+            return;
+        }
+        char c = *m_pos;
+        if (c == '"')
+        {
+            ReadString();
+        }
+        else if (c == '[' || c == '{')
+        {
+            char close = c == '[' ? ']' : '}';
+            m_pos++;
+            for (bool first = true; NextItem(close, first);)
+            {
+                if (close == '}') ReadKey();
+                SkipValue();
+            }
+        }
+        else
+        {
+            while (m_pos < m_end && *m_pos != ',' && *m_pos != ']' && *m_pos != '}' && !std::isspace(static_cast<unsigned char>(*m_pos)))
+            {
+                m_pos++;
+            }
+        }
+    }
+
+    bool AtEnd()
+    {
+        SkipSpace();
+        return m_pos >= m_end;
+    }
+
+private:
+    void SkipSpace()
+    {
+        while (m_pos < m_end && std::isspace(static_cast<unsigned char>(*m_pos)))
+        {
+            m_pos++;
+        }
+    }
+
+    bool Consume(char c)
+    {
+        SkipSpace();
+        if (m_pos < m_end && *m_pos == c)
+        {
+            m_pos++;
+            return true;
+        }
+        return false;
+    }
+
+    const char* m_pos;
+    const char* m_end;
+    bool m_failed = false;
+};
+
+/**
+ * @brief État "initial" ou "final" d'un vecteur single-step.
+ */
+struct SingleStepState
+{
+    uint16_t pc, s, a, x, y, d;
+    uint8_t p, dbr, pbr;
+    bool e;
+    std::vector<std::pair<uint32_t, uint8_t>> ram;
+};
+
+/**
+ * @brief Un cycle du bus attendu : adresse, donnée (-1 si absente) et signaux.
+ * valid correspond à VDA ou VPA ; les autres cycles sont internes.
+ */
+struct SingleStepCycle
+{
+    uint32_t address;
+    int16_t value;
+    bool valid, write;
+};
+
+struct SingleStepTest
+{
+    std::string_view name;
+    SingleStepState initial, final;
+    std::vector<SingleStepCycle> cycles;
+};
+
+void ReadSingleStepState(JsonReader& reader, SingleStepState& state)
+{
+    state.ram.clear();
+    reader.Expect('{');
+    for (bool first = true; reader.NextItem('}', first);)
+    {
+        std::string_view key = reader.ReadKey();
+        if (key == "ram")
+        {
+            reader.Expect('[');
+            for (bool firstCell = true; reader.NextItem(']', firstCell);)
+            {
+                reader.Expect('[');
+                uint32_t address = static_cast<uint32_t>(reader.ReadInt()) & 0xFFFFFF;
+                reader.Expect(',');
+                uint8_t value = static_cast<uint8_t>(reader.ReadInt());
+                reader.Expect(']');
+                state.ram.emplace_back(address, value);
+            }
+            continue;
+        }
+        if (key != "pc" && key != "s" && key != "a" && key != "x" && key != "y" && key != "d"
+            && key != "p" && key != "dbr" && key != "pbr" && key != "e")
+        {
+            reader.SkipValue();
+            continue;
+        }
+        int64_t value = reader.ReadInt();
+        if (key == "pc") state.pc = static_cast<uint16_t>(value);
+        else if (key == "s") state.s = static_cast<uint16_t>(value);
+        else if (key == "a") state.a = static_cast<uint16_t>(value);
+        else if (key == "x") state.x = static_cast<uint16_t>(value);
+        else if (key == "y") state.y = static_cast<uint16_t>(value);
+        else if (key == "d") state.d = static_cast<uint16_t>(value);
+        else if (key == "p") state.p = static_cast<uint8_t>(value);
+        else if (key == "dbr") state.dbr = static_cast<uint8_t>(value);
+        else if (key == "pbr") state.pbr = static_cast<uint8_t>(value);
+        else state.e = value != 0;
+    }
+}
+
+/**
+ * @brief Lit le test suivant du tableau ; les vecteurs du test sont réutilisés d'un appel à l'autre.
+ */
+void ReadSingleStepTest(JsonReader& reader, SingleStepTest& test)
+{
+    test.cycles.clear();
+    reader.Expect('{');
+    for (bool first = true; reader.NextItem('}', first);)
+    {
+        std::string_view key = reader.ReadKey();
+        if (key == "name")
+        {
+            test.name = reader.ReadString();
+        }
+        else if (key == "initial" || key == "final")
+        {
+            ReadSingleStepState(reader, key == "initial" ? test.initial : test.final);
+        }
+        else if (key == "cycles")
+        {
+            reader.Expect('[');
+            for (bool firstCycle = true; reader.NextItem(']', firstCycle);)
+            {
+                reader.Expect('[');
+                int64_t address = reader.ReadInt();
+                reader.Expect(',');
+                int64_t value = reader.ReadInt();
+                reader.Expect(',');
+                std::string_view signals = reader.ReadString();
+                reader.Expect(']');
+                test.cycles.push_back({ static_cast<uint32_t>(address < 0 ? 0 : address) & 0xFFFFFF, static_cast<int16_t>(value),
+                    signals.size() > 1 && (signals[0] == 'd' || signals[1] == 'p'), signals.find('w') != std::string_view::npos });
+            }
+        }
+        else
+        {
+            reader.SkipValue();
+        }
+    }
+}
+
+/**
+ * @brief Accès vu par le bus journalisé des vecteurs.
+ */
+struct SingleStepEvent
+{
+    static constexpr uint8_t kRead = 0, kWrite = 1, kIdle = 2, kWait = 3;
+
+    uint32_t address;
+    uint8_t value, kind;
+
+    bool operator==(const SingleStepEvent&) const = default;
+};
+
+/**
+ * @brief Bus des vecteurs : espace 24 bits à plat, chaque accès ajouté au journal.
+ */
+struct SingleStepBus
+{
+    uint8_t* memory;
+    std::vector<SingleStepEvent>* log;
+
+    uint8_t Read(uint32_t address)
+    {
+        uint8_t value = memory[address & 0xFFFFFF];
+        log->push_back({ address & 0xFFFFFF, value, SingleStepEvent::kRead });
+        return value;
+    }
+    void Write(uint32_t address, uint8_t value)
+    {
+        memory[address & 0xFFFFFF] = value;
+        log->push_back({ address & 0xFFFFFF, value, SingleStepEvent::kWrite });
+    }
+    void Idle(bool isWaiting) { log->push_back({ 0, 0, isWaiting ? SingleStepEvent::kWait : SingleStepEvent::kIdle }); }
+};
+
+/**
+ * @brief Exécution comparée à la référence : moteur, pages directes (sans journal du bus) ou non,
+ * et arrêt par le prédicat ou par le seul budget.
+ *
+ * Sans prédicat, le budget est le cycle de fin de la référence : RunUntil fixe alors
+ * m_batchTarget et, sur les pages directes, les moteurs enchaînent les itérations de MVN/MVP
+ * jusqu'à ce budget au lieu de rendre la main après chacune.
+ */
+struct SingleStepRun
+{
+    const char* name;
+    CpuEngine engine;
+    bool mapped;
+    bool budget;
+};
+
+constexpr SingleStepRun kSingleStepRuns[] = {
+    { "Interpreter, pages directes", CpuEngine::Interpreter, true, false },
+    { "Interpreter, budget", CpuEngine::Interpreter, false, true },
+    { "Threaded", CpuEngine::Threaded, false, false },
+    { "Threaded, pages directes", CpuEngine::Threaded, true, false },
+    { "Threaded, budget", CpuEngine::Threaded, false, true },
+    { "Threaded, pages directes, budget", CpuEngine::Threaded, true, true },
+    { "Block", CpuEngine::Block, false, false },
+    { "Block, pages directes", CpuEngine::Block, true, false },
+    { "Block, budget", CpuEngine::Block, false, true },
+    { "Block, pages directes, budget", CpuEngine::Block, true, true },
+#if CPU_ENABLE_JIT
+    { "Jit, pages directes, budget", CpuEngine::Jit, true, true },
+#endif
+};
+constexpr size_t kSingleStepRunCount = std::size(kSingleStepRuns);
+
+/**
+ * @brief Bilan d'un fichier de vecteurs.
+ */
+struct SingleStepReport
+{
+    std::filesystem::path path;
+    bool complete = false;                  // fichier projeté et lu jusqu'au bout
+    uint64_t tests = 0;
+    uint64_t vectorMismatches = 0;          // référence contre les vecteurs
+    std::string firstVectorMismatch;
+    std::array<uint64_t, kSingleStepRunCount> runMismatches{};
+    std::array<std::string, kSingleStepRunCount> firstRunMismatch;
+    double referenceSeconds = 0;
+    std::array<double, kSingleStepRunCount> runSeconds{};
+    size_t compiledBlocks = 0;              // blocs traduits en code natif par les coeurs Jit
+};
+
+uint8_t GetFlags(const CpuDebugState& state)
+{
+    return (state.n ? 0x80 : 0) | (state.v ? 0x40 : 0) | (state.mf ? 0x20 : 0) | (state.xf ? 0x10 : 0)
+        | (state.d ? 0x08 : 0) | (state.i ? 0x04 : 0) | (state.z ? 0x02 : 0) | (state.c ? 0x01 : 0);
+}
+
+/**
+ * @class SingleStepWorker
+ * @brief Moteurs et mémoire d'un thread du banc de vecteurs.
+ *
+ * La mémoire à plat de 16 Mo est partagée par tous les coeurs du thread et remise à zéro
+ * après chaque test aux seules adresses touchées. Hors référence, le test est précédé quand
+ * c'est possible d'un NOP en PC-1 : l'instruction testée est alors exécutée par la boucle du
+ * moteur et non par l'entrée de RunUntil.
+ */
+class SingleStepWorker
+{
+public:
+    SingleStepWorker()
+        : m_memory(0x1000000, 0)
+    {
+        m_reference = std::make_unique<Core>(SingleStepBus{ m_memory.data(), &m_log });
+        m_reference->SetEngine(CpuEngine::Interpreter);
+        for (size_t run = 0; run < kSingleStepRunCount; run++)
+        {
+            m_cores[run] = std::make_unique<Core>(SingleStepBus{ m_memory.data(), &m_log });
+            m_cores[run]->SetEngine(kSingleStepRuns[run].engine);
+#if CPU_ENABLE_JIT
+            // Chaque test réécrit son code : compilé dès sa première entrée, son bloc s'exécute en natif.
+            m_cores[run]->SetJitThreshold(1);
+#endif
+            if (kSingleStepRuns[run].mapped)
+            {
+                m_cores[run]->MapPages(0x000000, 0x1000000, m_memory.data(), m_memory.data());
+            }
+        }
+        m_tests.resize(kChunkSize);
+        m_expected.resize(kChunkSize);
+    }
+
+    void RunFile(SingleStepReport& report)
+    {
+        MappedFile file(report.path);
+        if (!file.IsOpen())
+        {
+            return;
+        }
+        for (std::unique_ptr<Core>& core : m_cores)
+        {
+            core->InvalidateCode(0x000000, 0x1000000);
+        }
+        size_t compiled = GetCompiledBlocks();
+        JsonReader reader(file.begin(), file.end());
+        reader.Expect('[');
+        size_t count = 0;
+        for (bool first = true; reader.NextItem(']', first);)
+        {
+            ReadSingleStepTest(reader, m_tests[count]);
+            if (!reader.Failed() && ++count == kChunkSize)
+            {
+                RunChunk(count, report);
+                count = 0;
+            }
+        }
+        RunChunk(count, report);
+        report.complete = !reader.Failed() && reader.AtEnd();
+        report.compiledBlocks = GetCompiledBlocks() - compiled;
+    }
+
+private:
+    using Core = BasicCpu<SingleStepBus>;
+    using Clock = std::chrono::steady_clock;
+    static constexpr size_t kChunkSize = 256;
+    static constexpr uint64_t kRunBudget = 1000000;
+
+    /**
+     * @brief Résultat de la référence pour un test.
+     */
+    struct Expected
+    {
+        CpuDebugState state;
+        uint64_t cycles;
+        bool prefixed;
+        uint64_t prefixCycles;                          // fin du NOP de tête
+        size_t prefixEvents;
+        std::vector<SingleStepEvent> log;
+        std::vector<std::pair<uint32_t, uint8_t>> memory;   // adresses initiales, finales et écrites
+    };
+
+    size_t GetCompiledBlocks() const
+    {
+        size_t compiled = 0;
+#if CPU_ENABLE_JIT
+        for (const std::unique_ptr<Core>& core : m_cores)
+        {
+            compiled += core->GetJit().GetCompiledCount();
+        }
+#endif
+        return compiled;
+    }
+
+    static uint32_t GetPrefixAddress(const SingleStepTest& test)
+    {
+        return (static_cast<uint32_t>(test.initial.pbr) << 16) | static_cast<uint16_t>(test.initial.pc - 1);
+    }
+
+    /**
+     * @brief Le NOP de tête n'est placé que sur une adresse que le test ne lit ni n'écrit.
+     */
+    static bool CanPrefix(const SingleStepTest& test)
+    {
+        uint32_t address = GetPrefixAddress(test);
+        auto uses = [address](const auto& cell) { return cell.first == address; };
+        return std::none_of(test.initial.ram.begin(), test.initial.ram.end(), uses)
+            && std::none_of(test.final.ram.begin(), test.final.ram.end(), uses)
+            && std::none_of(test.cycles.begin(), test.cycles.end(), [address](const SingleStepCycle& cycle) { return cycle.address == address; });
+    }
+
+    void HostWrite(uint32_t address, uint8_t value)
+    {
+        m_memory[address] = value;
+        uint32_t page = address >> CpuPageTable::kPageShift;
+        for (size_t run = 0; run < kSingleStepRunCount; run++)
+        {
+            if (kSingleStepRuns[run].mapped && m_cores[run]->GetDecoder().IsCodePage(page))
+            {
+                m_cores[run]->InvalidateCode(address, 1);
+            }
+        }
+    }
+
+    void Load(Core& core, const SingleStepTest& test, bool prefixed)
+    {
+        for (const auto& [address, value] : test.initial.ram)
+        {
+            HostWrite(address, value);
+        }
+        const SingleStepState& initial = test.initial;
+        CpuSaveState state = {
+            .magic = CpuSaveState::kMagic, .version = CpuSaveState::kVersion,
+            .cycles = 0, .wakeCycle = Core::kNoWakeCycle,
+            .a = initial.a, .x = initial.x, .y = initial.y, .sp = initial.s, .pc = initial.pc, .dp = initial.d,
+            .k = initial.pbr, .db = initial.dbr, .p = initial.p,
+            .state = static_cast<uint8_t>(initial.e ? CpuSaveState::kEmulation : 0)
+        };
+        if (prefixed)
+        {
+            HostWrite(GetPrefixAddress(test), 0xEA);   // NOP
+            state.pc--;
+        }
+        std::array<std::byte, Core::kSaveStateSize> bytes;
+        std::memcpy(bytes.data(), &state, sizeof(state));
+        core.LoadState(bytes);
+        m_log.clear();
+    }
+
+    void Clear(const SingleStepTest& test, const Expected& expected)
+    {
+        for (const auto& cell : expected.memory)
+        {
+            HostWrite(cell.first, 0);
+        }
+        if (expected.prefixed)
+        {
+            HostWrite(GetPrefixAddress(test), 0);
+        }
+    }
+
+    /**
+     * @brief Exécute le test sur la référence et le compare aux vecteurs.
+     */
+    bool RunReference(const SingleStepTest& test, Expected& expected)
+    {
+        Core& core = *m_reference;
+        expected.prefixed = CanPrefix(test);
+        Load(core, test, expected.prefixed);
+        if (expected.prefixed)
+        {
+            core.RunOpcode();
+        }
+        expected.prefixCycles = core.GetCycles();
+        expected.prefixEvents = m_log.size();
+        core.RunOpcode();
+        expected.state = core.GetDebugState();
+        expected.cycles = core.GetCycles();
+        expected.log = m_log;
+        expected.memory.clear();
+        auto keep = [&](uint32_t address) {
+            if (std::none_of(expected.memory.begin(), expected.memory.end(), [address](const auto& cell) { return cell.first == address; }))
+            {
+                expected.memory.emplace_back(address, m_memory[address]);
+            }
+            };
+        for (const auto& cell : test.initial.ram) keep(cell.first);
+        for (const auto& cell : test.final.ram) keep(cell.first);
+        for (const SingleStepEvent& event : m_log)
+        {
+            if (event.kind == SingleStepEvent::kWrite) keep(event.address);
+        }
+
+        const SingleStepState& final = test.final;
+        const CpuDebugState& state = expected.state;
+        bool same = state.pc == final.pc && state.sp == final.s && state.a == final.a && state.x == final.x
+            && state.y == final.y && state.dp == final.d && GetFlags(state) == final.p && state.db == final.dbr
+            && state.k == final.pbr && state.e == final.e;
+        same = same && std::all_of(final.ram.begin(), final.ram.end(), [this](const auto& cell) { return m_memory[cell.first] == cell.second; });
+        same = same && m_log.size() - expected.prefixEvents == test.cycles.size();
+        for (size_t i = 0; same && i < test.cycles.size(); i++)
+        {
+            const SingleStepCycle& cycle = test.cycles[i];
+            const SingleStepEvent& event = m_log[expected.prefixEvents + i];
+            if (cycle.write || cycle.valid)
+            {
+                same = event.kind == (cycle.write ? SingleStepEvent::kWrite : SingleStepEvent::kRead)
+                    && event.address == cycle.address && (cycle.value < 0 || event.value == cycle.value);
+            }
+            else
+            {
+                same = event.kind != SingleStepEvent::kWrite;
+            }
+        }
+        return same;
+    }
+
+    /**
+     * @brief Exécute le test sur un moteur et le compare au résultat de la référence.
+     */
+    bool Run(size_t run, const SingleStepTest& test, const Expected& expected)
+    {
+        Core& core = *m_cores[run];
+        Load(core, test, expected.prefixed);
+        uint64_t prefixCycles = expected.prefixCycles;
+        if (kSingleStepRuns[run].budget)
+        {
+            core.RunUntil(expected.cycles);
+        }
+        else
+        {
+            core.RunUntil(kRunBudget, [&core, prefixCycles] { return core.GetCycles() > prefixCycles; });
+        }
+        bool same = SameState(core.GetDebugState(), expected.state) && core.GetCycles() == expected.cycles
+            && std::all_of(expected.memory.begin(), expected.memory.end(), [this](const auto& cell) { return m_memory[cell.first] == cell.second; });
+        return same && (kSingleStepRuns[run].mapped || m_log == expected.log);
+    }
+
+    void RunChunk(size_t count, SingleStepReport& report)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+        auto start = Clock::now();
+        for (size_t i = 0; i < count; i++)
+        {
+            if (!RunReference(m_tests[i], m_expected[i]) && report.vectorMismatches++ == 0)
+            {
+                report.firstVectorMismatch = m_tests[i].name;
+            }
+            Clear(m_tests[i], m_expected[i]);
+        }
+        report.referenceSeconds += std::chrono::duration<double>(Clock::now() - start).count();
+        for (size_t run = 0; run < kSingleStepRunCount; run++)
+        {
+            start = Clock::now();
+            for (size_t i = 0; i < count; i++)
+            {
+                if (!Run(run, m_tests[i], m_expected[i]) && report.runMismatches[run]++ == 0)
+                {
+                    report.firstRunMismatch[run] = m_tests[i].name;
+                }
+                Clear(m_tests[i], m_expected[i]);
+            }
+            report.runSeconds[run] += std::chrono::duration<double>(Clock::now() - start).count();
+        }
+        report.tests += count;
+    }
+
+    std::vector<uint8_t> m_memory;
+    std::vector<SingleStepEvent> m_log;
+    std::unique_ptr<Core> m_reference;
+    std::array<std::unique_ptr<Core>, kSingleStepRunCount> m_cores;
+    std::vector<SingleStepTest> m_tests;
+    std::vector<Expected> m_expected;
+};
+
+/**
+ * @brief Exécute les vecteurs de path (fichier ou répertoire de fichiers .json) sur tous les coeurs.
+ */
+void RunSingleStepTests(const std::filesystem::path& path)
+{
+    std::vector<SingleStepReport> reports;
+    std::error_code error;
+    if (std::filesystem::is_directory(path, error))
+    {
+        for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(path, error))
+        {
+            if (entry.path().extension() == ".json") reports.emplace_back().path = entry.path();
+        }
+        std::sort(reports.begin(), reports.end(), [](const SingleStepReport& a, const SingleStepReport& b) { return a.path < b.path; });
+    }
+    else
+    {
+        reports.emplace_back().path = path;
+    }
+
+    std::atomic<size_t> next = 0;
+    size_t workerCount = std::clamp<size_t>(std::thread::hardware_concurrency(), 1, reports.size());
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < workerCount; i++)
+    {
+        workers.emplace_back([&] {
+            SingleStepWorker worker;
+            for (size_t index = next++; index < reports.size(); index = next++)
+            {
+                worker.RunFile(reports[index]);
+            }
+            });
+    }
+    for (std::thread& worker : workers)
+    {
+        worker.join();
+    }
+
+    SingleStepReport total;
+    bool complete = !reports.empty();
+    bool native = true;
+    std::cout << std::dec;
+    for (const SingleStepReport& report : reports)
+    {
+        complete &= report.complete;
+        native &= report.tests == 0 || report.compiledBlocks > 0;
+        if (!report.complete)
+        {
+            std::cout << "  " << report.path.filename().string() << " : fichier illisible ou incomplet" << std::endl;
+        }
+        if (report.vectorMismatches)
+        {
+            std::cout << "  " << report.path.filename().string() << " : " << report.vectorMismatches
+                << " ecart(s) avec les vecteurs, premier : " << report.firstVectorMismatch << std::endl;
+        }
+        for (size_t run = 0; run < kSingleStepRunCount; run++)
+        {
+            if (report.runMismatches[run])
+            {
+                std::cout << "  " << report.path.filename().string() << " : " << report.runMismatches[run] << " ecart(s) "
+                    << kSingleStepRuns[run].name << ", premier : " << report.firstRunMismatch[run] << std::endl;
+            }
+            total.runMismatches[run] += report.runMismatches[run];
+            total.runSeconds[run] += report.runSeconds[run];
+        }
+        total.tests += report.tests;
+        total.vectorMismatches += report.vectorMismatches;
+        total.referenceSeconds += report.referenceSeconds;
+    }
+
+    // Débits par coeur : temps cumulé des threads, chargement et remise à zéro de la mémoire compris.
+    std::cout << "Vecteurs single-step : " << reports.size() << " fichier(s), " << total.tests << " tests, "
+        << workerCount << " thread(s)" << std::endl;
+    auto report = [&](const char* name, uint64_t mismatches, double seconds) {
+        std::printf("    %-32s %9llu ecart(s) %9.1f ktests/s\n", name, static_cast<unsigned long long>(mismatches),
+            seconds > 0 ? total.tests / seconds / 1e3 : 0.0);
+        };
+    report("Interpreter (reference)", total.vectorMismatches, total.referenceSeconds);
+    bool identical = true;
+    for (size_t run = 0; run < kSingleStepRunCount; run++)
+    {
+        report(kSingleStepRuns[run].name, total.runMismatches[run], total.runSeconds[run]);
+        identical &= total.runMismatches[run] == 0;
+    }
+    std::cout << std::flush;
+    CheckState(complete && total.tests > 0, "Vecteurs single-step lus en entier");
+    CheckState(total.vectorMismatches == 0, "Interpreteur conforme aux vecteurs single-step");
+    CheckState(identical, "Moteurs identiques a l'interpreteur sur les vecteurs single-step");
+#if CPU_ENABLE_JIT
+    CheckState(!CpuJit::IsSupported() || native, "Blocs des vecteurs single-step traduits en code natif dans chaque fichier");
+#endif
+}
+
+int main(int argc, char* argv[])
 {
     // Simuler la mémoire système (64 KB)
     std::vector<uint8_t> memory(0x10000, 0);
@@ -54,7 +949,7 @@ int main()
     auto writeHandler = [&](uint32_t address, uint8_t value) {
         memory[address & 0xFFFF] = value;
         };
-    auto idleHandler = [](bool isWaiting) {};
+    auto idleHandler = [](bool) {};
 
     Cpu cpu(readHandler, writeHandler, idleHandler);
     std::cout << "Instance du CPU créée." << std::endl;
@@ -95,9 +990,11 @@ int main()
     CheckState(cpu.GetDebugState().mf == true && cpu.GetDebugState().xf == true, "Drapeaux M et X forces a 1");
     CheckState(cpu.GetDebugState().sp == 0x01FD, "Stack Pointer initialise correctement");
 
+    uint64_t cyclesBefore = cpu.GetCycles();
     cpu.RunOpcode(); // CLC
     PrintCpuState(cpu.GetDebugState(), "After CLC");
     CheckState(cpu.GetDebugState().c == false, "Drapeau Carry efface");
+    CheckState(cpu.GetCycles() - cyclesBefore == 14, "CLC en SlowROM : 8 + 6 cycles maitres");
 
     cpu.RunOpcode(); // XCE
     PrintCpuState(cpu.GetDebugState(), "After XCE");
@@ -130,5 +1027,678 @@ int main()
     PrintCpuState(cpu.GetDebugState(), "After BRK");
     CheckState(cpu.GetDebugState().sp == 0x01EB, "Stack Pointer decremente par BRK natif (-4)");
 
+    // Même programme sur le coeur à bus statique : l'état final doit être identique.
+    std::vector<uint8_t> staticMemory = memory;
+    BasicCpu<VectorBus> staticCpu(VectorBus{ &staticMemory });
+    staticCpu.Reset(true);
+    for (int i = 0; i < 9; i++)
+    {
+        staticCpu.RunOpcode();
+    }
+    PrintCpuState(staticCpu.GetDebugState(), "BasicCpu<VectorBus>");
+    CheckState(SameState(staticCpu.GetDebugState(), cpu.GetDebugState()), "Etat identique avec le bus statique");
+
+    // Même programme par pointeurs de fonction, dans un emplacement de pool rendu à la destruction.
+    std::vector<uint8_t> pooledMemory = memory;
+    CpuPool pool(2);
+    {
+        CpuHandlers handlers;
+        handlers.context = &pooledMemory;
+        handlers.read = [](void* context, uint32_t address) -> uint8_t { return (*static_cast<std::vector<uint8_t>*>(context))[address & 0xFFFF]; };
+        handlers.write = [](void* context, uint32_t address, uint8_t value) { (*static_cast<std::vector<uint8_t>*>(context))[address & 0xFFFF] = value; };
+        Cpu pooledCpu(handlers, pool);
+        pooledCpu.Reset(true);
+        for (int i = 0; i < 9; i++)
+        {
+            pooledCpu.RunOpcode();
+        }
+        CheckState(pool.GetFreeCount() == 1 && SameState(pooledCpu.GetDebugState(), cpu.GetDebugState()), "Etat identique avec les handlers par pointeurs dans le pool");
+    }
+    CheckState(pool.GetFreeCount() == 2, "Emplacement rendu au pool");
+
+    // ADC/SBC décimaux : valeurs connues, puis CpuBcd comparé à l'ajustement par quartets.
+    CheckState(CpuBcd::Add8(0x58, 0x46, 0) == (0x04 | CpuBcd::kCarry | CpuBcd::kOverflow) && CpuBcd::Add8(0x12, 0x34, 1) == 0x47
+        && CpuBcd::Add8(0x99, 0x01, 0) == (0x00 | CpuBcd::kCarry) && CpuBcd::Add8(0x79, 0x10, 0) == (0x89 | CpuBcd::kOverflow)
+        && CpuBcd::Add16(0x0999, 0x0001, 0) == 0x1000 && CpuBcd::Add16(0x1234, 0x8766, 0) == (0x0000 | CpuBcd::kCarry << 8), "Additions BCD connues");
+    CheckState(CpuBcd::Sub8(0x46, 0x12, 1) == (0x34 | CpuBcd::kCarry) && CpuBcd::Sub8(0x40, 0x13, 1) == (0x27 | CpuBcd::kCarry)
+        && CpuBcd::Sub8(0x00, 0x01, 1) == 0x99 && CpuBcd::Sub16(0x1000, 0x0001, 1) == (0x0999 | CpuBcd::kCarry << 8)
+        && CpuBcd::Sub16(0x0000, 0x0001, 1) == 0x9999, "Soustractions BCD connues (emprunt entre octets)");
+    CheckState(CpuBcd::Add8(0x0F, 0x01, 0) == ReferenceBcdAdd(0x0F, 0x01, 0, false) && CpuBcd::Add8(0x0F, 0x01, 0) == 0x16
+        && CpuBcd::Sub8(0x0A, 0x0F, 0) == ReferenceBcdSub(0x0A, 0x0F, 0, false), "Operandes BCD invalides");
+    bool bcdSame = true;
+    for (uint32_t carry = 0; carry < 2; carry++)
+    {
+        for (uint32_t a = 0; a < 0x100; a++)
+        {
+            for (uint32_t value = 0; value < 0x100; value++)
+            {
+                bcdSame &= CpuBcd::Add8(static_cast<uint8_t>(a), static_cast<uint8_t>(value), carry) == ReferenceBcdAdd(a, value, carry, false)
+                    && CpuBcd::Sub8(static_cast<uint8_t>(a), static_cast<uint8_t>(value), carry) == ReferenceBcdSub(a, value, carry, false);
+            }
+        }
+    }
+    uint32_t bcdSeed = 1;
+    for (int i = 0; i < 100000; i++)
+    {
+        bcdSeed = bcdSeed * 1103515245 + 12345;
+        uint16_t a = static_cast<uint16_t>(bcdSeed >> 8), value = static_cast<uint16_t>(bcdSeed * 69069 >> 12);
+        uint32_t carry = (bcdSeed >> 31) & 1;
+        bcdSame &= CpuBcd::Add16(a, value, carry) == ReferenceBcdAdd(a, value, carry, true) && CpuBcd::Sub16(a, value, carry) == ReferenceBcdSub(a, value, carry, true);
+    }
+    CheckState(bcdSame, "CpuBcd identique a l'ajustement par quartets (8 bits exhaustif, 16 bits echantillonne)");
+
+    // Même calcul exécuté par le coeur : ADC 16 bits avec retenue finale, SBC 8 bits avec emprunt.
+    std::vector<uint8_t> bcdMemory(0x10000, 0);
+    bcdMemory[0xFFFC] = 0x00; bcdMemory[0xFFFD] = 0x80;
+    const uint8_t bcdProgram[] = { 0x18, 0xFB, 0xF8, 0xC2, 0x20, 0xA9, 0x34, 0x12, 0x18, 0x69, 0x66, 0x87, 0x85, 0x10, // CLC ; XCE ; SED ; REP #$20 ; LDA #$1234 ; CLC ; ADC #$8766 ; STA $10
+        0xE2, 0x20, 0x38, 0xA9, 0x00, 0xE9, 0x01, 0xDB };                                                            // SEP #$20 ; SEC ; LDA #$00 ; SBC #$01 ; STP
+    std::copy(std::begin(bcdProgram), std::end(bcdProgram), bcdMemory.begin() + 0x8000);
+    BasicCpu<VectorBus> bcdCpu(VectorBus{ &bcdMemory });
+    bcdCpu.RunOpcode();
+    uint8_t bcdCarry = 0;
+    for (int i = 0; i < 13; i++)
+    {
+        bcdCpu.RunOpcode();
+        if (i == 6) bcdCarry = bcdCpu.GetDebugState().c;
+    }
+    CheckState(bcdMemory[0x10] == 0x00 && bcdMemory[0x11] == 0x00 && bcdCarry && (bcdCpu.GetDebugState().a & 0xFF) == 0x99
+        && !bcdCpu.GetDebugState().c && bcdCpu.GetDebugState().n, "ADC/SBC decimaux executes par le coeur");
+
+#if CPU_ENABLE_PERF_COUNTERS
+    // Compteurs de performance : la page 0 est directe, le reste passe par les handlers comptés.
+    {
+        std::vector<uint8_t> perfMemory(0x10000, 0);
+        perfMemory[0xFFFC] = 0x00; perfMemory[0xFFFD] = 0x80;
+        perfMemory[0xFFEA] = 0x00; perfMemory[0xFFEB] = 0x90;
+        const uint8_t perfProgram[] = { 0x18, 0xFB, 0xA5, 0x10, 0x8D, 0x00, 0x21, 0xE6, 0x11, 0x80, 0xF7 }; // CLC ; XCE ; LDA $10 ; STA $2100 ; INC $11 ; BRA -9
+        std::copy(std::begin(perfProgram), std::end(perfProgram), perfMemory.begin() + 0x8000);
+        perfMemory[0x9000] = 0x40;                                                                            // RTI
+        uint64_t perfReads = 0, perfWrites = 0, perfIdles = 0;
+        Cpu perfCpu(
+            [&](uint32_t address) -> uint8_t { perfReads++; return perfMemory[address & 0xFFFF]; },
+            [&](uint32_t address, uint8_t value) { perfWrites++; perfMemory[address & 0xFFFF] = value; },
+            [&](bool) { perfIdles++; });
+        perfCpu.MapPages(0x000000, 0x2000, perfMemory.data(), perfMemory.data());
+        perfCpu.Reset(true);
+        perfCpu.RunOpcode();
+        perfCpu.ResetPerfCounters();
+        perfReads = perfWrites = perfIdles = 0;
+        uint64_t perfStart = perfCpu.GetCycles();
+        for (int i = 0; i < 200; i++)
+        {
+            perfCpu.RunOpcode();
+        }
+        perfCpu.Nmi();
+        perfCpu.RunOpcode();
+        CpuPerfCounters perf = perfCpu.GetPerfCounters();
+        CheckState(perf.instructions == 200 && perf.cycles == perfCpu.GetCycles() - perfStart && perf.interrupts == 1
+            && perf.fastReads > 0 && perf.fastWrites > 0 && perf.waitCycles == 0, "Compteurs de performance coherents");
+        CheckState(perf.handlerReads == perfReads && perf.handlerWrites == perfWrites && perf.idleCycles == perfIdles * CpuSpeedMap::kFastCycles
+            && perf.opcodeFetches <= perf.handlerReads, "Acces aux handlers comptes a l'unite");
+        perfCpu.ResetPerfCounters();
+        perf = perfCpu.GetPerfCounters();
+        CheckState(perf.instructions == 0 && perf.cycles == 0 && perf.handlerReads == 0, "Compteurs remis a zero");
+    }
+#endif
+
+    // Exécution par budget de cycles maîtres.
+    uint64_t startCycles = cpu.GetCycles();
+    int64_t overshoot = cpu.RunCycles(1000);
+    std::cout << std::dec << "RunCycles(1000) : depassement de " << overshoot << " cycles" << std::endl;
+    CheckState(overshoot >= 0 && overshoot < 100, "Depassement borne par une instruction");
+    CheckState(cpu.GetCycles() == startCycles + 1000 + overshoot, "Compteur de cycles coherent avec le budget");
+
+    // Table des pages : la banque 0 est lue et écrite sans passer par les handlers.
+    int handlerCalls = 0;
+    Cpu mappedCpu(
+        [&](uint32_t address) -> uint8_t { handlerCalls++; return memory[address & 0xFFFF]; },
+        [&](uint32_t address, uint8_t value) { handlerCalls++; memory[address & 0xFFFF] = value; },
+        idleHandler);
+    mappedCpu.MapPages(0x000000, 0x10000, memory.data(), memory.data());
+    mappedCpu.Reset(true);
+    for (int i = 0; i < 9; i++)
+    {
+        mappedCpu.RunOpcode();
+    }
+    PrintCpuState(mappedCpu.GetDebugState(), "Pages directes");
+    CheckState(handlerCalls == 0, "Aucun appel aux handlers sur les pages directes");
+    CheckState(SameState(mappedCpu.GetDebugState(), staticCpu.GetDebugState()), "Etat identique avec les pages directes");
+
+    // MVN de 4 KB sur pages directes : le moteur threadé enchaîne les itérations,
+    // l'interpréteur les exécute une à une ; cycles, mémoire et registres doivent coïncider.
+    std::vector<uint8_t> moveMemory(0x10000, 0);
+    for (int i = 0; i < 0x1000; i++)
+    {
+        moveMemory[0x1000 + i] = static_cast<uint8_t>(i * 7);
+    }
+    moveMemory[0xFFFC] = 0x00;
+    moveMemory[0xFFFD] = 0x90;
+    const uint8_t moveProgram[] = {
+        0x18, 0xFB,             // CLC, XCE
+        0xC2, 0x30,             // REP #$30
+        0xA9, 0xFF, 0x0F,       // LDA #$0FFF
+        0xA2, 0x00, 0x10,       // LDX #$1000
+        0xA0, 0x00, 0x40,       // LDY #$4000
+        0x54, 0x00, 0x00,       // MVN $00,$00
+        0xDB                    // STP
+    };
+    std::copy(std::begin(moveProgram), std::end(moveProgram), moveMemory.begin() + 0x9000);
+    std::vector<uint8_t> stepMemory = moveMemory;
+
+    BasicCpu<VectorBus> moveCpu(VectorBus{ &moveMemory });
+    BasicCpu<VectorBus> stepCpu(VectorBus{ &stepMemory });
+    moveCpu.MapPages(0x000000, 0x10000, moveMemory.data(), moveMemory.data());
+    stepCpu.MapPages(0x000000, 0x10000, stepMemory.data(), stepMemory.data());
+    stepCpu.SetEngine(CpuEngine::Interpreter);
+    moveCpu.Reset(true);
+    stepCpu.Reset(true);
+    moveCpu.RunUntil(300000);
+    stepCpu.RunUntil(300000);
+    PrintCpuState(moveCpu.GetDebugState(), "MVN par blocs");
+    CheckState(moveMemory == stepMemory && moveMemory[0x4FFF] == moveMemory[0x1FFF], "Copie MVN identique a l'execution pas a pas");
+    CheckState(moveCpu.GetCycles() == stepCpu.GetCycles() && SameState(moveCpu.GetDebugState(), stepCpu.GetDebugState()), "Cycles et registres identiques apres MVN");
+
+    // WAI sans interruption : l'attente avance jusqu'à la fin du budget en un seul appel au bus.
+    std::vector<uint8_t> waitMemory(0x10000, 0);
+    waitMemory[0xFFFC] = 0x00;
+    waitMemory[0xFFFD] = 0x90;
+    waitMemory[0x9000] = 0x78; // SEI
+    waitMemory[0x9001] = 0xCB; // WAI
+    int waitCalls = 0;
+    Cpu waitCpu(
+        [&](uint32_t address) -> uint8_t { return waitMemory[address & 0xFFFF]; },
+        [&](uint32_t address, uint8_t value) { waitMemory[address & 0xFFFF] = value; },
+        [&](bool isWaiting) { waitCalls += isWaiting; });
+    waitCpu.Reset(true);
+    waitCpu.RunCycles(100);
+    waitCalls = 0;
+    uint64_t waitStart = waitCpu.GetCycles();
+    waitCpu.SetWakeCycle(waitStart + 50000);
+    int64_t waitOvershoot = waitCpu.RunUntil(waitStart + 100000);
+    CheckState(waitCalls == 2, "Attente WAI avancee jusqu'au reveil annonce puis jusqu'a la fin du budget");
+    CheckState(waitOvershoot >= 0 && waitOvershoot < 6, "Depassement de l'attente inferieur a un cycle interne");
+
+    // NMI programmées : WAI est réveillé au cycle annoncé, avec ou sans avance rapide de l'attente.
+    std::vector<uint8_t> eventMemory(0x10000, 0), eventReference;
+    eventMemory[0xFFFC] = 0x00;
+    eventMemory[0xFFFD] = 0x90;
+    eventMemory[0xFFFA] = 0x00;
+    eventMemory[0xFFFB] = 0xA0;
+    const uint8_t eventProgram[] = { 0x78, 0xCB, 0x80, 0xFD };  // SEI ; WAI ; BRA -3
+    const uint8_t eventHandler[] = { 0xE6, 0x10, 0x40 };        // INC $10 ; RTI
+    std::copy(std::begin(eventProgram), std::end(eventProgram), eventMemory.begin() + 0x9000);
+    std::copy(std::begin(eventHandler), std::end(eventHandler), eventMemory.begin() + 0xA000);
+    eventReference = eventMemory;
+    BasicCpu<VectorBus> eventCpu(VectorBus{ &eventMemory }), eventReferenceCpu(VectorBus{ &eventReference });
+    eventReferenceCpu.SetEngine(CpuEngine::Interpreter);
+    for (uint64_t cycle : { 10000, 20000, 20003, 45000 })
+    {
+        eventCpu.ScheduleNmi(cycle);
+        eventReferenceCpu.ScheduleNmi(cycle);
+    }
+    eventCpu.RunUntil(100000);
+    eventReferenceCpu.RunUntil(100000);
+    CheckState(eventMemory[0x10] == 3 && eventCpu.GetNextEventCycle() == BasicCpu<VectorBus>::kNoEvent, "NMI programmees prises a leur cycle");
+    CheckState(SameState(eventCpu.GetDebugState(), eventReferenceCpu.GetDebugState()) && eventCpu.GetCycles() == eventReferenceCpu.GetCycles()
+        && eventMemory == eventReference, "NMI programmees identiques sans avance rapide");
+
+    // Sauvegarde d'état : restaurer puis rejouer le même budget redonne le même état.
+    std::array<std::byte, Cpu::kSaveStateSize> saveState;
+    CheckState(waitCpu.SaveState(saveState), "Etat du CPU sauvegarde");
+    waitCpu.Nmi();
+    waitCpu.RunCycles(2000);
+    CpuDebugState afterNmi = waitCpu.GetDebugState();
+    uint64_t afterNmiCycles = waitCpu.GetCycles();
+    CheckState(waitCpu.LoadState(saveState) && waitCpu.GetCycles() == waitStart + 100000 + waitOvershoot, "Etat du CPU restaure");
+    waitCpu.Nmi();
+    waitCpu.RunCycles(2000);
+    CheckState(SameState(waitCpu.GetDebugState(), afterNmi) && waitCpu.GetCycles() == afterNmiCycles, "Execution identique apres restauration");
+    saveState[4] = std::byte{ 0xFF };
+    CheckState(!waitCpu.LoadState(saveState), "Version de sauvegarde inconnue refusee");
+
+    // Anneau d'instantanés CpuCore : copie et restauration par affectation.
+    std::array<CpuCore, 8> coreRing;
+    uint64_t ringStart = waitCpu.GetCycles();
+    for (size_t i = 0; i < coreRing.size(); i++)
+    {
+        coreRing[i] = waitCpu.GetCore();
+        waitCpu.RunUntil(ringStart + (i + 1) * 500);
+    }
+    CpuDebugState ringEnd = waitCpu.GetDebugState();
+    uint64_t ringEndCycles = waitCpu.GetCycles();
+    waitCpu.SetCore(coreRing[0]);
+    waitCpu.RunUntil(ringStart + coreRing.size() * 500);
+    CheckState(SameState(waitCpu.GetDebugState(), ringEnd) && waitCpu.GetCycles() == ringEndCycles, "Execution rejouee depuis l'anneau d'instantanes");
+
+    // Points d'arrêt et surveillances sur une boucle LDX #3 ; DEX ; BNE -3 ; STX $0010 ; BRA -10.
+    std::vector<uint8_t> trapMemory(0x10000, 0);
+    trapMemory[0xFFFC] = 0x00;
+    trapMemory[0xFFFD] = 0x80;
+    const uint8_t trapProgram[] = { 0xA2, 0x03, 0xCA, 0xD0, 0xFD, 0x8E, 0x10, 0x00, 0x80, 0xF6 };
+    std::copy(std::begin(trapProgram), std::end(trapProgram), trapMemory.begin() + 0x8000);
+    for (CpuEngine engine : { CpuEngine::Threaded, CpuEngine::Interpreter, CpuEngine::Block, CpuEngine::Jit })
+    {
+        BasicCpu<VectorBus> trapCpu(VectorBus{ &trapMemory });
+        trapCpu.SetEngine(engine);
+        trapCpu.MapPages(0x000000, 0x10000, trapMemory.data(), trapMemory.data());
+        trapCpu.SetBreakpoint(0x008002);
+        int hits = 0;
+        for (uint16_t x = 3; x > 0; x--)
+        {
+            bool stopped = trapCpu.RunCycles(10000) < 0 && trapCpu.GetStopReason() == CpuStopReason::Breakpoint;
+            hits += stopped && trapCpu.GetStopAddress() == 0x008002 && trapCpu.GetDebugState().pc == 0x8002 && trapCpu.GetDebugState().x == x;
+        }
+        CheckState(hits == 3, "Point d'arret atteint avant chaque DEX");
+        trapCpu.SetBreakpoint(0x008002, false);
+        trapCpu.SetWatchpoint(0x000010, 1, false, true);
+        trapCpu.RunCycles(10000);
+        CheckState(trapCpu.GetStopReason() == CpuStopReason::WriteWatch && trapCpu.GetStopAddress() == 0x000010 && trapCpu.GetDebugState().pc == 0x8008, "Surveillance en ecriture arretee apres STX");
+        if (engine == CpuEngine::Block)
+        {
+            // Le point d'arrêt retiré, LookupBlock compile de nouveau les blocs au lieu d'avancer instruction par instruction.
+            CheckState(trapCpu.GetDecoder().GetBlockCount() > 0, "Blocs entiers accordes apres retrait du point d'arret");
+        }
+    }
+
+    // Décodeur de blocs : découpage, désassemblage et invalidation par une écriture du programme dans son propre code.
+    std::vector<uint8_t> codeMemory(0x10000, 0);
+    codeMemory[0xFFFC] = 0x00;
+    codeMemory[0xFFFD] = 0x80;
+    const uint8_t codeProgram[] = {
+        0x18, 0xFB, 0xC2, 0x30, // CLC, XCE, REP #$30
+        0xA9, 0xEA, 0xEA,       // LDA #$EAEA
+        0x8D, 0x0C, 0x80,       // STA $800C (opérande du LDX)
+        0xEA,                   // NOP
+        0xA2, 0x00, 0x00,       // LDX #$0000
+        0x80, 0xF4              // BRA $8004
+    };
+    std::copy(std::begin(codeProgram), std::end(codeProgram), codeMemory.begin() + 0x8000);
+    BasicCpu<VectorBus> codeCpu(VectorBus{ &codeMemory });
+    codeCpu.MapPages(0x000000, 0x10000, codeMemory.data(), codeMemory.data());
+    const CpuBasicBlock* resetBlock = codeCpu.DecodeBlock(0x008000, CpuDecoder::kModeEmulation);
+    const CpuBasicBlock* loopBlock = codeCpu.DecodeBlock(0x008004, CpuDecoder::GetMode(false, false, false));
+    CheckState(resetBlock && resetBlock->instructions.size() == 2 && resetBlock->end == CpuBlockEnd::Control && resetBlock->nextAddress == 0x008002, "Bloc de reset termine par XCE");
+    std::ostringstream listing;
+    CpuDecoder::WriteBlock(listing, *loopBlock);
+    CheckState(loopBlock->instructions.size() == 5 && listing.str() == "00:8004  A9 EA EA     LDA #$EAEA\n00:8007  8D 0C 80     STA $800C\n"
+        "00:800A  EA           NOP\n00:800B  A2 00 00     LDX #$0000\n00:800E  80 F4        BRA $8004\n", "Bloc 16 bits desassemble");
+    CheckState(codeCpu.DecodeBlock(0x008004, CpuDecoder::kModeEmulation)->instructions[0].length == 2, "Longueur de l'immediat selon M");
+    for (int i = 0; i < 6; i++)
+    {
+        codeCpu.RunOpcode();
+    }
+    CheckState(codeCpu.GetDecoder().Find(0x008004, 0) == nullptr && codeMemory[0x800C] == 0xEA, "Bloc invalide par STA dans son propre code");
+    const CpuBasicBlock* patchedBlock = codeCpu.DecodeBlock(0x008004, codeCpu.GetCore().m_mode);
+    CheckState(CpuDecoder::Disassemble(patchedBlock->instructions[3]) == "LDX #$EAEA", "Bloc redecode apres modification");
+    codeCpu.InvalidateCode(0x008000, 0x1000);
+    CheckState(codeCpu.GetDecoder().GetBlockCount() == 0 && codeCpu.GetPageTable().Lookup(0x008000).write, "Invalidation par l'hote et ecriture directe retablie");
+
+    // Moteur Block : même état, même mémoire et mêmes cycles que Threaded, code automodifiant compris ;
+    // l'IRQ programmée tombe au milieu d'une tranche, donc d'un bloc pré-décodé.
+    std::vector<uint8_t> threadedMemory = codeMemory, blockMemory = codeMemory;
+    BasicCpu<VectorBus> threadedCpu(VectorBus{ &threadedMemory }), blockCpu(VectorBus{ &blockMemory });
+    threadedCpu.MapPages(0x000000, 0x10000, threadedMemory.data(), threadedMemory.data());
+    blockCpu.MapPages(0x000000, 0x10000, blockMemory.data(), blockMemory.data());
+    blockCpu.SetEngine(CpuEngine::Block);
+    for (uint64_t target = 1000; target <= 20000; target += 1000)
+    {
+        threadedCpu.RunUntil(target);
+        blockCpu.RunUntil(target);
+        blockCpu.ScheduleIrq(target + 437, target == 8000);
+        threadedCpu.ScheduleIrq(target + 437, target == 8000);
+    }
+    CheckState(SameState(blockCpu.GetDebugState(), threadedCpu.GetDebugState()) && blockCpu.GetCycles() == threadedCpu.GetCycles()
+        && blockMemory == threadedMemory, "Moteur Block identique au moteur Threaded");
+
+    // Moteur Jit : boucle chaude traduite (ADC/SBC binaires et décimaux, indexé, INC/DEC en mémoire,
+    // page du handler), mêmes état, mémoire, cycles et compteurs que Threaded et Block, IRQ programmées comprises.
+    for (uint8_t widths : { 0x30, 0x10 })
+    {
+        std::vector<uint8_t> jitImage(0x10000, 0);
+        jitImage[0xFFFC] = 0x00;
+        jitImage[0xFFFD] = 0x80;
+        jitImage[0xFFEE] = 0x00;
+        jitImage[0xFFEF] = 0x90;
+        const uint8_t jitProgram[] = {
+            0x18, 0xFB, 0xC2, widths,   // CLC, XCE, REP #widths
+            0x58, 0xA2, 0x00, 0x00,     // CLI ; LDX #$0000
+            0x18, 0x65, 0x10,           // $8008 : CLC ; ADC $10
+            0x7D, 0x00, 0x03,           // ADC $0300,X
+            0x8D, 0x00, 0x21,           // STA $2100 (page du handler)
+            0xAD, 0x00, 0x21,           // LDA $2100
+            0xF8, 0xE5, 0x12, 0xD8,     // SED ; SBC $12 ; CLD
+            0xE5, 0x12,                 // SBC $12
+            0xE6, 0x14,                 // INC $14
+            0xCE, 0x16, 0x00,           // DEC $0016
+            0x0A, 0x6A, 0xA8, 0xE8,     // ASL A ; ROR A ; TAY ; INX
+            0xE0, 0x00, 0x02,           // CPX #$0200
+            0xD0, 0xE0,                 // BNE $8008
+            0xA2, 0x00, 0x00,           // LDX #$0000
+            0x80, 0xDB                  // BRA $8008
+        };
+        std::copy(std::begin(jitProgram), std::end(jitProgram), jitImage.begin() + 0x8000);
+        const uint8_t jitHandler[] = { 0xE6, 0x18, 0x40 };    // INC $18 ; RTI
+        std::copy(std::begin(jitHandler), std::end(jitHandler), jitImage.begin() + 0x9000);
+        jitImage[0x10] = 0x35;
+        jitImage[0x12] = 0x19;
+
+        const CpuEngine jitEngines[] = { CpuEngine::Threaded, CpuEngine::Block, CpuEngine::Jit };
+        std::array<std::vector<uint8_t>, 3> jitMemory = { jitImage, jitImage, jitImage };
+        std::array<std::unique_ptr<BasicCpu<VectorBus>>, 3> jitCores;
+        for (size_t i = 0; i < jitCores.size(); i++)
+        {
+            jitCores[i] = std::make_unique<BasicCpu<VectorBus>>(VectorBus{ &jitMemory[i] });
+            jitCores[i]->MapPages(0x000000, 0x10000, jitMemory[i].data(), jitMemory[i].data());
+            jitCores[i]->UnmapPages(0x002000, 0x1000);
+            jitCores[i]->SetEngine(jitEngines[i]);
+        }
+        for (uint64_t target = 1000; target <= 200000; target += 1000)
+        {
+            for (size_t i = 0; i < jitCores.size(); i++)
+            {
+                jitCores[i]->RunUntil(target);
+                jitCores[i]->ScheduleIrq(target + 437, target % 8000 == 0);
+            }
+        }
+        bool jitMatch = true;
+        for (size_t i = 1; i < jitCores.size(); i++)
+        {
+            jitMatch = jitMatch && SameState(jitCores[i]->GetDebugState(), jitCores[0]->GetDebugState())
+                && jitCores[i]->GetCycles() == jitCores[0]->GetCycles() && jitMemory[i] == jitMemory[0];
+#if CPU_ENABLE_PERF_COUNTERS
+            CpuPerfCounters jitPerf = jitCores[i]->GetPerfCounters(), threadedPerf = jitCores[0]->GetPerfCounters();
+            jitMatch = jitMatch && jitPerf.instructions == threadedPerf.instructions && jitPerf.opcodeFetches == threadedPerf.opcodeFetches
+                && jitPerf.fastReads == threadedPerf.fastReads && jitPerf.handlerReads == threadedPerf.handlerReads
+                && jitPerf.fastWrites == threadedPerf.fastWrites && jitPerf.handlerWrites == threadedPerf.handlerWrites
+                && jitPerf.idleCycles == threadedPerf.idleCycles && jitPerf.interrupts == threadedPerf.interrupts;
+#endif
+        }
+        CheckState(jitMatch && jitMemory[0][0x18] != 0, widths == 0x30 ? "Moteur Jit identique aux moteurs Threaded et Block (A 16 bits)"
+            : "Moteur Jit identique aux moteurs Threaded et Block (A 8 bits)");
+#if CPU_ENABLE_JIT
+        CheckState(!CpuJit::IsSupported() || jitCores[2]->GetJit().GetCompiledCount() > 0, "Boucle chaude traduite en code natif");
+#endif
+    }
+
+    // Ordonnanceur : deux coeurs partagent la page 0, le second recopie le compteur du premier.
+    std::vector<uint8_t> mainMemory(0x10000, 0), coMemory(0x10000, 0), sharedRam(0x1000, 0);
+    mainMemory[0xFFFC] = coMemory[0xFFFC] = 0x00;
+    mainMemory[0xFFFD] = coMemory[0xFFFD] = 0x80;
+    const uint8_t mainProgram[] = { 0xE6, 0x10, 0x80, 0xFC };             // INC $10 ; BRA -4
+    const uint8_t coProgram[] = { 0xA5, 0x10, 0x85, 0x20, 0x80, 0xFA };   // LDA $10 ; STA $20 ; BRA -6
+    std::copy(std::begin(mainProgram), std::end(mainProgram), mainMemory.begin() + 0x8000);
+    std::copy(std::begin(coProgram), std::end(coProgram), coMemory.begin() + 0x8000);
+    CpuScheduler<VectorBus> scheduler(100);
+    scheduler.AddCore(VectorBus{ &mainMemory });
+    scheduler.AddCore(VectorBus{ &coMemory });
+    scheduler.MapSharedPages(0x000000, 0x1000, sharedRam.data(), sharedRam.data());
+    bool schedulerDone = scheduler.RunUntil(1000);
+    CheckState(schedulerDone && scheduler.GetCore(0).GetCycles() >= 1000 && scheduler.GetCore(1).GetCycles() >= 1000
+        && sharedRam[0x10] >= 10 && sharedRam[0x10] - sharedRam[0x20] <= 3, "Deux coeurs avances par tranches sur une memoire partagee");
+    scheduler.GetCore(1).SetBreakpoint(0x008002);
+    CheckState(!scheduler.RunUntil(2000) && scheduler.GetStoppedCore() == 1 && scheduler.GetCore(1).GetDebugState().pc == 0x8002,
+        "Arret de l'ordonnanceur sur le point d'arret d'un coeur");
+
+    // Couloirs SoA : huit entrées différentes, branches divergentes, même état final que le coeur scalaire.
+    const uint8_t laneProgram[] = {
+        0x18, 0xFB, 0xC2, 0x30, // CLC, XCE, REP #$30
+        0xA5, 0x10,             // LDA $10
+        0xA2, 0x05, 0x00,       // LDX #$0005
+        0x69, 0x03, 0x00,       // ADC #$0003
+        0xCA, 0xD0, 0xFA,       // DEX ; BNE $8009
+        0xA8, 0xC8,             // TAY ; INY
+        0xC9, 0x00, 0x01,       // CMP #$0100
+        0x90, 0x01, 0x4A,       // BCC $8017 ; LSR A
+        0x85, 0x12,             // STA $12
+        0x80, 0xE9              // BRA $8004
+    };
+    std::array<std::vector<uint8_t>, 8> laneMemory, laneReference;
+    std::array<VectorBus, 8> laneBuses;
+    for (size_t lane = 0; lane < 8; lane++)
+    {
+        laneMemory[lane].assign(0x10000, 0);
+        laneMemory[lane][0xFFFC] = 0x00;
+        laneMemory[lane][0xFFFD] = 0x80;
+        laneMemory[lane][0x10] = static_cast<uint8_t>(lane * 0x30);
+        std::copy(std::begin(laneProgram), std::end(laneProgram), laneMemory[lane].begin() + 0x8000);
+        laneReference[lane] = laneMemory[lane];
+        laneBuses[lane] = VectorBus{ &laneMemory[lane] };
+    }
+    CpuLanes<VectorBus, 8> lanes(laneBuses);
+    for (size_t lane = 0; lane < 8; lane++)
+    {
+        lanes.GetLane(lane).MapPages(0x000000, 0x10000, laneMemory[lane].data(), laneMemory[lane].data());
+    }
+    lanes.RunUntil(30000);
+    lanes.RunUntil(60000);
+    bool lanesMatch = true;
+    for (size_t lane = 0; lane < 8; lane++)
+    {
+        BasicCpu<VectorBus> reference(VectorBus{ &laneReference[lane] });
+        reference.RunUntil(30000);
+        reference.RunUntil(60000);
+        lanesMatch = lanesMatch && SameState(lanes.GetLane(lane).GetDebugState(), reference.GetDebugState())
+            && lanes.GetLane(lane).GetCycles() == reference.GetCycles() && laneMemory[lane] == laneReference[lane];
+    }
+    CheckState(lanesMatch, "Couloirs SoA identiques au coeur scalaire");
+    CheckState(lanes.GetVectorInstructions() > lanes.GetScalarInstructions(), "Instructions des couloirs majoritairement executees en parallele");
+
+    // Couloirs et événements programmés : chaque couloir reçoit ses impulsions IRQ à d'autres cycles ; INY à chaque entrée.
+    const uint8_t irqLaneProgram[] = {
+        0x18, 0xFB, 0xC2, 0x30, 0x58,       // CLC, XCE, REP #$30, CLI
+        0xE8, 0xE8, 0xCA, 0x1A, 0x3A, 0xEA, // INX, INX, DEX, INC A, DEC A, NOP
+        0x80, 0xF8                          // BRA $8005
+    };
+    for (size_t lane = 0; lane < 8; lane++)
+    {
+        laneMemory[lane].assign(0x10000, 0);
+        laneMemory[lane][0xFFFC] = 0x00;
+        laneMemory[lane][0xFFFD] = 0x80;
+        laneMemory[lane][0xFFEE] = 0x00;
+        laneMemory[lane][0xFFEF] = 0x90;
+        laneMemory[lane][0x9000] = 0xC8;    // INY
+        laneMemory[lane][0x9001] = 0x40;    // RTI
+        std::copy(std::begin(irqLaneProgram), std::end(irqLaneProgram), laneMemory[lane].begin() + 0x8000);
+        laneReference[lane] = laneMemory[lane];
+    }
+    CpuLanes<VectorBus, 8> irqLanes(laneBuses);
+    auto scheduleLaneIrqs = [](BasicCpu<VectorBus>& cpu, size_t lane)
+    {
+        for (uint64_t pulse = 0; pulse < 4; pulse++)
+        {
+            uint64_t start = 4000 + pulse * 9000 + lane * 131;
+            cpu.ScheduleIrq(start, true);
+            cpu.ScheduleIrq(start + 60, false);
+        }
+    };
+    for (size_t lane = 0; lane < 8; lane++)
+    {
+        irqLanes.GetLane(lane).MapPages(0x000000, 0x10000, laneMemory[lane].data(), laneMemory[lane].data());
+        scheduleLaneIrqs(irqLanes.GetLane(lane), lane);
+    }
+    irqLanes.RunUntil(20000);
+    irqLanes.RunUntil(40000);
+    bool irqLanesMatch = true, lanePerfMatch = true;
+    for (size_t lane = 0; lane < 8; lane++)
+    {
+        BasicCpu<VectorBus> reference(VectorBus{ &laneReference[lane] });
+        reference.MapPages(0x000000, 0x10000, laneReference[lane].data(), laneReference[lane].data());
+        scheduleLaneIrqs(reference, lane);
+        reference.RunUntil(20000);
+        reference.RunUntil(40000);
+        const BasicCpu<VectorBus>& core = irqLanes.GetLane(lane);
+        irqLanesMatch = irqLanesMatch && SameState(core.GetDebugState(), reference.GetDebugState()) && core.GetDebugState().y == 4
+            && core.GetCycles() == reference.GetCycles() && laneMemory[lane] == laneReference[lane];
+#if CPU_ENABLE_PERF_COUNTERS
+        CpuPerfCounters lanePerf = core.GetPerfCounters(), referencePerf = reference.GetPerfCounters();
+        lanePerfMatch = lanePerfMatch && lanePerf.instructions == referencePerf.instructions && lanePerf.cycles == referencePerf.cycles
+            && lanePerf.opcodeFetches == referencePerf.opcodeFetches && lanePerf.fastReads == referencePerf.fastReads
+            && lanePerf.handlerReads == referencePerf.handlerReads && lanePerf.idleCycles == referencePerf.idleCycles
+            && lanePerf.interrupts == referencePerf.interrupts;
+#endif
+    }
+    CheckState(irqLanesMatch && irqLanes.GetVectorInstructions() > 0, "Couloirs identiques au coeur scalaire avec des IRQ programmees");
+    CheckState(lanePerfMatch, "Compteurs des couloirs identiques au coeur scalaire");
+
+#if CPU_ENABLE_PROFILER
+    // Profileur : la boucle DEX/BNE domine les compteurs et les cycles se répartissent sans perte.
+    std::vector<uint8_t> profileMemory(0x10000, 0);
+    profileMemory[0xFFFC] = 0x00;
+    profileMemory[0xFFFD] = 0x80;
+    const uint8_t profileProgram[] = { 0xA2, 0x00, 0xCA, 0xD0, 0xFD, 0x80, 0xF9 }; // LDX #0 ; DEX ; BNE -3 ; BRA -7
+    std::copy(std::begin(profileProgram), std::end(profileProgram), profileMemory.begin() + 0x8000);
+    BasicCpu<VectorBus> profileCpu(VectorBus{ &profileMemory });
+    profileCpu.RunOpcode();
+    profileCpu.GetProfiler().Enable(true);
+    uint64_t profileStart = profileCpu.GetCycles();
+    profileCpu.RunCycles(100000);
+    const CpuProfiler& profiler = profileCpu.GetProfiler();
+    uint64_t profiledCycles = 0;
+    for (int opcode = 0; opcode < 256; opcode++)
+    {
+        profiledCycles += profiler.GetOpcode(static_cast<uint8_t>(opcode)).cycles;
+    }
+    CheckState(profiler.GetAddress(0x8002).executions > 0 && profiler.GetAddress(0x8002).executions == profiler.GetOpcode(0xCA).executions, "Executions de DEX comptees par adresse et par opcode");
+    CheckState(profiledCycles == profileCpu.GetCycles() - profileStart, "Cycles du profileur egaux au temps ecoule");
+
+    // Compteurs par adresse sur 64 bits : un total de cycles au-delà de 2^32 ne déborde pas sur les exécutions.
+    CpuProfiler wideProfiler;
+    wideProfiler.Enable(true);
+    wideProfiler.Record(0x123456, 0xEA, 0xFFFFFFFF);
+    wideProfiler.Record(0x123456, 0xEA, 0xFFFFFFFF);
+    CheckState(wideProfiler.GetAddress(0x123456).executions == 2 && wideProfiler.GetAddress(0x123456).cycles == 2 * 0xFFFFFFFFull,
+        "Compteurs par adresse sans debordement a 2^32");
+    std::ostringstream wideReport;
+    wideProfiler.WriteReport(wideReport);
+    CheckState(wideProfiler.GetAddress(0x003456).executions == 0 && wideReport.str().find("12:3456") != std::string::npos,
+        "Banque non executee vide, banque allouee au premier passage presente dans le rapport");
+
+    // MVN de 4 Ko profilé : chaque itération comptée, avec les mêmes cycles que pas à pas.
+    std::vector<uint8_t> profileMoveMemory = moveMemory, profileStepMemory = moveMemory;
+    BasicCpu<VectorBus> profileMoveCpu(VectorBus{ &profileMoveMemory }), profileStepCpu(VectorBus{ &profileStepMemory });
+    profileMoveCpu.MapPages(0x000000, 0x10000, profileMoveMemory.data(), profileMoveMemory.data());
+    profileStepCpu.MapPages(0x000000, 0x10000, profileStepMemory.data(), profileStepMemory.data());
+    profileStepCpu.SetEngine(CpuEngine::Interpreter);
+    for (BasicCpu<VectorBus>* cpu : { &profileMoveCpu, &profileStepCpu })
+    {
+        cpu->RunOpcode();
+        cpu->GetProfiler().Enable(true);
+        cpu->RunUntil(300000);
+    }
+    CpuProfiler::Counter moveCounter = profileMoveCpu.GetProfiler().GetOpcode(0x54);
+    CpuProfiler::Counter stepCounter = profileStepCpu.GetProfiler().GetOpcode(0x54);
+    CheckState(moveCounter.executions == 0x1000 && profileMoveCpu.GetProfiler().GetAddress(0x900D).executions == 0x1000
+        && moveCounter.cycles == stepCounter.cycles, "Chaque iteration de MVN profilee");
+#endif
+
+#if CPU_ENABLE_TRACE
+    // Trace : l'anneau reçoit chaque instruction et le flux compressé se relit à l'identique.
+    std::vector<uint8_t> traceMemory = moveMemory;
+    BasicCpu<VectorBus> traceCpu(VectorBus{ &traceMemory });
+    traceCpu.MapPages(0x000000, 0x10000, traceMemory.data(), traceMemory.data());
+    CpuTraceRing traceRing(16);
+    traceCpu.SetTraceRing(&traceRing);
+    traceCpu.RunOpcode();
+    for (int i = 0; i < 7; i++)
+    {
+        traceCpu.RunOpcode();
+    }
+    std::array<CpuTraceRecord, 16> traceRecords;
+    size_t traceCount = traceRing.Drain(traceRecords);
+    std::stringstream traceStream;
+    CpuTraceWriter traceWriter(traceStream);
+    traceWriter.Write(std::span(traceRecords.data(), traceCount));
+    CpuTraceReader traceReader(traceStream);
+    CpuTraceRecord decoded;
+    size_t decodedCount = 0;
+    while (traceReader.Read(decoded) && std::memcmp(&decoded, &traceRecords[decodedCount], sizeof(decoded)) == 0)
+    {
+        decodedCount++;
+    }
+    CheckState(traceCount == 7 && traceRecords[6].opcode == 0x54 && traceRecords[6].a == 0x0FFF && (traceRecords[6].flags & CpuTraceRecord::kOperandsValid), "Sept instructions tracees jusqu'a MVN");
+    CheckState(CpuDecoder::Disassemble(traceRecords[3]) == "LDA #$0FFF" && CpuDecoder::Disassemble(traceRecords[6]) == "MVN $00,$00", "Instructions tracees desassemblees");
+    CheckState(decodedCount == traceCount && traceStream.str().size() < traceCount * sizeof(CpuTraceRecord), "Trace compressee relue a l'identique");
+
+    // Trace d'un MVN de 4 Ko par le moteur Threaded : un enregistrement par octet copié.
+    std::vector<uint8_t> traceMoveMemory = moveMemory;
+    BasicCpu<VectorBus> traceMoveCpu(VectorBus{ &traceMoveMemory });
+    traceMoveCpu.MapPages(0x000000, 0x10000, traceMoveMemory.data(), traceMoveMemory.data());
+    CpuTraceRing traceMoveRing(0x2000);
+    traceMoveCpu.SetTraceRing(&traceMoveRing);
+    traceMoveCpu.RunUntil(300000);
+    std::vector<CpuTraceRecord> traceMoveRecords(0x2000);
+    size_t traceMoveCount = traceMoveRing.Drain(traceMoveRecords);
+    size_t traceMoveIterations = std::count_if(traceMoveRecords.begin(), traceMoveRecords.begin() + traceMoveCount,
+        [](const CpuTraceRecord& record) { return record.opcode == 0x54; });
+    CheckState(traceMoveIterations == 0x1000 && traceMoveMemory[0x4FFF] == traceMoveMemory[0x1FFF], "Chaque iteration de MVN tracee");
+#endif
+
+#if CPU_ENABLE_BUS_LOG
+    // Journal du bus : lectures MMIO, IRQ levée par une écriture MMIO et NMI de l'hôte, rejouées sans handler.
+    std::vector<uint8_t> logImage(0x10000, 0);
+    logImage[0xFFFC] = 0x00; logImage[0xFFFD] = 0x80;
+    logImage[0xFFFE] = 0x00; logImage[0xFFFF] = 0x90;
+    logImage[0xFFFA] = 0x00; logImage[0xFFFB] = 0x91;
+    const uint8_t logProgram[] = { 0x58, 0xAD, 0x00, 0x21, 0x8D, 0x00, 0x22, 0x85, 0x10, 0x80, 0xF6 }; // CLI ; LDA $2100 ; STA $2200 ; STA $10 ; BRA -10
+    const uint8_t logIrq[] = { 0xAD, 0x01, 0x21, 0x85, 0x11, 0x9C, 0x00, 0x22, 0x40 };                 // LDA $2101 ; STA $11 ; STZ $2200 ; RTI
+    const uint8_t logNmi[] = { 0xE6, 0x12, 0x40 };                                                     // INC $12 ; RTI
+    std::copy(std::begin(logProgram), std::end(logProgram), logImage.begin() + 0x8000);
+    std::copy(std::begin(logIrq), std::end(logIrq), logImage.begin() + 0x9000);
+    std::copy(std::begin(logNmi), std::end(logNmi), logImage.begin() + 0x9100);
+    std::vector<uint8_t> recordMemory = logImage, replayMemory = logImage;
+    uint32_t mmioSeed = 12345;
+    Cpu* recordTarget = nullptr;
+    Cpu recordCpu(
+        [&](uint32_t) -> uint8_t { mmioSeed = mmioSeed * 1103515245 + 12345; return static_cast<uint8_t>(mmioSeed >> 16); },
+        [&](uint32_t address, uint8_t value) { if ((address & 0xFFFF) == 0x2200) recordTarget->SetIrq((value & 0x0F) == 0); },
+        [](bool) {});
+    recordTarget = &recordCpu;
+    int replayCalls = 0;
+    Cpu replayCpu([&](uint32_t) -> uint8_t { replayCalls++; return 0; }, [&](uint32_t, uint8_t) { replayCalls++; }, [&](bool) { replayCalls++; });
+    for (auto [logCpu, logMemory] : { std::pair{ &recordCpu, &recordMemory }, std::pair{ &replayCpu, &replayMemory } })
+    {
+        logCpu->MapPages(0x000000, 0x2000, logMemory->data(), logMemory->data());
+        logCpu->MapPages(0x003000, 0xD000, logMemory->data() + 0x3000, logMemory->data() + 0x3000);
+    }
+    std::array<std::byte, Cpu::kSaveStateSize> logStart;
+    recordCpu.SaveState(logStart);
+    CpuBusLog busLog;
+    recordCpu.SetBusLog(&busLog, CpuBusLogMode::Record);
+    recordCpu.ScheduleNmi(30000);
+    for (uint64_t target = 10000; target <= 50000; target += 10000)
+    {
+        recordCpu.RunUntil(target);
+        if (target == 20000) recordCpu.Nmi();
+    }
+    std::stringstream busLogStream;
+    busLog.Write(busLogStream);
+    CpuBusLog replayLog;
+    replayCpu.LoadState(logStart);
+    replayCpu.SetBusLog(replayLog.Read(busLogStream) ? &replayLog : nullptr, CpuBusLogMode::Replay);
+    replayCpu.RunUntil(recordCpu.GetCycles());
+    CheckState(recordMemory[0x12] == 2 && recordMemory[0x11] != 0 && busLogStream.str().size() < busLog.GetRecordCount() * 4, "Journal du bus enregistre");
+    CheckState(SameState(replayCpu.GetDebugState(), recordCpu.GetDebugState()) && replayCpu.GetCycles() == recordCpu.GetCycles()
+        && replayMemory == recordMemory && !replayCpu.HasReplayDiverged() && replayCalls == 0, "Rejeu identique sans appel aux handlers");
+
+    // Journal rechargé : même nombre d'enregistrements, et Append le prolonge comme l'original.
+    CpuBusLog resumedLog;
+    busLogStream.clear();
+    busLogStream.seekg(0);
+    bool resumed = resumedLog.Read(busLogStream) && resumedLog.GetRecordCount() == busLog.GetRecordCount();
+    busLog.Append({ CpuBusRecord::kRead, 0x5A, recordCpu.GetCycles() + 8 });
+    resumedLog.Append({ CpuBusRecord::kRead, 0x5A, recordCpu.GetCycles() + 8 });
+    CheckState(resumed && std::ranges::equal(resumedLog.GetData(), busLog.GetData()), "Journal recharge prolonge par Append");
+#endif
+
+    const char* singleStepPath = argc > 1 ? argv[1] : std::getenv("CPU_SINGLE_STEP_TESTS");
+    if (singleStepPath && *singleStepPath)
+    {
+        RunSingleStepTests(singleStepPath);
+    }
+    else
+    {
+        std::cout << "Vecteurs single-step ignores (chemin en argument ou CPU_SINGLE_STEP_TESTS)." << std::endl;
+    }
+
     return 0;
 }
\ No newline at end of file